@@ -1,7 +1,9 @@
 #include "benchmark.h"
 
 
+#include <array>
 #include <cstdint>
+#include <string>
 #include <vector>
 #include <iostream>
 
@@ -11,185 +13,365 @@
 #include "simulation/naive_parallel_simulation.h"
 #include "simulation/barnes_hut_simulation.h"
 #include "simulation/barnes_hut_simulation_with_collisions.h"
+#include "simulation/simulation_engine_registry.h"
+#include "simulation/simulation_context.h"
+#include "quadtree/quadtree.h"
 
 #include "input_generator/input_generator.h"
 
+#include <omp.h>
+
+#include "parallel/thread_affinity.h"
+
+
+// every benchmark with the same input sees the same bodies
+static constexpr std::uint64_t benchmark_seed = 42;
+
+enum class BenchmarkInput : std::int64_t {
+	uniform,
+	plummer
+};
+
+// The sweeps run the thread counts of one body count back to back, so only the last universe is
+// kept. Generating it once per body count keeps the expensive setup out of the timed loops and out
+// of PauseTiming, and never holds several 10M body universes at the same time.
+static Universe& get_benchmark_universe(std::int64_t number_bodies, std::int64_t input = 0) {
+	static Universe universe;
+	static std::int64_t cached_bodies = -1;
+	static std::int64_t cached_input = -1;
+	if (cached_bodies != number_bodies || cached_input != input) {
+		universe = Universe{};
+		if (static_cast<BenchmarkInput>(input) == BenchmarkInput::plummer) {
+			InputGenerator::create_plummer_sphere(number_bodies, universe, benchmark_seed);
+		} else {
+			InputGenerator::create_random_universe(number_bodies, universe, benchmark_seed);
+		}
+		cached_bodies = number_bodies;
+		cached_input = input;
+	}
+	return universe;
+}
 
-static void benchmark_get_bounding_box_sequential(benchmark::State& state){
-	const auto number_bodies = state.range(0);
+// OpenMP thread count of a single benchmark run
+class ScopedThreads {
+public:
+	explicit ScopedThreads(std::int64_t number_threads) : previous_threads(omp_get_max_threads()) {
+		omp_set_num_threads(number_threads);
+	}
+	~ScopedThreads() {
+		omp_set_num_threads(previous_threads);
+	}
 
-	for (auto _ : state) {
-		state.PauseTiming();
-		// initialize universe
-		Universe uni;
-		InputGenerator::create_random_universe(number_bodies, uni);
-		// calculate bounding box
-		state.ResumeTiming();
-		uni.get_bounding_box();
+private:
+	int previous_threads;
+};
+
+// sums the phase timings and thread counters of all timed epochs
+class BenchmarkObserver : public SimulationObserver {
+public:
+	void on_phase_end(SimulationPhase phase, double seconds) override {
+		phase_seconds[static_cast<std::size_t>(phase)] += seconds;
+	}
+
+	void on_epoch_end(Universe&, SimulationContext& context) override {
+		for (const auto& scratch : context.thread_scratch) {
+			interactions += scratch.counters.interactions;
+		}
 	}
 
+	std::array<double, num_simulation_phases> phase_seconds{};
+	std::uint64_t interactions = 0;
+};
+
+static void set_scaling_counters(benchmark::State& state, std::int64_t number_bodies, std::int64_t number_threads) {
+	state.counters["bodies"] = number_bodies;
+	state.counters["threads"] = number_threads;
+	state.counters["bodies_per_second"] = benchmark::Counter(static_cast<double>(number_bodies) * state.iterations(), benchmark::Counter::kIsRate);
 }
 
-static void benchmark_get_bounding_box_parallel(benchmark::State& state){
+static void benchmark_get_bounding_box_sequential(benchmark::State& state){
 	const auto number_bodies = state.range(0);
+	Universe& uni = get_benchmark_universe(number_bodies);
 
 	for (auto _ : state) {
-		state.PauseTiming();
-		// initialize universe
-		Universe uni;
-		InputGenerator::create_random_universe(number_bodies, uni);
-		// calculate bounding box
-		state.ResumeTiming();
-		uni.parallel_cpu_get_bounding_box();
+		benchmark::DoNotOptimize(uni.get_bounding_box());
 	}
-
+	set_scaling_counters(state, number_bodies, 1);
 }
 
-static void benchmark_naive_sequential(benchmark::State& state) {
+static void benchmark_get_bounding_box_parallel(benchmark::State& state){
 	const auto number_bodies = state.range(0);
-	const auto number_epochs = state.range(1);
+	const auto number_threads = state.range(1);
+	ScopedThreads threads(number_threads);
+	Universe& uni = get_benchmark_universe(number_bodies);
 
 	for (auto _ : state) {
-		state.PauseTiming();
-		// initialize universe
-		Universe uni;
-		InputGenerator::create_random_universe(number_bodies, uni);
-		// create dummy plotter
-		BoundingBox bb(-5, 5, -5, 5);
-		auto tmp_path = std::filesystem::path{"dummy_plot"};
-		Plotter plotter(bb, tmp_path, 400, 400);
-
-		state.ResumeTiming();
-		NaiveSequentialSimulation::simulate_epochs(plotter, uni, number_epochs, false, 1);
-		//benchmark::DoNotOptimize(autStat.print());
-	}	
+		benchmark::DoNotOptimize(uni.parallel_cpu_get_bounding_box());
+	}
+	set_scaling_counters(state, number_bodies, number_threads);
 }
 
-
-static void benchmark_naive_parallel(benchmark::State& state) {
+static void benchmark_tree_build(benchmark::State& state) {
 	const auto number_bodies = state.range(0);
-	const auto number_epochs = state.range(1);
+	const auto number_threads = state.range(1);
+	const auto input = state.range(2);
+	ScopedThreads threads(number_threads);
+	Universe& uni = get_benchmark_universe(number_bodies, input);
+	SimulationContext context(uni);
+	const BoundingBox bb = uni.get_bounding_box();
 
 	for (auto _ : state) {
-		state.PauseTiming();
-		// initialize universe
-		Universe uni;
-		InputGenerator::create_random_universe(number_bodies, uni);
-		// create dummy plotter
-		BoundingBox bb(-5, 5, -5, 5);
-		auto tmp_path = std::filesystem::path{"dummy_plot"};
-		Plotter plotter(bb, tmp_path, 400, 400);
-
-		state.ResumeTiming();
-		NaiveParallelSimulation::simulate_epochs(plotter, uni, number_epochs, false, 1);
-		//benchmark::DoNotOptimize(autStat.print());
-	}	
+		context.reset_body_indices(uni);
+		Quadtree qt(uni, bb, context.node_arena, context.body_indices);
+		benchmark::DoNotOptimize(qt.root);
+	}
+	set_scaling_counters(state, number_bodies, number_threads);
 }
 
-
-static void benchmark_barnes_hut(benchmark::State& state) {
+static void benchmark_mass_aggregation(benchmark::State& state) {
 	const auto number_bodies = state.range(0);
-	const auto number_epochs = state.range(1);
+	const auto number_threads = state.range(1);
+	const auto input = state.range(2);
+	ScopedThreads threads(number_threads);
+	Universe& uni = get_benchmark_universe(number_bodies, input);
+	SimulationContext context(uni);
+	context.reset_body_indices(uni);
+	Quadtree qt(uni, uni.get_bounding_box(), context.node_arena, context.body_indices);
 
 	for (auto _ : state) {
-		state.PauseTiming();
-		// initialize universe
-		Universe uni;
-		InputGenerator::create_random_universe(number_bodies, uni);
-		// create dummy plotter
-		BoundingBox bb(-5, 5, -5, 5);
-		auto tmp_path = std::filesystem::path{"dummy_plot"};
-		Plotter plotter(bb, tmp_path, 400, 400);
-
-		state.ResumeTiming();
-		BarnesHutSimulation::simulate_epochs(plotter, uni, number_epochs, false, 1);
-		//benchmark::DoNotOptimize(autStat.print());
-	}	
+		qt.root->aggregate_mass();
+		benchmark::ClobberMemory();
+	}
+	set_scaling_counters(state, number_bodies, number_threads);
 }
 
-static void benchmark_barnes_hut_with_collisions(benchmark::State& state) {
+static void benchmark_find_collisions_parallel(benchmark::State& state) {
 	const auto number_bodies = state.range(0);
+	const auto number_threads = state.range(1);
+	ScopedThreads threads(number_threads);
+	// The random input has only a few bodies closer than the collision distance, and after one search
+	// no pair is left. The untimed searches below merge them up front, so every timed iteration
+	// compares all pairs of the same universe and no iteration needs a fresh copy of the input.
+	Universe uni = get_benchmark_universe(number_bodies);
+	std::uint32_t settled_bodies;
+	do {
+		settled_bodies = uni.num_bodies;
+		BarnesHutSimulationWithCollisions::find_collisions_parallel(uni);
+	} while (uni.num_bodies != settled_bodies);
 
 	for (auto _ : state) {
-		state.PauseTiming();
-		// initialize universe
-		Universe uni;
-		InputGenerator::create_random_universe(number_bodies, uni);
-		// create dummy plotter
-		BoundingBox bb(-5, 5, -5, 5);
-		auto tmp_path = std::filesystem::path{"dummy_plot"};
-		Plotter plotter(bb, tmp_path, 400, 400);
-
-		state.ResumeTiming();
-		BarnesHutSimulationWithCollisions::simulate_epochs(plotter, uni, 1, false, 1);
-		//benchmark::DoNotOptimize(autStat.print());
-	}	
+		BarnesHutSimulationWithCollisions::find_collisions_parallel(uni);
+		if (uni.num_bodies != settled_bodies) {
+			state.SkipWithError("collision search merged bodies of the settled universe");
+			break;
+		}
+	}
+	set_scaling_counters(state, settled_bodies, number_threads);
 }
 
-static void benchmark_construct_quadtree(benchmark::State& state) {
+// One iteration is one epoch. The epochs of all iterations continue the same simulation of a copy of
+// the shared input, so no setup is timed and nothing has to be paused.
+static void benchmark_simulation_engine(benchmark::State& state, std::uint32_t simulation_mode) {
 	const auto number_bodies = state.range(0);
-	const std::int8_t construct_mode = state.range(1);
+	const auto number_threads = state.range(1);
+	const auto input = state.range(2);
+	ScopedThreads threads(number_threads);
+
+	auto engine = SimulationEngineRegistry::get_instance().create_engine(simulation_mode);
+	Universe uni = get_benchmark_universe(number_bodies, input);
+	SimulationContext context(uni);
+	BenchmarkObserver observer;
+	context.add_observer(&observer);
 
 	for (auto _ : state) {
-		state.PauseTiming();
-		// initialize universe
-		Universe uni;
-		InputGenerator::create_random_universe(number_bodies, uni);
-		BoundingBox bb = uni.get_bounding_box();
-
-		state.ResumeTiming();
-		Quadtree(uni, bb, construct_mode);
-	}	
+		// the epoch of SimulationDriver without plotting
+		context.notify_epoch_begin(uni);
+		engine->simulate_epoch(uni, context);
+		context.notify_epoch_end(uni);
+	}
+
+	set_scaling_counters(state, number_bodies, number_threads);
+	state.counters["input"] = input;
+	state.counters["interactions_per_second"] = benchmark::Counter(static_cast<double>(observer.interactions), benchmark::Counter::kIsRate);
+	for (std::size_t phase = 0; phase < num_simulation_phases; phase++) {
+		if (observer.phase_seconds[phase] > 0) {
+			state.counters[std::string(get_phase_name(static_cast<SimulationPhase>(phase))) + "_ms"] = 1e3 * observer.phase_seconds[phase] / state.iterations();
+		}
+	}
+	state.SetLabel(engine->get_name());
 }
 
-static void benchmark_calculate_cumulative_masses(benchmark::State& state) {
+static void benchmark_force_schedule(benchmark::State& state) {
 	const auto number_bodies = state.range(0);
+	const auto schedule = get_force_schedule(state.range(1));
+	const auto number_threads = state.range(2);
+
+	const auto previous_threads = omp_get_max_threads();
+	omp_set_num_threads(number_threads);
+
+	// clustered input, the bodies close to the black holes open far more nodes than the others
+	Universe uni;
+	InputGenerator::create_random_universe_with_supermassive_blackholes(number_bodies, uni, 2, benchmark_seed);
+	SimulationContext context(uni);
+	context.force_schedule.schedule = schedule;
+	context.force_schedule.chunk_size = 64;
+	// one epoch to collect the interaction counts the cost based schedules rely on
+	BarnesHutSimulation::simulate_epoch(uni, context);
+
+	context.reset_body_indices(uni);
+	Quadtree qt(uni, uni.get_bounding_box(), context.node_arena, context.body_indices);
+	qt.root->aggregate_mass();
+
+	double load_imbalance = 0;
+	for (auto _ : state) {
+		context.reset_counters();
+		BarnesHutSimulation::calculate_forces(uni, qt, context);
+		load_imbalance += context.get_load_imbalance();
+	}
+	state.counters["load_imbalance"] = load_imbalance / state.iterations();
+	state.SetLabel(get_force_schedule_name(schedule));
+
+	omp_set_num_threads(previous_threads);
+}
 
+template <typename BodyArray>
+static void run_position_update(benchmark::State& state, BodyArray& positions, BodyArray& velocities) {
+	const std::int64_t number_bodies = positions.size();
 	for (auto _ : state) {
-		state.PauseTiming();
-		// initialize universe
-		Universe uni;
-		InputGenerator::create_random_universe(number_bodies, uni);
-		BoundingBox bb = uni.get_bounding_box();
-		Quadtree qt = Quadtree(uni, bb, 2);
-		
-		state.ResumeTiming();
-		qt.calculate_cumulative_masses();
-	}	
+		// same loop as NaiveParallelSimulation::calculate_positions
+#pragma omp parallel for
+		for (std::int64_t i = 0; i < number_bodies; i++) {
+			positions[i] = positions[i] + velocities[i] * 2.628e6;
+		}
+		benchmark::ClobberMemory();
+	}
+	// two arrays read, one written
+	state.SetBytesProcessed(state.iterations() * number_bodies * 3 * sizeof(Vector2d<double>));
 }
 
-static void benchmark_find_collisions(benchmark::State& state) {
+static void benchmark_body_bandwidth(benchmark::State& state) {
 	const auto number_bodies = state.range(0);
+	const bool first_touch = state.range(1);
+	const auto affinity = get_thread_affinity(state.range(2));
 
-	for (auto _ : state) {
-		state.PauseTiming();
-		// initialize universe
-		Universe uni;
-		InputGenerator::create_random_universe(number_bodies, uni);
-		BoundingBox bb = uni.get_bounding_box();
-		
-		state.ResumeTiming();
-		BarnesHutSimulationWithCollisions::find_collisions(uni);
-	}	
+	// pinned before the allocation, so the pages are touched by the final cpus
+	if (!ThreadPinning::apply(affinity)) {
+		state.SkipWithError("thread affinity not supported on this platform");
+		return;
+	}
+	if (first_touch) {
+		body_vector<Vector2d<double>> positions(number_bodies);
+		body_vector<Vector2d<double>> velocities(number_bodies, Vector2d<double>(1.0, 1.0));
+		run_position_update(state, positions, velocities);
+	} else {
+		// std::allocator: the main thread touches every page, all memory ends up on its socket
+		std::vector<Vector2d<double>> positions(number_bodies);
+		std::vector<Vector2d<double>> velocities(number_bodies, Vector2d<double>(1.0, 1.0));
+		run_position_update(state, positions, velocities);
+	}
+	state.counters["numa_nodes"] = ThreadPinning::get_num_numa_nodes();
+	state.counters["threads"] = omp_get_max_threads();
+	state.SetLabel(std::string(first_touch ? "first_touch/" : "serial_touch/") + get_thread_affinity_name(affinity));
+
+	ThreadPinning::apply(ThreadAffinity::none);
 }
 
-static void benchmark_find_collisions_parallel(benchmark::State& state) {
-	const auto number_bodies = state.range(0);
+// 1, 2, 4, ... threads up to all cores
+static std::vector<std::int64_t> get_thread_counts() {
+	std::vector<std::int64_t> thread_counts;
+	const std::int64_t max_threads = omp_get_num_procs();
+	for (std::int64_t threads = 1; threads < max_threads; threads *= 2) {
+		thread_counts.push_back(threads);
+	}
+	thread_counts.push_back(max_threads);
+	return thread_counts;
+}
 
-	for (auto _ : state) {
-		state.PauseTiming();
-		// initialize universe
-		Universe uni;
-		InputGenerator::create_random_universe(number_bodies, uni);
-		BoundingBox bb = uni.get_bounding_box();
-		
-		state.ResumeTiming();
-		BarnesHutSimulationWithCollisions::find_collisions_parallel(uni);
-	}	
+static const std::vector<std::int64_t> body_counts = {1000, 10000, 100000, 1000000, 10000000};
+// the O(n^2) engines and the collision search need minutes per epoch beyond this
+static constexpr std::int64_t max_naive_bodies = 100000;
+// bodies per thread of the weak scaling runs
+static const std::vector<std::int64_t> weak_scaling_bodies = {10000, 100000};
+
+static void register_simulation_engine_benchmarks() {
+	// every registered engine is benchmarked, new engines do not need to be added here
+	const auto thread_counts = get_thread_counts();
+	for (auto& entry : SimulationEngineRegistry::get_instance().get_entries()) {
+		const std::vector<std::int64_t> engine_threads = entry.capabilities.parallel ? thread_counts : std::vector<std::int64_t>{1};
+		const std::vector<std::int64_t> inputs = entry.capabilities.uses_quadtree ? std::vector<std::int64_t>{0, 1} : std::vector<std::int64_t>{0};
+
+		// strong scaling, the same problem with more threads
+		auto strong_scaling = benchmark::RegisterBenchmark(("benchmark_simulation_engine/" + entry.name).c_str(), benchmark_simulation_engine, entry.simulation_mode);
+		strong_scaling->Unit(benchmark::kMillisecond)->UseRealTime()->ArgNames({"bodies", "threads", "input"});
+		for (auto number_bodies : body_counts) {
+			if (entry.capabilities.quadratic_cost && number_bodies > max_naive_bodies) {
+				continue;
+			}
+			for (auto input : inputs) {
+				for (auto number_threads : engine_threads) {
+					strong_scaling->Args({number_bodies, number_threads, input});
+				}
+			}
+		}
+
+		// weak scaling, the same number of bodies per thread
+		if (entry.capabilities.parallel && !entry.capabilities.quadratic_cost) {
+			auto weak_scaling = benchmark::RegisterBenchmark(("benchmark_weak_scaling/" + entry.name).c_str(), benchmark_simulation_engine, entry.simulation_mode);
+			weak_scaling->Unit(benchmark::kMillisecond)->UseRealTime()->ArgNames({"bodies", "threads", "input"});
+			for (auto bodies_per_thread : weak_scaling_bodies) {
+				for (auto number_threads : thread_counts) {
+					weak_scaling->Args({bodies_per_thread * number_threads, number_threads, 0});
+				}
+			}
+		}
+	}
 }
 
+static void register_phase_benchmarks() {
+	const auto thread_counts = get_thread_counts();
+	auto bounding_box_sequential = benchmark::RegisterBenchmark("benchmark_get_bounding_box_sequential", benchmark_get_bounding_box_sequential);
+	auto bounding_box_parallel = benchmark::RegisterBenchmark("benchmark_get_bounding_box_parallel", benchmark_get_bounding_box_parallel);
+	auto tree_build = benchmark::RegisterBenchmark("benchmark_tree_build", benchmark_tree_build);
+	auto mass_aggregation = benchmark::RegisterBenchmark("benchmark_mass_aggregation", benchmark_mass_aggregation);
+	auto collisions = benchmark::RegisterBenchmark("benchmark_find_collisions_parallel", benchmark_find_collisions_parallel);
+	for (auto* phase_benchmark : {bounding_box_sequential, bounding_box_parallel, tree_build, mass_aggregation, collisions}) {
+		phase_benchmark->Unit(benchmark::kMillisecond)->UseRealTime();
+	}
+	bounding_box_sequential->ArgNames({"bodies"});
+	bounding_box_parallel->ArgNames({"bodies", "threads"});
+	collisions->ArgNames({"bodies", "threads"});
+	tree_build->ArgNames({"bodies", "threads", "input"});
+	mass_aggregation->ArgNames({"bodies", "threads", "input"});
+	// threads vary fastest, so consecutive runs share the cached universe
+	for (auto number_bodies : body_counts) {
+		bounding_box_sequential->Args({number_bodies});
+		for (auto number_threads : thread_counts) {
+			bounding_box_parallel->Args({number_bodies, number_threads});
+			if (number_bodies <= max_naive_bodies) {
+				collisions->Args({number_bodies, number_threads});
+			}
+		}
+		for (std::int64_t input : {0, 1}) {
+			for (auto number_threads : thread_counts) {
+				tree_build->Args({number_bodies, number_threads, input});
+				mass_aggregation->Args({number_bodies, number_threads, input});
+			}
+		}
+	}
+}
+
+
+// serial and parallel first touch without pinning, compact and scatter pinning. Run under
+// `numactl --cpunodebind` / `--membind` to compare local and remote memory per socket
+BENCHMARK(benchmark_body_bandwidth)->Unit(benchmark::kMillisecond)->ArgsProduct({{10000000}, {0, 1}, {0, 1, 2}});
+
+// all force schedules with 1 to 8 threads. cost_zones also walks the bodies in tree order, so it
+// differs from the others with a single thread as well: compare the schedules at the same thread count
+BENCHMARK(benchmark_force_schedule)->Unit(benchmark::kMillisecond)->ArgsProduct({{50000}, {0, 1, 2, 3, 4}, {1, 2, 4, 8}});
 
 int main(int argc, char** argv) {
+	register_phase_benchmarks();
+	register_simulation_engine_benchmarks();
 	::benchmark::Initialize(&argc, argv);
 	if (::benchmark::ReportUnrecognizedArguments(argc, argv))
 		return 1;
@@ -198,56 +380,3 @@ int main(int argc, char** argv) {
 	return 0;
 }
 
-BENCHMARK(benchmark_get_bounding_box_sequential)->Unit(benchmark::kMillisecond)->Args({100000});
-BENCHMARK(benchmark_get_bounding_box_sequential)->Unit(benchmark::kMillisecond)->Args({10000000});
-BENCHMARK(benchmark_get_bounding_box_sequential)->Unit(benchmark::kMillisecond)->Args({100000000});
-
-BENCHMARK(benchmark_get_bounding_box_parallel)->Unit(benchmark::kMillisecond)->Args({100000});
-BENCHMARK(benchmark_get_bounding_box_parallel)->Unit(benchmark::kMillisecond)->Args({10000000});
-BENCHMARK(benchmark_get_bounding_box_parallel)->Unit(benchmark::kMillisecond)->Args({100000000});
-/*
-BENCHMARK(benchmark_construct_quadtree)->Unit(benchmark::kMillisecond)->Args({10000, 0});
-BENCHMARK(benchmark_construct_quadtree)->Unit(benchmark::kMillisecond)->Args({20000, 0});
-BENCHMARK(benchmark_construct_quadtree)->Unit(benchmark::kMillisecond)->Args({200000, 0});
-BENCHMARK(benchmark_construct_quadtree)->Unit(benchmark::kMillisecond)->Args({10000000, 0});
-BENCHMARK(benchmark_construct_quadtree)->Unit(benchmark::kMillisecond)->Args({10000, 1});
-BENCHMARK(benchmark_construct_quadtree)->Unit(benchmark::kMillisecond)->Args({20000, 1});
-BENCHMARK(benchmark_construct_quadtree)->Unit(benchmark::kMillisecond)->Args({10000, 2});
-BENCHMARK(benchmark_construct_quadtree)->Unit(benchmark::kMillisecond)->Args({20000, 2});
-BENCHMARK(benchmark_construct_quadtree)->Unit(benchmark::kMillisecond)->Args({200000, 2});
-BENCHMARK(benchmark_construct_quadtree)->Unit(benchmark::kMillisecond)->Args({10000000, 2});
-
-BENCHMARK(benchmark_calculate_cumulative_masses)->Unit(benchmark::kMillisecond)->Args({10000});
-BENCHMARK(benchmark_calculate_cumulative_masses)->Unit(benchmark::kMillisecond)->Args({1000000});
-BENCHMARK(benchmark_calculate_cumulative_masses)->Unit(benchmark::kMillisecond)->Args({10000000});
-
-BENCHMARK(benchmark_naive_sequential)->Unit(benchmark::kMillisecond)->Args({100, 1});
-BENCHMARK(benchmark_naive_sequential)->Unit(benchmark::kMillisecond)->Args({1000, 1});
-
-BENCHMARK(benchmark_naive_sequential)->Unit(benchmark::kMillisecond)->Args({10000, 1});
-
-BENCHMARK(benchmark_naive_parallel)->Unit(benchmark::kMillisecond)->Args({100, 1});
-BENCHMARK(benchmark_naive_parallel)->Unit(benchmark::kMillisecond)->Args({1000, 1});
-BENCHMARK(benchmark_naive_parallel)->Unit(benchmark::kMillisecond)->Args({10000, 1});
-BENCHMARK(benchmark_naive_parallel)->Unit(benchmark::kMillisecond)->Args({100000, 1});
-
-
-BENCHMARK(benchmark_barnes_hut)->Unit(benchmark::kMillisecond)->Args({100, 1});
-BENCHMARK(benchmark_barnes_hut)->Unit(benchmark::kMillisecond)->Args({1000, 1});
-BENCHMARK(benchmark_barnes_hut)->Unit(benchmark::kMillisecond)->Args({10000, 1});
-BENCHMARK(benchmark_barnes_hut)->Unit(benchmark::kMillisecond)->Args({100000, 1});
-BENCHMARK(benchmark_barnes_hut)->Unit(benchmark::kMillisecond)->Args({1000000, 1});
-
-BENCHMARK(benchmark_find_collisions)->Unit(benchmark::kMillisecond)->Args({1000});
-BENCHMARK(benchmark_find_collisions)->Unit(benchmark::kMillisecond)->Args({10000});
-BENCHMARK(benchmark_find_collisions)->Unit(benchmark::kMillisecond)->Args({100000});
-
-BENCHMARK(benchmark_find_collisions_parallel)->Unit(benchmark::kMillisecond)->Args({1000});
-BENCHMARK(benchmark_find_collisions_parallel)->Unit(benchmark::kMillisecond)->Args({10000});
-BENCHMARK(benchmark_find_collisions_parallel)->Unit(benchmark::kMillisecond)->Args({100000});
-
-BENCHMARK(benchmark_barnes_hut_with_collisions)->Unit(benchmark::kMillisecond)->Args({100, 1});
-BENCHMARK(benchmark_barnes_hut_with_collisions)->Unit(benchmark::kMillisecond)->Args({1000, 1});
-BENCHMARK(benchmark_barnes_hut_with_collisions)->Unit(benchmark::kMillisecond)->Args({10000, 1});
-BENCHMARK(benchmark_barnes_hut_with_collisions)->Unit(benchmark::kMillisecond)->Args({100000, 1});
-*/
\ No newline at end of file
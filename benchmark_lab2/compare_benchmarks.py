@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Performance regression guard for the lab benchmarks.
+
+Compares Google Benchmark JSON files (--benchmark_out_format=json, run with
+--benchmark_repetitions so every benchmark has several samples) against a stored
+baseline. A benchmark regresses if its mean wall time is more than --threshold
+slower than the baseline and Welch's t-test rejects equal means at --alpha.
+
+    compare_benchmarks.py regression_baseline.json lab1.json lab2.json
+    compare_benchmarks.py regression_baseline.json lab1.json lab2.json --update
+
+The first form prints the delta table and exits with 1 on regressions, the second
+replaces the baseline with the samples of the given files. Timings only compare on
+the machine and build type that recorded the baseline: for results from another
+machine the table is printed, but no slowdown counts as regression.
+"""
+
+import argparse
+import json
+import math
+import sys
+
+TIME_UNIT_TO_SECONDS = {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1.0}
+# context entries that have to match the baseline for the timings to be comparable
+MACHINE_KEYS = ("host_name", "num_cpus", "library_build_type")
+
+
+def load_samples(paths):
+    """benchmark name -> wall times in seconds of all repetitions, plus the context of the first file"""
+    samples = {}
+    context = {}
+    for path in paths:
+        with open(path) as json_file:
+            report = json.load(json_file)
+        context = context or report.get("context", {})
+        for run in report["benchmarks"]:
+            if run.get("run_type", "iteration") != "iteration" or "error_occurred" in run:
+                continue
+            seconds = run["real_time"] * TIME_UNIT_TO_SECONDS[run.get("time_unit", "ns")]
+            samples.setdefault(run.get("run_name", run["name"]), []).append(seconds)
+    return context, samples
+
+
+def write_baseline(path, context, samples):
+    baseline = {
+        "context": {key: context[key] for key in ("host_name", "num_cpus", "mhz_per_cpu", "library_build_type") if key in context},
+        "benchmarks": {name: {"real_time_seconds": times} for name, times in sorted(samples.items())},
+    }
+    with open(path, "w") as json_file:
+        json.dump(baseline, json_file, indent=1)
+        json_file.write("\n")
+
+
+def mean_and_variance(values):
+    mean = sum(values) / len(values)
+    variance = sum((value - mean) ** 2 for value in values) / (len(values) - 1) if len(values) > 1 else 0.0
+    return mean, variance
+
+
+def incomplete_beta(a, b, x):
+    """regularized incomplete beta function I_x(a, b), continued fraction of Numerical Recipes"""
+    if x <= 0:
+        return 0.0
+    if x >= 1:
+        return 1.0
+    if x > (a + 1) / (a + b + 2):
+        return 1.0 - incomplete_beta(b, a, 1 - x)
+    front = math.exp(math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) + a * math.log(x) + b * math.log(1 - x)) / a
+    tiny = 1e-300
+    c = 1.0
+    d = 1.0 - (a + b) * x / (a + 1)
+    d = 1.0 / (d if abs(d) > tiny else tiny)
+    fraction = d
+    for m in range(1, 200):
+        for numerator in (m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m)),
+                          -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1))):
+            d = 1.0 + numerator * d
+            d = 1.0 / (d if abs(d) > tiny else tiny)
+            c = 1.0 + numerator / c
+            c = c if abs(c) > tiny else tiny
+            fraction *= c * d
+        if abs(c * d - 1.0) < 1e-12:
+            break
+    return front * fraction
+
+
+def welch_p_value(baseline, current):
+    """two sided p-value of Welch's t-test for equal means"""
+    if len(baseline) < 2 or len(current) < 2:
+        return float("nan")
+    baseline_mean, baseline_variance = mean_and_variance(baseline)
+    current_mean, current_variance = mean_and_variance(current)
+    baseline_error = baseline_variance / len(baseline)
+    current_error = current_variance / len(current)
+    if baseline_error + current_error == 0:
+        return 0.0 if baseline_mean != current_mean else 1.0
+    t = (current_mean - baseline_mean) / math.sqrt(baseline_error + current_error)
+    degrees_of_freedom = (baseline_error + current_error) ** 2 / (
+        baseline_error ** 2 / (len(baseline) - 1) + current_error ** 2 / (len(current) - 1))
+    return incomplete_beta(degrees_of_freedom / 2, 0.5, degrees_of_freedom / (degrees_of_freedom + t * t))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline", help="baseline JSON written by --update")
+    parser.add_argument("results", nargs="+", help="benchmark JSON files of the current build")
+    parser.add_argument("--threshold", type=float, default=0.05, help="relative slowdown that counts as regression. Default: 0.05")
+    parser.add_argument("--alpha", type=float, default=0.01, help="significance level of the t-test. Default: 0.01")
+    parser.add_argument("--update", action="store_true", help="replace the baseline with the given results")
+    arguments = parser.parse_args()
+
+    context, current = load_samples(arguments.results)
+    if arguments.update:
+        write_baseline(arguments.baseline, context, current)
+        print(f"wrote {len(current)} benchmarks to {arguments.baseline}")
+        return 0
+
+    with open(arguments.baseline) as json_file:
+        baseline_report = json.load(json_file)
+    baseline_context = baseline_report.get("context", {})
+    baseline = {name: entry["real_time_seconds"] for name, entry in baseline_report["benchmarks"].items()}
+    same_machine = all(baseline_context.get(key) == context.get(key) for key in MACHINE_KEYS)
+    if not same_machine:
+        print(f"baseline from {', '.join(str(baseline_context.get(key)) for key in MACHINE_KEYS)},"
+              f" results from {', '.join(str(context.get(key)) for key in MACHINE_KEYS)}:"
+              f" not judging regressions, run benchmark-baseline-update on this machine first", file=sys.stderr)
+
+    name_width = max([len(name) for name in current] + [9])
+    print(f"{'benchmark':<{name_width}} {'baseline':>12} {'current':>12} {'delta':>8} {'p-value':>8}  verdict")
+    regressions = []
+    for name in sorted(set(baseline) | set(current)):
+        if name not in current:
+            print(f"{name:<{name_width}} {'':>12} {'':>12} {'':>8} {'':>8}  missing")
+            continue
+        current_mean, _ = mean_and_variance(current[name])
+        if name not in baseline:
+            print(f"{name:<{name_width}} {'':>12} {current_mean * 1e3:>10.3f}ms {'':>8} {'':>8}  new")
+            continue
+        baseline_mean, _ = mean_and_variance(baseline[name])
+        delta = current_mean / baseline_mean - 1
+        p_value = welch_p_value(baseline[name], current[name])
+        # with a single sample per side only the threshold decides
+        significant = math.isnan(p_value) or p_value < arguments.alpha
+        verdict = "ok"
+        if significant and delta > arguments.threshold and not same_machine:
+            verdict = "slower"
+        elif significant and delta > arguments.threshold:
+            verdict = "REGRESSION"
+            regressions.append(name)
+        elif significant and delta < -arguments.threshold:
+            verdict = "faster"
+        print(f"{name:<{name_width}} {baseline_mean * 1e3:>10.3f}ms {current_mean * 1e3:>10.3f}ms {delta:>+8.1%} {p_value:>8.4f}  {verdict}")
+
+    if regressions:
+        print(f"\n{len(regressions)} regression(s) beyond {arguments.threshold:.0%} at alpha {arguments.alpha}")
+        return 1
+    if not same_machine:
+        print("\nbaseline from another machine or build type, regressions not judged")
+        return 0
+    print(f"\nno regressions beyond {arguments.threshold:.0%} at alpha {arguments.alpha}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
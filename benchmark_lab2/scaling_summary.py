@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Strong and weak scaling summary of the lab2 benchmarks.
+
+Run the benchmarks with JSON output first, e.g.
+
+    lab2_benchmarks --benchmark_filter='benchmark_(simulation_engine|weak_scaling)' \
+        --benchmark_out=scaling.json --benchmark_out_format=json
+
+and then
+
+    python3 scaling_summary.py scaling.json --plot-prefix scaling
+
+prints the speedup and efficiency tables and, if matplotlib is available, writes
+scaling_strong.png and scaling_weak.png.
+"""
+
+import argparse
+import json
+import sys
+from collections import defaultdict
+
+INPUT_NAMES = {0: "uniform", 1: "plummer"}
+
+
+def load_runs(path):
+    with open(path) as json_file:
+        report = json.load(json_file)
+    # with --benchmark_repetitions only the medians are used
+    has_aggregates = any(run.get("run_type") == "aggregate" for run in report["benchmarks"])
+    runs = []
+    for run in report["benchmarks"]:
+        if has_aggregates and run.get("aggregate_name") != "median":
+            continue
+        if "bodies" not in run or "threads" not in run:
+            continue
+        runs.append(run)
+    return report.get("context", {}), runs
+
+
+def get_family(run):
+    # "benchmark_simulation_engine/BarnesHut/bodies:1000/threads:1/input:0/real_time" -> family and engine
+    parts = run["run_name"].split("/") if "run_name" in run else run["name"].split("/")
+    return parts[0], parts[1] if len(parts) > 1 and ":" not in parts[1] else ""
+
+
+def group_runs(runs, family):
+    # (engine, bodies or bodies per thread, input) -> {threads: run}
+    groups = defaultdict(dict)
+    for run in runs:
+        run_family, engine = get_family(run)
+        if run_family != family:
+            continue
+        threads = int(run["threads"])
+        bodies = int(run["bodies"])
+        if family == "benchmark_weak_scaling":
+            bodies //= threads
+        groups[(engine, bodies, int(run.get("input", 0)))][threads] = run
+    return groups
+
+
+def print_table(title, groups, efficiency):
+    if not groups:
+        return
+    print(title)
+    print(f"{'engine':<28} {'bodies':>10} {'input':>8} {'threads':>8} {'ms/epoch':>12} {'bodies*epochs/s':>16} {'interactions/s':>16} {'speedup':>8} {'efficiency':>10}")
+    for (engine, bodies, input_id), runs_by_threads in sorted(groups.items()):
+        base = runs_by_threads.get(1)
+        for threads, run in sorted(runs_by_threads.items()):
+            speedup = base["real_time"] / run["real_time"] if base else float("nan")
+            scaling = efficiency(speedup, threads)
+            print(f"{engine:<28} {bodies:>10} {INPUT_NAMES.get(input_id, input_id):>8} {threads:>8} {run['real_time']:>12.3f}"
+                  f" {run.get('bodies_per_second', 0):>16.4g} {run.get('interactions_per_second', 0):>16.4g} {speedup:>8.2f} {scaling:>10.2f}")
+    print()
+
+
+def plot(groups, file_name, ylabel, value, ideal):
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print(f"matplotlib not found, {file_name} not written", file=sys.stderr)
+        return
+    figure, axes = plt.subplots(figsize=(8, 5))
+    max_threads = 1
+    for (engine, bodies, input_id), runs_by_threads in sorted(groups.items()):
+        base = runs_by_threads.get(1)
+        if base is None or len(runs_by_threads) < 2:
+            continue
+        threads = sorted(runs_by_threads)
+        max_threads = max(max_threads, threads[-1])
+        values = [value(base["real_time"] / runs_by_threads[count]["real_time"], count) for count in threads]
+        axes.plot(threads, values, marker="o", label=f"{engine} n={bodies} {INPUT_NAMES.get(input_id, input_id)}")
+    axes.plot([1, max_threads], [ideal(1), ideal(max_threads)], color="gray", linestyle="--", label="ideal")
+    axes.set_xscale("log", base=2)
+    axes.set_xlabel("threads")
+    axes.set_ylabel(ylabel)
+    axes.legend(fontsize="small")
+    figure.tight_layout()
+    figure.savefig(file_name)
+    print(f"wrote {file_name}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("json_file", help="output of --benchmark_out_format=json")
+    parser.add_argument("--plot-prefix", help="write <prefix>_strong.png and <prefix>_weak.png")
+    arguments = parser.parse_args()
+
+    context, runs = load_runs(arguments.json_file)
+    print(f"{context.get('host_name', '')}: {context.get('num_cpus', '?')} cpus at {context.get('mhz_per_cpu', '?')} MHz")
+    print()
+
+    strong = group_runs(runs, "benchmark_simulation_engine")
+    weak = group_runs(runs, "benchmark_weak_scaling")
+    # strong scaling: speedup over one thread, efficiency = speedup / threads
+    print_table("strong scaling", strong, lambda speedup, threads: speedup / threads)
+    # weak scaling: bodies per thread fixed, efficiency = T(1) / T(p)
+    print_table("weak scaling, bodies per thread", weak, lambda speedup, threads: speedup)
+
+    if arguments.plot_prefix:
+        plot(strong, arguments.plot_prefix + "_strong.png", "speedup", lambda speedup, threads: speedup, lambda threads: threads)
+        plot(weak, arguments.plot_prefix + "_weak.png", "efficiency", lambda speedup, threads: speedup, lambda threads: 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,66 @@
+# Performance regression guard. `benchmark-regression-check` runs a fixed subset of the lab
+# benchmarks with repetitions and compares them against benchmark_lab2/regression_baseline.json,
+# the target fails on significant slowdowns. `benchmark-baseline-update` replaces the baseline, run
+# it on the reference machine after intended performance changes and commit the result. Results of
+# another host, cpu count or build type are only printed, run `benchmark-baseline-update` locally
+# first to guard a build on any other machine.
+find_package(Python3 COMPONENTS Interpreter)
+
+set(BENCHMARK_GUARD_LAB1_FILTER
+    "benchmark_naive_sequential/1000/1$"
+    CACHE STRING "Benchmarks of lab1_benchmarks checked by the regression guard")
+set(BENCHMARK_GUARD_LAB2_FILTER
+    "benchmark_simulation_engine/.*/bodies:10000/threads:1/input:0|benchmark_tree_build/bodies:100000/threads:1/|benchmark_get_bounding_box_parallel/bodies:1000000/threads:1/"
+    CACHE STRING "Benchmarks of lab2_benchmarks checked by the regression guard")
+set(BENCHMARK_GUARD_REPETITIONS
+    "8"
+    CACHE STRING "Samples per benchmark of the regression guard")
+set(BENCHMARK_GUARD_THRESHOLD
+    "0.05"
+    CACHE STRING "Relative slowdown the regression guard accepts")
+
+if(Python3_Interpreter_FOUND)
+  set(BENCHMARK_GUARD_BASELINE ${CMAKE_SOURCE_DIR}/benchmark_lab2/regression_baseline.json)
+  set(BENCHMARK_GUARD_SCRIPT ${CMAKE_SOURCE_DIR}/benchmark_lab2/compare_benchmarks.py)
+  set(BENCHMARK_GUARD_ARGUMENTS
+      --benchmark_repetitions=${BENCHMARK_GUARD_REPETITIONS}
+      --benchmark_min_time=0.1 --benchmark_out_format=json)
+  set(BENCHMARK_GUARD_RUNS
+      COMMAND
+      $<TARGET_FILE:lab1_benchmarks>
+      --benchmark_filter=${BENCHMARK_GUARD_LAB1_FILTER}
+      --benchmark_out=${CMAKE_BINARY_DIR}/benchmark_guard_lab1.json
+      ${BENCHMARK_GUARD_ARGUMENTS}
+      COMMAND
+      $<TARGET_FILE:lab2_benchmarks>
+      --benchmark_filter=${BENCHMARK_GUARD_LAB2_FILTER}
+      --benchmark_out=${CMAKE_BINARY_DIR}/benchmark_guard_lab2.json
+      ${BENCHMARK_GUARD_ARGUMENTS})
+
+  add_custom_target(
+    benchmark-regression-check
+    ${BENCHMARK_GUARD_RUNS}
+    COMMAND
+      ${Python3_EXECUTABLE} ${BENCHMARK_GUARD_SCRIPT} ${BENCHMARK_GUARD_BASELINE}
+      ${CMAKE_BINARY_DIR}/benchmark_guard_lab1.json
+      ${CMAKE_BINARY_DIR}/benchmark_guard_lab2.json
+      --threshold=${BENCHMARK_GUARD_THRESHOLD}
+    DEPENDS lab1_benchmarks lab2_benchmarks
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+    USES_TERMINAL
+    VERBATIM)
+
+  add_custom_target(
+    benchmark-baseline-update
+    ${BENCHMARK_GUARD_RUNS}
+    COMMAND
+      ${Python3_EXECUTABLE} ${BENCHMARK_GUARD_SCRIPT} ${BENCHMARK_GUARD_BASELINE}
+      ${CMAKE_BINARY_DIR}/benchmark_guard_lab1.json
+      ${CMAKE_BINARY_DIR}/benchmark_guard_lab2.json --update
+    DEPENDS lab1_benchmarks lab2_benchmarks
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+    USES_TERMINAL
+    VERBATIM)
+else()
+  message(STATUS "Python3 not found, benchmark-regression-check is not available")
+endif()
@@ -0,0 +1,82 @@
+#include "distributed/in_process_transport.h"
+
+#include <stdexcept>
+#include <string>
+
+std::vector<MessageBuffer> all_gather(Transport& transport, MessageTag tag, const MessageBuffer& message){
+    const std::int32_t rank = transport.get_rank();
+    const std::int32_t num_ranks = transport.get_num_ranks();
+    for (std::int32_t destination = 0; destination < num_ranks; destination++) {
+        if (destination != rank) {
+            transport.send(destination, tag, message);
+        }
+    }
+
+    std::vector<MessageBuffer> messages(num_ranks);
+    for (std::int32_t source = 0; source < num_ranks; source++) {
+        messages[source] = source == rank ? message : transport.receive(source, tag);
+    }
+    return messages;
+}
+
+InProcessTransportHub::InProcessTransportHub(std::int32_t arg_num_ranks) : num_ranks(arg_num_ranks), mailboxes(arg_num_ranks){
+    if (num_ranks < 1) {
+        throw std::invalid_argument("at least one rank is required, got " + std::to_string(num_ranks));
+    }
+}
+
+void InProcessTransportHub::deliver(std::int32_t source, std::int32_t destination, MessageTag tag, MessageBuffer message){
+    if (destination < 0 || destination >= num_ranks) {
+        throw std::invalid_argument("invalid destination rank: " + std::to_string(destination));
+    }
+    Mailbox& mailbox = mailboxes[destination];
+    {
+        std::lock_guard<std::mutex> lock(mailbox.mutex);
+        mailbox.messages[{source, tag}].push_back(std::move(message));
+    }
+    mailbox.message_arrived.notify_all();
+}
+
+MessageBuffer InProcessTransportHub::wait_for(std::int32_t source, std::int32_t destination, MessageTag tag){
+    if (source < 0 || source >= num_ranks) {
+        throw std::invalid_argument("invalid source rank: " + std::to_string(source));
+    }
+    Mailbox& mailbox = mailboxes[destination];
+    std::unique_lock<std::mutex> lock(mailbox.mutex);
+    auto& queue = mailbox.messages[{source, tag}];
+    mailbox.message_arrived.wait(lock, [this, &queue]() { return !queue.empty() || aborted; });
+    if (queue.empty()) {
+        throw std::runtime_error("transport aborted by another rank");
+    }
+    MessageBuffer message = std::move(queue.front());
+    queue.pop_front();
+    return message;
+}
+
+void InProcessTransportHub::abort(){
+    aborted = true;
+    for (auto& mailbox : mailboxes) {
+        // lock once so no rank misses the notification between its check and its wait
+        { std::lock_guard<std::mutex> lock(mailbox.mutex); }
+        mailbox.message_arrived.notify_all();
+    }
+}
+
+InProcessTransport::InProcessTransport(InProcessTransportHub& arg_hub, std::int32_t arg_rank) : hub(arg_hub), rank(arg_rank){
+}
+
+std::int32_t InProcessTransport::get_rank() const{
+    return rank;
+}
+
+std::int32_t InProcessTransport::get_num_ranks() const{
+    return hub.get_num_ranks();
+}
+
+void InProcessTransport::send(std::int32_t destination, MessageTag tag, MessageBuffer message){
+    hub.deliver(rank, destination, tag, std::move(message));
+}
+
+MessageBuffer InProcessTransport::receive(std::int32_t source, MessageTag tag){
+    return hub.wait_for(source, rank, tag);
+}
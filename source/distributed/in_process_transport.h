@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "distributed/transport.h"
+
+// Mailboxes of all ranks of a simulation that runs every rank as a thread of the same process.
+// Stand-in for MPI to run and test the distributed engines on a single machine.
+class InProcessTransportHub {
+public:
+    explicit InProcessTransportHub(std::int32_t arg_num_ranks);
+
+    [[nodiscard]] std::int32_t get_num_ranks() const{
+        return num_ranks;
+    }
+
+    void deliver(std::int32_t source, std::int32_t destination, MessageTag tag, MessageBuffer message);
+    [[nodiscard]] MessageBuffer wait_for(std::int32_t source, std::int32_t destination, MessageTag tag);
+    // wakes up all waiting ranks with an exception, used when a rank failed
+    void abort();
+
+private:
+    struct Mailbox {
+        std::mutex mutex;
+        std::condition_variable message_arrived;
+        std::map<std::pair<std::int32_t, MessageTag>, std::deque<MessageBuffer>> messages;
+    };
+
+    std::int32_t num_ranks;
+    std::vector<Mailbox> mailboxes;
+    std::atomic<bool> aborted = false;
+};
+
+class InProcessTransport : public Transport {
+public:
+    InProcessTransport(InProcessTransportHub& arg_hub, std::int32_t arg_rank);
+
+    [[nodiscard]] std::int32_t get_rank() const override;
+    [[nodiscard]] std::int32_t get_num_ranks() const override;
+
+    void send(std::int32_t destination, MessageTag tag, MessageBuffer message) override;
+    [[nodiscard]] MessageBuffer receive(std::int32_t source, MessageTag tag) override;
+
+private:
+    InProcessTransportHub& hub;
+    std::int32_t rank;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Byte buffer for the messages between ranks. Values are appended with write and read back in the
+// same order with read, only trivially copyable types are allowed.
+class MessageBuffer {
+public:
+    template <typename T>
+    void write(const T& value){
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be sent");
+        std::size_t offset = data.size();
+        data.resize(offset + sizeof(T));
+        std::memcpy(data.data() + offset, &value, sizeof(T));
+    }
+
+    template <typename T>
+    void write_vector(const std::vector<T>& values){
+        static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be sent");
+        write<std::uint64_t>(values.size());
+        std::size_t offset = data.size();
+        data.resize(offset + values.size() * sizeof(T));
+        if (!values.empty()) {
+            std::memcpy(data.data() + offset, values.data(), values.size() * sizeof(T));
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]] T read(){
+        T value;
+        check_remaining(sizeof(T));
+        std::memcpy(&value, data.data() + read_offset, sizeof(T));
+        read_offset += sizeof(T);
+        return value;
+    }
+
+    template <typename T>
+    void read_vector(std::vector<T>& values){
+        std::uint64_t size = read<std::uint64_t>();
+        check_remaining(size * sizeof(T));
+        values.resize(size);
+        if (size > 0) {
+            std::memcpy(values.data(), data.data() + read_offset, size * sizeof(T));
+        }
+        read_offset += size * sizeof(T);
+    }
+
+    [[nodiscard]] std::size_t get_size() const{
+        return data.size();
+    }
+
+private:
+    void check_remaining(std::size_t num_bytes) const{
+        if (read_offset + num_bytes > data.size()) {
+            throw std::out_of_range("read past the end of the message");
+        }
+    }
+
+    std::vector<std::byte> data;
+    std::size_t read_offset = 0;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include "distributed/message_buffer.h"
+
+// kind of a message, messages are matched by source rank and tag
+enum class MessageTag : std::int32_t {
+    bounding_box,
+    essential_tree,
+    key_histogram,
+    migration,
+    gather
+};
+
+// Point-to-point communication between the ranks of a distributed simulation, modelled after MPI
+// send/recv. Messages with the same source and tag arrive in the order they were sent.
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    [[nodiscard]] virtual std::int32_t get_rank() const = 0;
+    [[nodiscard]] virtual std::int32_t get_num_ranks() const = 0;
+
+    // does not wait for the receiver
+    virtual void send(std::int32_t destination, MessageTag tag, MessageBuffer message) = 0;
+    // blocks until a matching message arrived
+    [[nodiscard]] virtual MessageBuffer receive(std::int32_t source, MessageTag tag) = 0;
+};
+
+// sends the message to every other rank and returns the messages of all ranks, the own one included
+[[nodiscard]] std::vector<MessageBuffer> all_gather(Transport& transport, MessageTag tag, const MessageBuffer& message);
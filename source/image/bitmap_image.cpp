@@ -1,5 +1,6 @@
 #include "image/bitmap_image.h"
 
+#include <algorithm>
 #include <exception>
 
 BitmapImage::BitmapImage(const std::uint32_t image_height, const std::uint32_t image_width)
@@ -47,6 +48,26 @@ BitmapImage::BitmapPixel BitmapImage::get_pixel(const std::uint32_t y_position,
 	return pixels[y_position * width + x_position];
 }
 
+const BitmapImage::BitmapPixel* BitmapImage::get_row(const std::uint32_t y_position) const {
+	if (y_position >= height) {
+		throw std::exception{};
+	}
+
+	return pixels.data() + static_cast<std::size_t>(y_position) * width;
+}
+
+BitmapImage::BitmapPixel* BitmapImage::get_row(const std::uint32_t y_position) {
+	if (y_position >= height) {
+		throw std::exception{};
+	}
+
+	return pixels.data() + static_cast<std::size_t>(y_position) * width;
+}
+
+void BitmapImage::clear() noexcept {
+	std::fill(pixels.begin(), pixels.end(), BitmapPixel{ 0, 0, 0 });
+}
+
 std::uint32_t BitmapImage::get_height() const noexcept {
 	return height;
 }
@@ -58,9 +79,17 @@ std::uint32_t BitmapImage::get_width() const noexcept {
 BitmapImage BitmapImage::transpose() const {
 	auto transposed_image = BitmapImage(width, height);
 
-	for (auto y = std::uint32_t(0); y < height; y++) {
-		for (auto x = std::uint32_t(0); x < width; x++) {
-			transposed_image.set_pixel(x, y, get_pixel(y, x));
+	// blocks of 32x32 pixels keep reads and writes within a few cache lines
+	constexpr std::uint32_t block_size = 32;
+	for (auto block_y = std::uint32_t(0); block_y < height; block_y += block_size) {
+		for (auto block_x = std::uint32_t(0); block_x < width; block_x += block_size) {
+			const auto y_end = std::min(block_y + block_size, height);
+			const auto x_end = std::min(block_x + block_size, width);
+			for (auto y = block_y; y < y_end; y++) {
+				for (auto x = block_x; x < x_end; x++) {
+					transposed_image.pixels[static_cast<std::size_t>(x) * height + y] = pixels[static_cast<std::size_t>(y) * width + x];
+				}
+			}
 		}
 	}
 
@@ -16,6 +16,13 @@ public:
 
 	[[nodiscard]] BitmapPixel get_pixel(const std::uint32_t y_position, const std::uint32_t x_position) const;
 
+	// the width pixels of row y_position, for encoders that process whole rows
+	[[nodiscard]] const BitmapPixel* get_row(const std::uint32_t y_position) const;
+	[[nodiscard]] BitmapPixel* get_row(const std::uint32_t y_position);
+
+	// sets all pixels to black without reallocating
+	void clear() noexcept;
+
 	[[nodiscard]] std::uint32_t get_height() const noexcept;
 
 	[[nodiscard]] std::uint32_t get_width() const noexcept;
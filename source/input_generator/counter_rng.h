@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// Counter based random number generator. Every draw is a SplitMix64 hash of (seed, stream, draw index),
+// so body i gets the same numbers no matter which thread generates it or in which order.
+class CounterRng {
+public:
+    CounterRng(std::uint64_t seed, std::uint64_t stream) noexcept
+        : key(mix(seed + golden_gamma * mix(stream + 1))) {
+    }
+
+    std::uint64_t next_uint64() noexcept{
+        counter++;
+        return mix(key + golden_gamma * counter);
+    }
+
+    // uniform in [0, 1) with the full 53 bit mantissa
+    double next_double() noexcept{
+        return (next_uint64() >> 11) * 0x1.0p-53;
+    }
+
+    // uniform in [0, bound), the modulo bias is below 2^-40 for the small bounds of the generators
+    std::uint32_t next_below(std::uint32_t bound) noexcept{
+        return static_cast<std::uint32_t>(next_uint64() % bound);
+    }
+
+    static std::uint64_t mix(std::uint64_t value) noexcept{
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+
+private:
+    static constexpr std::uint64_t golden_gamma = 0x9e3779b97f4a7c15ull;
+
+    std::uint64_t key;
+    std::uint64_t counter = 0;
+};
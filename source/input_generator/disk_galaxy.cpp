@@ -0,0 +1,72 @@
+#include "input_generator.h"
+#include "input_generator/counter_rng.h"
+#include "physics/gravitation.h"
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+namespace {
+    // weight of Sagittarius A*, the disk holds the same mass again
+    const double central_weight = 8.54 * 1e36;  // kg
+    const double disk_weight = 8.54 * 1e36;  // kg
+    const double disk_scale_length = 4.73 * 1e14;  // m
+}
+
+void InputGenerator::create_disk_bodies(Universe& universe, std::uint32_t first_body, std::uint32_t bodies, std::uint64_t seed, Vector2d<double> center, Vector2d<double> velocity, bool counter_clockwise){
+    if(bodies == 0){
+        return;
+    }
+    universe.weights[first_body] = central_weight;
+    universe.forces[first_body] = Vector2d<double>(0, 0);
+    universe.positions[first_body] = center;
+    universe.velocities[first_body] = velocity;
+
+    const double body_weight = bodies > 1 ? disk_weight / (bodies - 1) : 0;
+    const double direction = counter_clockwise ? 1 : -1;
+    const std::int64_t begin = first_body + 1;
+    const std::int64_t end = first_body + bodies;
+#pragma omp parallel for schedule(static)
+    for(std::int64_t i = begin; i < end; i++){
+        CounterRng rng(seed, i);
+
+        // surface density exp(-r/h) puts the radii on a gamma distribution with shape 2, the sum of two exponential
+        // variables. Orbits closer than h/10 would be shorter than a few epochs, orbits beyond 10h are dropped.
+        double radius = 0;
+        do{
+            radius = -disk_scale_length * std::log((1 - rng.next_double()) * (1 - rng.next_double()));
+        } while(radius < 0.1 * disk_scale_length || radius > 10 * disk_scale_length);
+        const double angle = 2 * std::numbers::pi * rng.next_double();
+
+        // circular velocity of the central mass and the disk mass inside the orbit, with a dispersion of 5%
+        const double x = radius / disk_scale_length;
+        const double enclosed_weight = central_weight + disk_weight * (1 - (1 + x) * std::exp(-x));
+        const double circular_velocity = std::sqrt(gravitational_constant * enclosed_weight / radius);
+        const double dispersion_x = 0.05 * circular_velocity * (2 * rng.next_double() - 1);
+        const double dispersion_y = 0.05 * circular_velocity * (2 * rng.next_double() - 1);
+
+        const Vector2d<double> radial(std::cos(angle), std::sin(angle));
+        const Vector2d<double> tangential(-radial[1] * direction, radial[0] * direction);
+        universe.weights[i] = body_weight;
+        universe.forces[i] = Vector2d<double>(0, 0);
+        universe.positions[i] = center + radial * radius;
+        universe.velocities[i] = velocity + tangential * circular_velocity + Vector2d<double>(dispersion_x, dispersion_y);
+    }
+}
+
+void InputGenerator::create_disk_galaxy(std::uint32_t bodies, Universe& universe, std::uint64_t seed){
+    allocate_bodies(bodies, universe);
+    create_disk_bodies(universe, 0, bodies, seed, Vector2d<double>(0, 0), Vector2d<double>(0, 0), true);
+}
+
+void InputGenerator::create_galaxy_merger(std::uint32_t bodies, Universe& universe, std::uint64_t seed){
+    allocate_bodies(bodies, universe);
+
+    // two disks rotating in opposite directions approach each other on a parabolic orbit with an impact parameter of 2h
+    const double separation = 8 * disk_scale_length;
+    const double impact_parameter = 2 * disk_scale_length;
+    const double total_weight = 2 * (central_weight + disk_weight);
+    const double approach_velocity = 0.5 * std::sqrt(2 * gravitational_constant * total_weight / separation);
+    const std::uint32_t first_galaxy_bodies = bodies / 2;
+    create_disk_bodies(universe, 0, first_galaxy_bodies, seed, Vector2d<double>(-separation / 2, -impact_parameter / 2), Vector2d<double>(approach_velocity, 0), true);
+    create_disk_bodies(universe, first_galaxy_bodies, bodies - first_galaxy_bodies, seed, Vector2d<double>(separation / 2, impact_parameter / 2), Vector2d<double>(-approach_velocity, 0), false);
+}
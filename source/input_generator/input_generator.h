@@ -6,8 +6,22 @@
 
 class InputGenerator{
 public:
-    static void create_random_universe(std::uint32_t bodies, Universe& universe);
+    // the random generators draw the numbers of body i from (seed, i), a fixed seed creates the same universe with any number of threads
+    static void create_random_universe(std::uint32_t bodies, Universe& universe, std::uint64_t seed = get_time_seed());
     static void create_earth_orbit(Universe& universe);
-    static void create_random_universe_with_supermassive_blackholes(std::uint32_t bodies, Universe& universe, std::uint32_t black_holes);
+    static void create_random_universe_with_supermassive_blackholes(std::uint32_t bodies, Universe& universe, std::uint32_t black_holes, std::uint64_t seed = get_time_seed());
     static void create_two_body_collision(Universe& universe);
-};
\ No newline at end of file
+    // clustered inputs for Barnes-Hut: a Plummer star cluster, an exponential disk around a central black hole and two colliding disks
+    static void create_plummer_sphere(std::uint32_t bodies, Universe& universe, std::uint64_t seed = get_time_seed());
+    static void create_disk_galaxy(std::uint32_t bodies, Universe& universe, std::uint64_t seed = get_time_seed());
+    static void create_galaxy_merger(std::uint32_t bodies, Universe& universe, std::uint64_t seed = get_time_seed());
+
+    // different for every call, for runs without --seed
+    static std::uint64_t get_time_seed();
+
+private:
+    static void allocate_bodies(std::uint32_t bodies, Universe& universe);
+    static void create_random_bodies(std::uint32_t bodies, Universe& universe, std::uint64_t seed, int min_weight_exponent);
+    // bodies [first_body, first_body + bodies) become a disk in rotational equilibrium, first_body is its central mass
+    static void create_disk_bodies(Universe& universe, std::uint32_t first_body, std::uint32_t bodies, std::uint64_t seed, Vector2d<double> center, Vector2d<double> velocity, bool counter_clockwise);
+};
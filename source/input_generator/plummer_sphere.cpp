@@ -0,0 +1,88 @@
+#include "input_generator.h"
+#include "input_generator/counter_rng.h"
+#include "physics/gravitation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+void InputGenerator::create_plummer_sphere(std::uint32_t bodies, Universe& universe, std::uint64_t seed){
+    allocate_bodies(bodies, universe);
+    if(bodies == 0){
+        return;
+    }
+
+    // a star cluster of sun-like stars, scale radius of 0.1ly
+    const double body_weight = 1.989 * 1e30;  // kg
+    const double scale_radius = 9.46 * 1e14;  // m
+    const double total_weight = body_weight * bodies;
+    const double escape_velocity_scale = std::sqrt(2 * gravitational_constant * total_weight / scale_radius);
+
+    const std::int64_t num_bodies = bodies;
+#pragma omp parallel for schedule(static)
+    for(std::int64_t i = 0; i < num_bodies; i++){
+        CounterRng rng(seed, i);
+
+        // radius from the inverse of the enclosed mass, the outermost 0.1% of the mass is cut off
+        const double enclosed_mass = 0.999 * rng.next_double();
+        const double radius = scale_radius / std::sqrt(std::pow(enclosed_mass, -2.0 / 3.0) - 1);
+
+        // speed in units of the local escape velocity by rejection sampling of the isotropic distribution function
+        double speed_fraction = 0;
+        while(true){
+            const double x = rng.next_double();
+            const double y = 0.1 * rng.next_double();
+            if(y < x * x * std::pow(1 - x * x, 3.5)){
+                speed_fraction = x;
+                break;
+            }
+        }
+        const double speed = speed_fraction * escape_velocity_scale * std::pow(1 + radius * radius / (scale_radius * scale_radius), -0.25);
+
+        // isotropic directions in 3d, the simulation plane gets the projection
+        const double position_cos = 2 * rng.next_double() - 1;
+        const double position_angle = 2 * std::numbers::pi * rng.next_double();
+        const double position_sin = std::sqrt(1 - position_cos * position_cos);
+        const double velocity_cos = 2 * rng.next_double() - 1;
+        const double velocity_angle = 2 * std::numbers::pi * rng.next_double();
+        const double velocity_sin = std::sqrt(1 - velocity_cos * velocity_cos);
+
+        universe.weights[i] = body_weight;
+        universe.forces[i] = Vector2d<double>(0, 0);
+        universe.positions[i] = Vector2d<double>(radius * position_sin * std::cos(position_angle), radius * position_sin * std::sin(position_angle));
+        universe.velocities[i] = Vector2d<double>(speed * velocity_sin * std::cos(velocity_angle), speed * velocity_sin * std::sin(velocity_angle));
+    }
+
+    // Move the center of mass into the origin and at rest, all bodies weigh the same. The sums are
+    // taken over fixed blocks of bodies and the blocks are added in order, so the rounding and the
+    // universe do not depend on the number of threads like an OpenMP reduction would.
+    const std::int64_t block_size = 4096;
+    const std::int64_t num_blocks = (num_bodies + block_size - 1) / block_size;
+    std::vector<Vector2d<double>> block_position_sums(num_blocks);
+    std::vector<Vector2d<double>> block_velocity_sums(num_blocks);
+#pragma omp parallel for schedule(static)
+    for(std::int64_t block = 0; block < num_blocks; block++){
+        Vector2d<double> position_sum(0, 0);
+        Vector2d<double> velocity_sum(0, 0);
+        for(std::int64_t i = block * block_size; i < std::min(num_bodies, (block + 1) * block_size); i++){
+            position_sum = position_sum + universe.positions[i];
+            velocity_sum = velocity_sum + universe.velocities[i];
+        }
+        block_position_sums[block] = position_sum;
+        block_velocity_sums[block] = velocity_sum;
+    }
+    Vector2d<double> position_sum(0, 0);
+    Vector2d<double> velocity_sum(0, 0);
+    for(std::int64_t block = 0; block < num_blocks; block++){
+        position_sum = position_sum + block_position_sums[block];
+        velocity_sum = velocity_sum + block_velocity_sums[block];
+    }
+    const Vector2d<double> mean_position = position_sum / bodies;
+    const Vector2d<double> mean_velocity = velocity_sum / bodies;
+#pragma omp parallel for schedule(static)
+    for(std::int64_t i = 0; i < num_bodies; i++){
+        universe.positions[i] = universe.positions[i] - mean_position;
+        universe.velocities[i] = universe.velocities[i] - mean_velocity;
+    }
+}
@@ -1,27 +1,38 @@
 #include "input_generator.h"
-#include <ctime>
+#include "input_generator/counter_rng.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
-#include <random>
-#include <iostream>
 
-void InputGenerator::create_random_universe(std::uint32_t bodies, Universe& universe){
-std::srand(std::time(nullptr));  // seed random number generator with the current time
-
-    //std::cout << "Creating universe randomly with " << bodies << " bodies." << std::endl;
+std::uint64_t InputGenerator::get_time_seed(){
+    // the counter keeps two calls within the same clock tick apart
+    static std::atomic<std::uint64_t> num_calls{0};
+    const auto now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    return CounterRng::mix(static_cast<std::uint64_t>(now) ^ CounterRng::mix(num_calls++));
+}
 
+void InputGenerator::allocate_bodies(std::uint32_t bodies, Universe& universe){
     universe.num_bodies = bodies;
 
-    // reserve space in the vectors 
+    // reserve space in the vectors, large arrays are first touched with the static schedule of the generator loops
     universe.weights.resize(bodies);
     universe.velocities.resize(bodies);
     universe.positions.resize(bodies);
     universe.forces.resize(bodies);
+}
 
-    for(int i = 0; i < bodies; i++){
-        // generate random weights roughly between the mass of the black hole in the milky way and merkur
+void InputGenerator::create_random_bodies(std::uint32_t bodies, Universe& universe, std::uint64_t seed, int min_weight_exponent){
+    allocate_bodies(bodies, universe);
 
-        double mantissa = (double)rand() / RAND_MAX;
-        int exponent = (std::rand() % 13) + 23;
+    const std::int64_t num_bodies = bodies;
+#pragma omp parallel for schedule(static)
+    for(std::int64_t i = 0; i < num_bodies; i++){
+        CounterRng rng(seed, i);
+
+        // generate random weights roughly between the mass of the black hole in the milky way and merkur
+        double mantissa = rng.next_double();
+        int exponent = rng.next_below(13) + min_weight_exponent;
 
         double random_weight = mantissa * std::pow(10, exponent);
 
@@ -32,18 +43,12 @@ std::srand(std::time(nullptr));  // seed random number generator with the curren
         initial_force.set(0,0);
         universe.forces[i] = initial_force;
 
-        // generate random velocities similar to that of the earth
+        // generate random velocities similar to that of the earth, both signs with the same probability
         Vector2d<double> initial_velocity;
-        std::uint64_t max_velocity = 30000; 
+        double max_velocity = 30000;
 
-        double rand_velocity_x = ((double)rand() / RAND_MAX) * max_velocity;
-        double rand_velocity_y = ((double)rand() / RAND_MAX) * max_velocity;
-        if(((double)rand() / RAND_MAX) > 0.5){
-            rand_velocity_x = rand_velocity_x * (-1);  // flip direction
-        }
-        if(((double)rand() / RAND_MAX) > 0.5){
-            rand_velocity_y = rand_velocity_y * (-1);  // flip direction
-        }
+        double rand_velocity_x = (2 * rng.next_double() - 1) * max_velocity;
+        double rand_velocity_y = (2 * rng.next_double() - 1) * max_velocity;
 
         initial_velocity.set(rand_velocity_x, rand_velocity_y);
         universe.velocities[i] = initial_velocity;
@@ -51,16 +56,14 @@ std::srand(std::time(nullptr));  // seed random number generator with the curren
         // generate random positions. Use a square of size 0.1ly
         double max_universe_radius = 9.46*1e14;  // m
         Vector2d<double> initial_position;
-        double rand_position_x = ((double)rand() / RAND_MAX) * max_universe_radius;
-        double rand_position_y = ((double)rand() / RAND_MAX) * max_universe_radius;
-        if(((double)rand() / RAND_MAX) > 0.5){
-            rand_position_x = rand_position_x * (-1);  // flip direction
-        }
-        if(((double)rand() / RAND_MAX) > 0.5){
-            rand_position_y = rand_position_y * (-1);  // flip direction
-        }
+        double rand_position_x = (2 * rng.next_double() - 1) * max_universe_radius;
+        double rand_position_y = (2 * rng.next_double() - 1) * max_universe_radius;
 
         initial_position.set(rand_position_x, rand_position_y);
         universe.positions[i] = initial_position;
     }
-}
\ No newline at end of file
+}
+
+void InputGenerator::create_random_universe(std::uint32_t bodies, Universe& universe, std::uint64_t seed){
+    create_random_bodies(bodies, universe, seed, 23);
+}
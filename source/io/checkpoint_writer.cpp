@@ -0,0 +1,91 @@
+#include "io/checkpoint_writer.h"
+#include "io/universe_snapshot.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+CheckpointWriter::CheckpointWriter(std::filesystem::path arg_checkpoint_path, std::uint32_t arg_checkpoint_every)
+    : checkpoint_path(std::move(arg_checkpoint_path)), checkpoint_every(arg_checkpoint_every){
+    if (checkpoint_every == 0) {
+        throw std::invalid_argument("checkpoint interval must be at least one epoch");
+    }
+    worker = std::thread([this]() { run(); });
+}
+
+CheckpointWriter::~CheckpointWriter(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    state_changed.notify_all();
+    worker.join();
+}
+
+void CheckpointWriter::on_epoch_end(Universe& universe, SimulationContext&){
+    if (universe.current_simulation_epoch % checkpoint_every == 0) {
+        request_checkpoint(universe);
+    }
+}
+
+void CheckpointWriter::request_checkpoint(Universe& universe){
+    {
+        // assigning into the same universe reuses its buffers, the copy does not allocate after the first checkpoint
+        std::lock_guard<std::mutex> lock(mutex);
+        pending_universe = universe;
+        has_pending = true;
+    }
+    state_changed.notify_all();
+}
+
+void CheckpointWriter::flush(){
+    std::unique_lock<std::mutex> lock(mutex);
+    state_changed.wait(lock, [this]() { return !has_pending && !writing; });
+    if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+std::uint32_t CheckpointWriter::get_num_written() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_written;
+}
+
+void CheckpointWriter::run(){
+    Universe writing_universe;
+    std::filesystem::path temporary_path = checkpoint_path;
+    temporary_path += ".tmp";
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            state_changed.wait(lock, [this]() { return has_pending || stopping; });
+            if (!has_pending) {
+                return;
+            }
+            // swap instead of copy, the simulation thread may refill the pending universe meanwhile
+            std::swap(writing_universe, pending_universe);
+            has_pending = false;
+            writing = true;
+        }
+
+        std::exception_ptr write_error;
+        try {
+            UniverseSnapshot::save(temporary_path, writing_universe);
+            std::filesystem::rename(temporary_path, checkpoint_path);
+        } catch (...) {
+            write_error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            writing = false;
+            if (write_error) {
+                error = write_error;
+            } else {
+                num_written++;
+            }
+        }
+        state_changed.notify_all();
+    }
+}
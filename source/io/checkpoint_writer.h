@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#include "structures/universe.h"
+#include "simulation/simulation_observer.h"
+
+// Writes a binary snapshot of the universe every checkpoint_every epochs. The observer only copies
+// the body arrays; serializing and writing happen on a background thread. A checkpoint is first
+// written to <path>.tmp and then renamed, so the checkpoint file is always complete. If a checkpoint
+// is requested while the previous one is still being written, the newer state replaces the waiting one.
+//
+// The state of a run is the body arrays and the epoch counter: the integrator keeps no state
+// besides the velocities and no random numbers are drawn after the universe is created.
+class CheckpointWriter : public SimulationObserver {
+public:
+    CheckpointWriter(std::filesystem::path arg_checkpoint_path, std::uint32_t arg_checkpoint_every);
+    ~CheckpointWriter() override;
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void on_epoch_end(Universe& universe, SimulationContext& context) override;
+
+    // queues a checkpoint of the current state independent of the interval
+    void request_checkpoint(Universe& universe);
+    // waits until all queued checkpoints are on disk, rethrows errors of the background thread
+    void flush();
+
+    [[nodiscard]] std::uint32_t get_num_written() const;
+
+private:
+    void run();
+
+    std::filesystem::path checkpoint_path;
+    std::uint32_t checkpoint_every;
+
+    mutable std::mutex mutex;
+    std::condition_variable state_changed;
+    Universe pending_universe;
+    bool has_pending = false;
+    bool writing = false;
+    bool stopping = false;
+    std::uint32_t num_written = 0;
+    std::exception_ptr error;
+
+    std::thread worker;
+};
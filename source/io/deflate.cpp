@@ -0,0 +1,194 @@
+#include "io/deflate.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t window_size = 32768;
+constexpr std::size_t min_match = 3;
+constexpr std::size_t max_match = 258;
+constexpr std::size_t hash_bits = 15;
+
+constexpr std::array<std::uint16_t, 29> length_base = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+constexpr std::array<std::uint8_t, 29> length_extra_bits = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+constexpr std::array<std::uint16_t, 30> distance_base = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+constexpr std::array<std::uint8_t, 30> distance_extra_bits = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// deflate writes bits starting at the least significant bit of every byte
+class BitWriter {
+public:
+	explicit BitWriter(std::vector<std::uint8_t>& arg_output) : output(arg_output) {}
+
+	void write_bits(std::uint32_t value, std::uint32_t num_bits) {
+		bit_buffer |= static_cast<std::uint64_t>(value) << num_bits_buffered;
+		num_bits_buffered += num_bits;
+		while (num_bits_buffered >= 8) {
+			output.push_back(static_cast<std::uint8_t>(bit_buffer));
+			bit_buffer >>= 8;
+			num_bits_buffered -= 8;
+		}
+	}
+
+	// Huffman codes are stored starting with their most significant bit
+	void write_code(std::uint32_t code, std::uint32_t num_bits) {
+		std::uint32_t reversed = 0;
+		for (std::uint32_t bit = 0; bit < num_bits; bit++) {
+			reversed |= ((code >> bit) & 1) << (num_bits - 1 - bit);
+		}
+		write_bits(reversed, num_bits);
+	}
+
+	void align_to_byte() {
+		if (num_bits_buffered > 0) {
+			write_bits(0, 8 - num_bits_buffered);
+		}
+	}
+
+private:
+	std::vector<std::uint8_t>& output;
+	std::uint64_t bit_buffer = 0;
+	std::uint32_t num_bits_buffered = 0;
+};
+
+// fixed literal/length code of RFC 1951 3.2.6
+void write_literal_length(BitWriter& writer, std::uint32_t symbol) {
+	if (symbol < 144) {
+		writer.write_code(0x30 + symbol, 8);
+	} else if (symbol < 256) {
+		writer.write_code(0x190 + symbol - 144, 9);
+	} else if (symbol < 280) {
+		writer.write_code(symbol - 256, 7);
+	} else {
+		writer.write_code(0xc0 + symbol - 280, 8);
+	}
+}
+
+void write_match(BitWriter& writer, std::size_t length, std::size_t distance) {
+	std::size_t length_code = length_base.size() - 1;
+	while (length_base[length_code] > length) {
+		length_code--;
+	}
+	write_literal_length(writer, 257 + length_code);
+	writer.write_bits(length - length_base[length_code], length_extra_bits[length_code]);
+
+	std::size_t distance_code = distance_base.size() - 1;
+	while (distance_base[distance_code] > distance) {
+		distance_code--;
+	}
+	writer.write_code(distance_code, 5);
+	writer.write_bits(distance - distance_base[distance_code], distance_extra_bits[distance_code]);
+}
+
+std::uint32_t get_hash(const std::uint8_t* data) {
+	const std::uint32_t value = data[0] | (data[1] << 8) | (data[2] << 16);
+	return (value * 2654435761u) >> (32 - hash_bits);
+}
+
+}
+
+void Deflate::compress_segment(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& output) {
+	BitWriter writer(output);
+	// not final, fixed Huffman codes
+	writer.write_bits(0, 1);
+	writer.write_bits(1, 2);
+
+	// position + 1 of the last occurrence of every hash, 0 for none
+	thread_local std::vector<std::uint32_t> head;
+	head.assign(std::size_t{1} << hash_bits, 0);
+	std::size_t position = 0;
+	while (position < size) {
+		std::size_t match_length = 0;
+		std::size_t match_distance = 0;
+		if (position + min_match <= size) {
+			const std::uint32_t hash = get_hash(data + position);
+			const std::size_t candidate = head[hash];
+			head[hash] = static_cast<std::uint32_t>(position + 1);
+			if (candidate > 0 && position - (candidate - 1) <= window_size) {
+				const std::size_t match_start = candidate - 1;
+				const std::size_t max_length = std::min(max_match, size - position);
+				while (match_length < max_length && data[match_start + match_length] == data[position + match_length]) {
+					match_length++;
+				}
+				match_distance = position - match_start;
+			}
+		}
+
+		if (match_length >= min_match) {
+			write_match(writer, match_length, match_distance);
+			// remember the last positions of the match, long runs stay cheap
+			const std::size_t match_end = position + match_length;
+			for (std::size_t skipped = std::max(position + 1, match_end > 16 ? match_end - 16 : 0); skipped + min_match <= size && skipped < match_end; skipped++) {
+				head[get_hash(data + skipped)] = static_cast<std::uint32_t>(skipped + 1);
+			}
+			position = match_end;
+		} else {
+			write_literal_length(writer, data[position]);
+			position++;
+		}
+	}
+	write_literal_length(writer, 256);
+
+	// empty stored block, the segment ends on a byte boundary
+	writer.write_bits(0, 1);
+	writer.write_bits(0, 2);
+	writer.align_to_byte();
+	const std::uint8_t empty_stored_length[4] = {0x00, 0x00, 0xff, 0xff};
+	output.insert(output.end(), empty_stored_length, empty_stored_length + 4);
+}
+
+void Deflate::finish_stream(std::vector<std::uint8_t>& output) {
+	// final block with fixed codes holding only the end of block symbol
+	BitWriter writer(output);
+	writer.write_bits(1, 1);
+	writer.write_bits(1, 2);
+	write_literal_length(writer, 256);
+	writer.align_to_byte();
+}
+
+std::uint32_t Deflate::get_adler32(const std::uint8_t* data, std::size_t size, std::uint32_t adler) {
+	std::uint32_t a = adler & 0xffff;
+	std::uint32_t b = adler >> 16;
+	// 5552 bytes are the most that can be summed without overflowing before the modulo
+	while (size > 0) {
+		const std::size_t block = std::min<std::size_t>(size, 5552);
+		for (std::size_t i = 0; i < block; i++) {
+			a += data[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+		data += block;
+		size -= block;
+	}
+	return (b << 16) | a;
+}
+
+std::uint32_t Deflate::get_crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc) {
+	static const std::array<std::uint32_t, 256> table = []() {
+		std::array<std::uint32_t, 256> entries{};
+		for (std::uint32_t n = 0; n < 256; n++) {
+			std::uint32_t c = n;
+			for (int k = 0; k < 8; k++) {
+				c = (c & 1) != 0 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			}
+			entries[n] = c;
+		}
+		return entries;
+	}();
+
+	crc = ~crc;
+	for (std::size_t i = 0; i < size; i++) {
+		crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
+}
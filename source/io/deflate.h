@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Minimal deflate (RFC 1951) compressor for image output. Data is compressed with LZ77 and the
+// fixed Huffman codes, which suits the long runs of plotted frames. Every call of compress_segment
+// produces a byte aligned, self contained piece, so segments can be compressed in parallel and
+// concatenated into one stream; references never cross segment boundaries.
+class Deflate {
+public:
+	// appends the compressed segment followed by an empty stored block that aligns to a byte
+	static void compress_segment(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& output);
+	// appends the final empty block that terminates a stream of segments
+	static void finish_stream(std::vector<std::uint8_t>& output);
+
+	// checksum of the zlib format (RFC 1950), continued from adler
+	[[nodiscard]] static std::uint32_t get_adler32(const std::uint8_t* data, std::size_t size, std::uint32_t adler = 1);
+	// checksum of PNG chunks, continued from crc
+	[[nodiscard]] static std::uint32_t get_crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc = 0);
+};
@@ -1,7 +1,27 @@
 #include "io/image_parser.h"
+#include "io/deflate.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+template <typename T>
+static void put_value(std::vector<char>& buffer, std::size_t offset, const T value) {
+	std::memcpy(buffer.data() + offset, &value, sizeof(value));
+}
+
+template <typename T>
+static T get_value(const char* data, std::size_t offset) {
+	T value;
+	std::memcpy(&value, data + offset, sizeof(value));
+	return value;
+}
 
 BitmapImage ImageParser::read_bitmap(const std::filesystem::path& file_path) {
 	if (!std::filesystem::exists(file_path)) {
@@ -16,132 +36,463 @@ BitmapImage ImageParser::read_bitmap(const std::filesystem::path& file_path) {
 		throw std::exception{};
 	}
 
+	// one read for the whole file
 	auto file_reader = std::ifstream{ file_path , std::ios::binary | std::ios::in };
+	auto file_buffer = std::vector<char>(std::filesystem::file_size(file_path));
+	file_reader.read(file_buffer.data(), file_buffer.size());
+	if (!file_reader) {
+		throw std::exception{};
+	}
 
-	const auto read_from_file = [&file_reader](auto val) {
-		file_reader.read(reinterpret_cast<char*>(&val), sizeof(val));
-		if (!file_reader) {
-			throw std::exception{};
-		}
+	return decode_bitmap(file_buffer.data(), file_buffer.size());
+}
+
+BitmapImage ImageParser::decode_bitmap(const char* data, std::size_t size) {
+	if (size < bitmap_header_size) {
+		throw std::exception{};
+	}
 
-		return val;
-		};
-
-	auto bfType = std::uint16_t{};
-	auto bfSize = std::uint32_t{};
-	auto bfReserved = std::uint32_t{};
-	auto bfOffBits = std::uint32_t{};
-
-	bfType = read_from_file(bfType);
-	bfSize = read_from_file(bfSize);
-	bfReserved = read_from_file(bfReserved);
-	bfOffBits = read_from_file(bfOffBits);
-
-	auto biSize = std::uint32_t{};
-	auto biWidth = std::int32_t{};
-	auto biHeight = std::int32_t{};
-	auto biPlanes = std::uint16_t{};
-	auto biBitCount = std::uint16_t{};
-	auto biCompression = std::uint32_t{};
-	auto biSizeImage = std::uint32_t{};
-	auto biXPelsPerMeter = std::int32_t{};
-	auto biYPelsPerMeter = std::int32_t{};
-	auto biClrUsed = std::uint32_t{};
-	auto biClrImportant = std::uint32_t{};
-
-	biSize = read_from_file(biSize);
-	biWidth = read_from_file(biWidth);
-	biHeight = read_from_file(biHeight);
-	biPlanes = read_from_file(biPlanes);
-	biBitCount = read_from_file(biBitCount);
-	biCompression = read_from_file(biCompression);
-	biSizeImage = read_from_file(biSizeImage);
-	biXPelsPerMeter = read_from_file(biXPelsPerMeter);
-	biYPelsPerMeter = read_from_file(biYPelsPerMeter);
-	biClrUsed = read_from_file(biClrUsed);
-	biClrImportant = read_from_file(biClrImportant);
-
-	auto bitmap_buffer = std::vector<char>{};
-	bitmap_buffer.resize(biSizeImage);
-
-	file_reader.clear();
-	file_reader.seekg(bfOffBits);
-	file_reader.read(bitmap_buffer.data(), biSizeImage);
+	const auto bfType = get_value<std::uint16_t>(data, 0);
+	const auto bfOffBits = get_value<std::uint32_t>(data, 10);
+	const auto biWidth = get_value<std::int32_t>(data, 18);
+	const auto biHeight = get_value<std::int32_t>(data, 22);
+	const auto biBitCount = get_value<std::uint16_t>(data, 28);
+	const auto biCompression = get_value<std::uint32_t>(data, 30);
+
+	if (bfType != 19778 || biBitCount != 24 || biCompression != 0) {
+		throw std::exception{};
+	}
+
+	// an empty image has no rows to divide the pixel data into, and the magnitude of INT32_MIN is no int32
+	if (biWidth == 0 || biHeight == 0 || biWidth == std::numeric_limits<std::int32_t>::min() || biHeight == std::numeric_limits<std::int32_t>::min()) {
+		throw std::exception{};
+	}
 
 	const auto bitmap_height = static_cast<std::uint32_t>(std::abs(biHeight));
 	const auto bitmap_width = static_cast<std::uint32_t>(std::abs(biWidth));
+	// computed in 64 bits, 3 * width does not fit into get_bitmap_row_size for the widest images
+	const auto row_size = (3 * std::size_t{ bitmap_width } + 3) / 4 * 4;
+
+	if (bfOffBits > size || (size - bfOffBits) / row_size < bitmap_height) {
+		throw std::exception{};
+	}
 
 	auto bitmap = BitmapImage{ bitmap_height, bitmap_width };
+	const char* pixel_data = data + bfOffBits;
 
 	for (auto y = std::uint32_t(0); y < bitmap_height; y++) {
+		const char* row = pixel_data + y * row_size;
 		for (auto x = std::uint32_t(0); x < bitmap_width; x++) {
-			const auto index = y * bitmap_width * 3 + x * 3;
-
-			const auto blue = static_cast<BitmapImage::BitmapPixel::value_type>(bitmap_buffer[index]);
-			const auto green = static_cast<BitmapImage::BitmapPixel::value_type>(bitmap_buffer[index + 1]);
-			const auto red = static_cast<BitmapImage::BitmapPixel::value_type>(bitmap_buffer[index + 2]);
+			const auto blue = static_cast<BitmapImage::BitmapPixel::value_type>(row[3 * x]);
+			const auto green = static_cast<BitmapImage::BitmapPixel::value_type>(row[3 * x + 1]);
+			const auto red = static_cast<BitmapImage::BitmapPixel::value_type>(row[3 * x + 2]);
 
-			const auto pixel = BitmapImage::BitmapPixel{ red , green, blue };
-
-			bitmap.set_pixel(y, x, pixel);
+			bitmap.set_pixel(y, x, BitmapImage::BitmapPixel{ red , green, blue });
 		}
 	}
 
 	return bitmap;
 }
 
+void ImageParser::encode_bitmap(const BitmapImage& bitmap, std::vector<char>& buffer) {
+	const auto height = bitmap.get_height();
+	const auto width = bitmap.get_width();
+	const auto row_size = get_bitmap_row_size(width);
+	const auto image_size = std::uint32_t{ row_size * height };
+
+	buffer.resize(bitmap_header_size + image_size);
+
+	// file header
+	put_value(buffer, 0, std::uint16_t{ 19778 });
+	put_value(buffer, 2, std::uint32_t{ bitmap_header_size + image_size });
+	put_value(buffer, 6, std::uint32_t{ 0 });
+	put_value(buffer, 10, std::uint32_t{ bitmap_header_size });
+
+	// info header
+	put_value(buffer, 14, std::uint32_t{ 40 });
+	put_value(buffer, 18, static_cast<std::int32_t>(width));
+	put_value(buffer, 22, static_cast<std::int32_t>(height));
+	put_value(buffer, 26, std::uint16_t{ 1 });
+	put_value(buffer, 28, std::uint16_t{ 24 });
+	put_value(buffer, 30, std::uint32_t{ 0 });
+	put_value(buffer, 34, image_size);
+	put_value(buffer, 38, std::int32_t{ 0 });
+	put_value(buffer, 42, std::int32_t{ 0 });
+	put_value(buffer, 46, std::uint32_t{ 0 });
+	put_value(buffer, 50, std::uint32_t{ 0 });
+
+	const auto num_rows = static_cast<std::int64_t>(height);
+#pragma omp parallel for if(image_size >= (1 << 20))
+	for (std::int64_t y = 0; y < num_rows; y++) {
+		char* row = buffer.data() + bitmap_header_size + y * row_size;
+		const auto* pixels = bitmap.get_row(static_cast<std::uint32_t>(y));
+		for (auto x = std::uint32_t(0); x < width; x++) {
+			row[3 * x] = static_cast<char>(pixels[x].get_blue_channel());
+			row[3 * x + 1] = static_cast<char>(pixels[x].get_green_channel());
+			row[3 * x + 2] = static_cast<char>(pixels[x].get_red_channel());
+		}
+		std::memset(row + 3 * width, 0, row_size - 3 * width);
+	}
+}
+
 void ImageParser::write_bitmap(const std::filesystem::path& file_path, const BitmapImage& bitmap) {
+	// the encode buffer keeps its capacity, writing frames of the same size does not allocate
+	thread_local auto buffer = std::vector<char>{};
+	encode_bitmap(bitmap, buffer);
+
 	auto file_writer = std::ofstream{ file_path , std::ios::out | std::ios::binary };
+	file_writer.write(buffer.data(), buffer.size());
+	if (!file_writer) {
+		throw std::exception{};
+	}
+}
+
+ImageFormat get_image_format(std::uint32_t format_id) {
+	switch (format_id) {
+		case 0:
+			return ImageFormat::bmp;
+		case 1:
+			return ImageFormat::png;
+		case 2:
+			return ImageFormat::qoi;
+		default:
+			throw std::invalid_argument("unknown image format: " + std::to_string(format_id));
+	}
+}
+
+const char* ImageParser::get_file_extension(ImageFormat format) {
+	switch (format) {
+		case ImageFormat::png:
+			return ".png";
+		case ImageFormat::qoi:
+			return ".qoi";
+		default:
+			return ".bmp";
+	}
+}
+
+void ImageParser::write_image(const std::filesystem::path& file_path, const BitmapImage& bitmap, ImageFormat format) {
+	thread_local auto buffer = std::vector<char>{};
+	switch (format) {
+		case ImageFormat::bmp:
+			encode_bitmap(bitmap, buffer);
+			break;
+		case ImageFormat::png:
+			encode_png(bitmap, buffer);
+			break;
+		case ImageFormat::qoi:
+			encode_qoi(bitmap, buffer);
+			break;
+	}
+
+	auto file_writer = std::ofstream{ file_path , std::ios::out | std::ios::binary };
+	file_writer.write(buffer.data(), buffer.size());
+	if (!file_writer) {
+		throw std::exception{};
+	}
+}
+
+static void put_big_endian(std::vector<char>& buffer, std::uint32_t value) {
+	buffer.push_back(static_cast<char>(value >> 24));
+	buffer.push_back(static_cast<char>(value >> 16));
+	buffer.push_back(static_cast<char>(value >> 8));
+	buffer.push_back(static_cast<char>(value));
+}
+
+static std::uint32_t get_big_endian(const char* data) {
+	const auto* bytes = reinterpret_cast<const std::uint8_t*>(data);
+	return (std::uint32_t{ bytes[0] } << 24) | (std::uint32_t{ bytes[1] } << 16) | (std::uint32_t{ bytes[2] } << 8) | bytes[3];
+}
+
+static void put_png_chunk(std::vector<char>& buffer, const char* type, const std::uint8_t* data, std::size_t size) {
+	put_big_endian(buffer, static_cast<std::uint32_t>(size));
+	buffer.insert(buffer.end(), type, type + 4);
+	buffer.insert(buffer.end(), data, data + size);
+	std::uint32_t crc = Deflate::get_crc32(reinterpret_cast<const std::uint8_t*>(type), 4);
+	crc = Deflate::get_crc32(data, size, crc);
+	put_big_endian(buffer, crc);
+}
+
+static std::uint8_t get_paeth_predictor(int left, int up, int up_left) {
+	const int estimate = left + up - up_left;
+	const int distance_left = std::abs(estimate - left);
+	const int distance_up = std::abs(estimate - up);
+	const int distance_up_left = std::abs(estimate - up_left);
+	if (distance_left <= distance_up && distance_left <= distance_up_left) {
+		return static_cast<std::uint8_t>(left);
+	}
+	return static_cast<std::uint8_t>(distance_up <= distance_up_left ? up : up_left);
+}
+
+void ImageParser::encode_png(const BitmapImage& bitmap, std::vector<char>& buffer) {
+	const auto height = bitmap.get_height();
+	const auto width = bitmap.get_width();
+	const std::size_t row_size = 3 * static_cast<std::size_t>(width);
+	// every row starts with its filter type
+	const std::size_t filtered_row_size = row_size + 1;
+
+	// rows top to bottom, row 0 of the bitmap is the bottom row
+	thread_local auto raw = std::vector<std::uint8_t>{};
+	thread_local auto filtered = std::vector<std::uint8_t>{};
+	raw.resize(row_size * height);
+	filtered.resize(filtered_row_size * height);
+
+	const auto num_rows = static_cast<std::int64_t>(height);
+#pragma omp parallel for
+	for (std::int64_t y = 0; y < num_rows; y++) {
+		const auto* pixels = bitmap.get_row(static_cast<std::uint32_t>(num_rows - 1 - y));
+		std::uint8_t* row = raw.data() + y * row_size;
+		for (auto x = std::uint32_t(0); x < width; x++) {
+			row[3 * x] = pixels[x].get_red_channel();
+			row[3 * x + 1] = pixels[x].get_green_channel();
+			row[3 * x + 2] = pixels[x].get_blue_channel();
+		}
+	}
+
+	// per row the filter with the smallest sum of absolute differences, the usual heuristic
+#pragma omp parallel for
+	for (std::int64_t y = 0; y < num_rows; y++) {
+		const std::uint8_t* row = raw.data() + y * row_size;
+		const std::uint8_t* previous_row = y > 0 ? row - row_size : nullptr;
+		std::uint8_t* output = filtered.data() + y * filtered_row_size;
+
+		std::array<std::uint64_t, 5> costs{};
+		for (std::size_t i = 0; i < row_size; i++) {
+			const int left = i >= 3 ? row[i - 3] : 0;
+			const int up = previous_row != nullptr ? previous_row[i] : 0;
+			const int up_left = previous_row != nullptr && i >= 3 ? previous_row[i - 3] : 0;
+			const std::array<std::uint8_t, 5> residuals = {
+				row[i],
+				static_cast<std::uint8_t>(row[i] - left),
+				static_cast<std::uint8_t>(row[i] - up),
+				static_cast<std::uint8_t>(row[i] - (left + up) / 2),
+				static_cast<std::uint8_t>(row[i] - get_paeth_predictor(left, up, up_left))
+			};
+			for (std::size_t filter = 0; filter < residuals.size(); filter++) {
+				costs[filter] += std::abs(static_cast<std::int8_t>(residuals[filter]));
+			}
+		}
+		const auto filter = static_cast<std::uint8_t>(std::min_element(costs.begin(), costs.end()) - costs.begin());
+
+		output[0] = filter;
+		for (std::size_t i = 0; i < row_size; i++) {
+			const int left = i >= 3 ? row[i - 3] : 0;
+			const int up = previous_row != nullptr ? previous_row[i] : 0;
+			const int up_left = previous_row != nullptr && i >= 3 ? previous_row[i - 3] : 0;
+			int prediction = 0;
+			switch (filter) {
+				case 1:
+					prediction = left;
+					break;
+				case 2:
+					prediction = up;
+					break;
+				case 3:
+					prediction = (left + up) / 2;
+					break;
+				case 4:
+					prediction = get_paeth_predictor(left, up, up_left);
+					break;
+				default:
+					break;
+			}
+			output[1 + i] = static_cast<std::uint8_t>(row[i] - prediction);
+		}
+	}
+
+	// bands of rows are deflated independently and concatenated into one zlib stream
+	constexpr std::size_t rows_per_band = 32;
+	const std::int64_t num_bands = (height + rows_per_band - 1) / rows_per_band;
+	thread_local auto bands = std::vector<std::vector<std::uint8_t>>{};
+	bands.resize(num_bands);
+#pragma omp parallel for schedule(dynamic)
+	for (std::int64_t band = 0; band < num_bands; band++) {
+		const std::size_t first_row = band * rows_per_band;
+		const std::size_t last_row = std::min<std::size_t>(first_row + rows_per_band, height);
+		bands[band].clear();
+		Deflate::compress_segment(filtered.data() + first_row * filtered_row_size, (last_row - first_row) * filtered_row_size, bands[band]);
+	}
 
-	const auto write_to_file = [&file_writer](const auto value) {
-		file_writer.write(reinterpret_cast<const char*>(&value), sizeof(value));
-		};
-
-	auto bfType = std::uint16_t{ 19778 };
-	auto bfSize = std::uint32_t{ 3 * bitmap.get_height() * bitmap.get_width() };
-	auto bfReserved = std::uint32_t{ 0 };
-	auto bfOffBits = std::uint32_t{ 54 };
-
-	write_to_file(bfType);
-	write_to_file(bfSize);
-	write_to_file(bfReserved);
-	write_to_file(bfOffBits);
-
-	auto biSize = std::uint32_t{ 40 };
-	auto biWidth = std::int32_t{ static_cast<std::int32_t>(bitmap.get_width()) };
-	auto biHeight = std::int32_t{ static_cast<std::int32_t>(bitmap.get_height()) };
-	auto biPlanes = std::uint16_t{ 1 };
-	auto biBitCount = std::uint16_t{ 24 };
-	auto biCompression = std::uint32_t{ 0 };
-	auto biSizeImage = std::uint32_t{ 3 * bitmap.get_height() * bitmap.get_width() };
-	auto biXPelsPerMeter = std::int32_t{ 0 };
-	auto biYPelsPerMeter = std::int32_t{ 0 };
-	auto biClrUsed = std::uint32_t{ 0 };
-	auto biClrImportant = std::uint32_t{ 0 };
-
-	write_to_file(biSize);
-	write_to_file(biWidth);
-	write_to_file(biHeight);
-	write_to_file(biPlanes);
-	write_to_file(biBitCount);
-	write_to_file(biCompression);
-	write_to_file(biSizeImage);
-	write_to_file(biXPelsPerMeter);
-	write_to_file(biYPelsPerMeter);
-	write_to_file(biClrUsed);
-	write_to_file(biClrImportant);
-
-	for (auto y = std::uint32_t(0); y < bitmap.get_height(); y++) {
-		for (auto x = std::uint32_t(0); x < bitmap.get_width(); x++) {
-			const auto pixel = bitmap.get_pixel(y, x);
-
-			const auto red = pixel.get_red_channel();
-			const auto green = pixel.get_green_channel();
-			const auto blue = pixel.get_blue_channel();
-
-			write_to_file(blue);
-			write_to_file(green);
-			write_to_file(red);
+	thread_local auto image_data = std::vector<std::uint8_t>{};
+	image_data.clear();
+	// zlib header: deflate with 32k window, no dictionary
+	image_data.push_back(0x78);
+	image_data.push_back(0x01);
+	for (const auto& band : bands) {
+		image_data.insert(image_data.end(), band.begin(), band.end());
+	}
+	Deflate::finish_stream(image_data);
+	const std::uint32_t adler = Deflate::get_adler32(filtered.data(), filtered.size());
+	for (int shift = 24; shift >= 0; shift -= 8) {
+		image_data.push_back(static_cast<std::uint8_t>(adler >> shift));
+	}
+
+	buffer.clear();
+	const char signature[8] = { '\x89', 'P', 'N', 'G', '\r', '\n', '\x1a', '\n' };
+	buffer.insert(buffer.end(), signature, signature + 8);
+
+	// 8 bit truecolor, no interlacing
+	std::vector<char> header;
+	put_big_endian(header, width);
+	put_big_endian(header, height);
+	const char header_tail[5] = { 8, 2, 0, 0, 0 };
+	header.insert(header.end(), header_tail, header_tail + 5);
+	put_png_chunk(buffer, "IHDR", reinterpret_cast<const std::uint8_t*>(header.data()), header.size());
+	put_png_chunk(buffer, "IDAT", image_data.data(), image_data.size());
+	put_png_chunk(buffer, "IEND", nullptr, 0);
+}
+
+// operations of the QOI format, https://qoiformat.org/qoi-specification.pdf
+static constexpr std::uint8_t qoi_op_index = 0x00;
+static constexpr std::uint8_t qoi_op_diff = 0x40;
+static constexpr std::uint8_t qoi_op_luma = 0x80;
+static constexpr std::uint8_t qoi_op_run = 0xc0;
+static constexpr std::uint8_t qoi_op_rgb = 0xfe;
+static constexpr std::uint8_t qoi_mask = 0xc0;
+static constexpr std::uint32_t qoi_header_size = 14;
+static constexpr std::array<std::uint8_t, 8> qoi_end_marker = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+static std::size_t get_qoi_index(std::uint8_t red, std::uint8_t green, std::uint8_t blue) {
+	// alpha is always 255
+	return (red * 3 + green * 5 + blue * 7 + 255 * 11) % 64;
+}
+
+void ImageParser::encode_qoi(const BitmapImage& bitmap, std::vector<char>& buffer) {
+	const auto height = bitmap.get_height();
+	const auto width = bitmap.get_width();
+
+	buffer.clear();
+	buffer.reserve(qoi_header_size + static_cast<std::size_t>(width) * height * 4 + qoi_end_marker.size());
+	const char magic[4] = { 'q', 'o', 'i', 'f' };
+	buffer.insert(buffer.end(), magic, magic + 4);
+	put_big_endian(buffer, width);
+	put_big_endian(buffer, height);
+	// 3 channels, sRGB
+	buffer.push_back(3);
+	buffer.push_back(0);
+
+	// decoders start with an index of transparent black, which never matches an opaque pixel
+	std::array<BitmapImage::BitmapPixel, 64> seen{};
+	std::array<bool, 64> seen_valid{};
+	auto previous = BitmapImage::BitmapPixel{ 0, 0, 0 };
+	std::uint32_t run = 0;
+	for (auto y = std::uint32_t(0); y < height; y++) {
+		// top row first, row 0 of the bitmap is the bottom row
+		const auto* pixels = bitmap.get_row(height - 1 - y);
+		for (auto x = std::uint32_t(0); x < width; x++) {
+			const auto pixel = pixels[x];
+			if (pixel == previous) {
+				run++;
+				if (run == 62) {
+					buffer.push_back(static_cast<char>(qoi_op_run | (run - 1)));
+					run = 0;
+				}
+				continue;
+			}
+			if (run > 0) {
+				buffer.push_back(static_cast<char>(qoi_op_run | (run - 1)));
+				run = 0;
+			}
+
+			const std::uint8_t red = pixel.get_red_channel();
+			const std::uint8_t green = pixel.get_green_channel();
+			const std::uint8_t blue = pixel.get_blue_channel();
+			const std::size_t index = get_qoi_index(red, green, blue);
+			if (seen_valid[index] && seen[index] == pixel) {
+				buffer.push_back(static_cast<char>(qoi_op_index | index));
+			} else {
+				seen[index] = pixel;
+				seen_valid[index] = true;
+				const auto red_difference = static_cast<std::int8_t>(red - previous.get_red_channel());
+				const auto green_difference = static_cast<std::int8_t>(green - previous.get_green_channel());
+				const auto blue_difference = static_cast<std::int8_t>(blue - previous.get_blue_channel());
+				const int red_green = red_difference - green_difference;
+				const int blue_green = blue_difference - green_difference;
+
+				if (red_difference >= -2 && red_difference <= 1 && green_difference >= -2 && green_difference <= 1 && blue_difference >= -2 && blue_difference <= 1) {
+					buffer.push_back(static_cast<char>(qoi_op_diff | ((red_difference + 2) << 4) | ((green_difference + 2) << 2) | (blue_difference + 2)));
+				} else if (green_difference >= -32 && green_difference <= 31 && red_green >= -8 && red_green <= 7 && blue_green >= -8 && blue_green <= 7) {
+					buffer.push_back(static_cast<char>(qoi_op_luma | (green_difference + 32)));
+					buffer.push_back(static_cast<char>(((red_green + 8) << 4) | (blue_green + 8)));
+				} else {
+					buffer.push_back(static_cast<char>(qoi_op_rgb));
+					buffer.push_back(static_cast<char>(red));
+					buffer.push_back(static_cast<char>(green));
+					buffer.push_back(static_cast<char>(blue));
+				}
+			}
+			previous = pixel;
 		}
 	}
+	if (run > 0) {
+		buffer.push_back(static_cast<char>(qoi_op_run | (run - 1)));
+	}
+	buffer.insert(buffer.end(), qoi_end_marker.begin(), qoi_end_marker.end());
+}
+
+BitmapImage ImageParser::decode_qoi(const char* data, std::size_t size) {
+	if (size < qoi_header_size + qoi_end_marker.size() || std::memcmp(data, "qoif", 4) != 0) {
+		throw std::exception{};
+	}
+	const auto width = get_big_endian(data + 4);
+	const auto height = get_big_endian(data + 8);
+	auto bitmap = BitmapImage{ height, width };
+
+	const auto* bytes = reinterpret_cast<const std::uint8_t*>(data);
+	const std::size_t end = size - qoi_end_marker.size();
+	std::size_t position = qoi_header_size;
+	std::array<BitmapImage::BitmapPixel, 64> seen{};
+	auto pixel = BitmapImage::BitmapPixel{ 0, 0, 0 };
+	std::uint32_t run = 0;
+	for (auto y = std::uint32_t(0); y < height; y++) {
+		for (auto x = std::uint32_t(0); x < width; x++) {
+			if (run > 0) {
+				run--;
+			} else {
+				if (position >= end) {
+					throw std::exception{};
+				}
+				const std::uint8_t op = bytes[position++];
+				std::uint8_t red = pixel.get_red_channel();
+				std::uint8_t green = pixel.get_green_channel();
+				std::uint8_t blue = pixel.get_blue_channel();
+				if (op == qoi_op_rgb) {
+					if (position + 3 > end) {
+						throw std::exception{};
+					}
+					red = bytes[position];
+					green = bytes[position + 1];
+					blue = bytes[position + 2];
+					position += 3;
+				} else if ((op & qoi_mask) == qoi_op_index) {
+					red = seen[op].get_red_channel();
+					green = seen[op].get_green_channel();
+					blue = seen[op].get_blue_channel();
+				} else if ((op & qoi_mask) == qoi_op_diff) {
+					red += ((op >> 4) & 3) - 2;
+					green += ((op >> 2) & 3) - 2;
+					blue += (op & 3) - 2;
+				} else if ((op & qoi_mask) == qoi_op_luma) {
+					if (position >= end) {
+						throw std::exception{};
+					}
+					const int green_difference = (op & 0x3f) - 32;
+					const std::uint8_t second = bytes[position++];
+					red += green_difference + ((second >> 4) & 0x0f) - 8;
+					green += green_difference;
+					blue += green_difference + (second & 0x0f) - 8;
+				} else if (op != 0xff) {
+					run = op & 0x3f;
+				} else {
+					// rgba is never written for 3 channels
+					throw std::exception{};
+				}
+				pixel = BitmapImage::BitmapPixel{ red, green, blue };
+				seen[get_qoi_index(red, green, blue)] = pixel;
+			}
+			bitmap.set_pixel(height - 1 - y, x, pixel);
+		}
+	}
+
+	return bitmap;
 }
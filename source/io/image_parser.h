@@ -2,11 +2,44 @@
 
 #include "image/bitmap_image.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <vector>
+
+// file formats of written images
+enum class ImageFormat : std::uint8_t {
+	bmp,
+	png,
+	qoi
+};
+
+[[nodiscard]] ImageFormat get_image_format(std::uint32_t format_id);
 
 class ImageParser {
 public:
+	// 24 bit uncompressed BMP, rows are padded to a multiple of 4 bytes
+	static constexpr std::uint32_t bitmap_header_size = 54;
+
 	[[nodiscard]] static BitmapImage read_bitmap(const std::filesystem::path& file_path);
 
 	static void write_bitmap(const std::filesystem::path& file_path, const BitmapImage& bitmap);
+
+	// encodes header and pixels into one buffer, the buffer is reused between frames
+	static void encode_bitmap(const BitmapImage& bitmap, std::vector<char>& buffer);
+	[[nodiscard]] static BitmapImage decode_bitmap(const char* data, std::size_t size);
+
+	// lossless PNG, bands of rows are filtered and deflated in parallel
+	static void encode_png(const BitmapImage& bitmap, std::vector<char>& buffer);
+	// lossless QOI, encoded sequentially but an order of magnitude faster than PNG
+	static void encode_qoi(const BitmapImage& bitmap, std::vector<char>& buffer);
+	[[nodiscard]] static BitmapImage decode_qoi(const char* data, std::size_t size);
+
+	// encodes in the format and writes the file with one call
+	static void write_image(const std::filesystem::path& file_path, const BitmapImage& bitmap, ImageFormat format);
+	[[nodiscard]] static const char* get_file_extension(ImageFormat format);
+
+	[[nodiscard]] static std::uint32_t get_bitmap_row_size(std::uint32_t width) {
+		return (3 * width + 3) / 4 * 4;
+	}
 };
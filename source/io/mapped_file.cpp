@@ -0,0 +1,94 @@
+#include "io/mapped_file.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_USE_MMAP
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& file_path) {
+	if (!std::filesystem::is_regular_file(file_path)) {
+		throw std::invalid_argument("Could not open " + file_path.string());
+	}
+
+#ifdef MAPPED_FILE_USE_MMAP
+	int file_descriptor = open(file_path.c_str(), O_RDONLY);
+	if (file_descriptor < 0) {
+		throw std::invalid_argument("Could not open " + file_path.string());
+	}
+	struct stat file_stat {};
+	if (fstat(file_descriptor, &file_stat) != 0) {
+		close(file_descriptor);
+		throw std::invalid_argument("Could not stat " + file_path.string());
+	}
+	size = file_stat.st_size;
+	if (size > 0) {
+		void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+		if (mapping == MAP_FAILED) {
+			close(file_descriptor);
+			throw std::runtime_error("Could not map " + file_path.string());
+		}
+		data = static_cast<const std::byte*>(mapping);
+		mapped = true;
+	}
+	// the mapping stays valid after closing the descriptor
+	close(file_descriptor);
+#else
+	auto file_reader = std::ifstream{ file_path, std::ios::binary | std::ios::in };
+	size = std::filesystem::file_size(file_path);
+	buffer.resize(size);
+	if (!file_reader.read(reinterpret_cast<char*>(buffer.data()), size)) {
+		throw std::runtime_error("Could not read " + file_path.string());
+	}
+	data = buffer.data();
+#endif
+}
+
+MappedFile::~MappedFile() {
+	release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		release();
+		data = std::exchange(other.data, nullptr);
+		size = std::exchange(other.size, 0);
+		mapped = std::exchange(other.mapped, false);
+		buffer = std::move(other.buffer);
+		if (!mapped && size > 0) {
+			data = buffer.data();
+		}
+	}
+	return *this;
+}
+
+void MappedFile::advise_sequential() const {
+#ifdef MAPPED_FILE_USE_MMAP
+	if (mapped) {
+		madvise(const_cast<std::byte*>(data), size, MADV_SEQUENTIAL);
+		madvise(const_cast<std::byte*>(data), size, MADV_WILLNEED);
+	}
+#endif
+}
+
+void MappedFile::release() {
+#ifdef MAPPED_FILE_USE_MMAP
+	if (mapped) {
+		munmap(const_cast<std::byte*>(data), size);
+	}
+#endif
+	data = nullptr;
+	size = 0;
+	mapped = false;
+	buffer.clear();
+}
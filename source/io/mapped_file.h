@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+// Read-only view of a whole file. On POSIX systems the file is mapped with mmap, so only the pages
+// that are accessed are read from disk. Elsewhere the file is read into memory.
+class MappedFile {
+public:
+	explicit MappedFile(const std::filesystem::path& file_path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	[[nodiscard]] const std::byte* get_data() const {
+		return data;
+	}
+
+	[[nodiscard]] std::size_t get_size() const {
+		return size;
+	}
+
+	// hint that the whole file is read front to back
+	void advise_sequential() const;
+
+private:
+	void release();
+
+	const std::byte* data = nullptr;
+	std::size_t size = 0;
+	bool mapped = false;
+	std::vector<std::byte> buffer;
+};
@@ -0,0 +1,343 @@
+#include "io/trajectory_file.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+static constexpr char trajectory_magic[8] = {'N', 'B', 'O', 'D', 'Y', 'T', 'R', 'J'};
+static constexpr char index_magic[8] = {'N', 'B', 'T', 'R', 'J', 'I', 'D', 'X'};
+static constexpr std::uint32_t host_byte_order = 0x01020304;
+
+static std::size_t get_num_arrays(std::uint32_t flags) {
+	return (flags & TrajectoryFile::flag_velocities) != 0 ? 4 : 2;
+}
+
+static std::size_t get_word_size(std::uint32_t flags) {
+	return (flags & TrajectoryFile::flag_single_precision) != 0 ? sizeof(float) : sizeof(double);
+}
+
+// longest zero run a single length byte encodes
+static constexpr std::size_t max_zero_run = 255;
+
+// a zero byte is followed by the length of the zero run, all other bytes are stored as they are
+static void encode_zero_runs(const std::vector<std::uint8_t>& bytes, std::vector<std::uint8_t>& encoded) {
+	encoded.clear();
+	const std::size_t num_bytes = bytes.size();
+	for (std::size_t i = 0; i < num_bytes;) {
+		if (bytes[i] != 0) {
+			encoded.push_back(bytes[i]);
+			i++;
+			continue;
+		}
+		std::size_t run = 1;
+		while (i + run < num_bytes && run < max_zero_run && bytes[i + run] == 0) {
+			run++;
+		}
+		encoded.push_back(0);
+		encoded.push_back(static_cast<std::uint8_t>(run));
+		i += run;
+	}
+}
+
+static void decode_zero_runs(const std::uint8_t* encoded, std::size_t encoded_size, std::vector<std::uint8_t>& bytes) {
+	std::size_t num_decoded = 0;
+	for (std::size_t i = 0; i < encoded_size; i++) {
+		if (encoded[i] != 0) {
+			if (num_decoded == bytes.size()) {
+				throw std::invalid_argument("Trajectory frame is corrupt");
+			}
+			bytes[num_decoded++] = encoded[i];
+			continue;
+		}
+		if (i + 1 == encoded_size || encoded[i + 1] > bytes.size() - num_decoded) {
+			throw std::invalid_argument("Trajectory frame is corrupt");
+		}
+		std::fill_n(bytes.begin() + num_decoded, encoded[i + 1], 0);
+		num_decoded += encoded[i + 1];
+		i++;
+	}
+	if (num_decoded != bytes.size()) {
+		throw std::invalid_argument("Trajectory frame is corrupt");
+	}
+}
+
+// value bits of one component of a body, floats use the lower 32 bits
+static std::uint64_t get_value_bits(double value, bool single_precision) {
+	if (single_precision) {
+		return std::bit_cast<std::uint32_t>(static_cast<float>(value));
+	}
+	return std::bit_cast<std::uint64_t>(value);
+}
+
+static double get_value(std::uint64_t bits, bool single_precision) {
+	if (single_precision) {
+		return std::bit_cast<float>(static_cast<std::uint32_t>(bits));
+	}
+	return std::bit_cast<double>(bits);
+}
+
+TrajectoryWriter::TrajectoryWriter(const std::filesystem::path& file_path, TrajectoryOptions arg_options) : path(file_path), options(arg_options) {
+	if (options.every == 0 || options.frames_per_chunk == 0) {
+		throw std::invalid_argument("trajectory interval and chunk size must be at least one");
+	}
+	file_writer.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!file_writer.is_open()) {
+		throw std::invalid_argument("Could not open trajectory file " + path.string());
+	}
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+	// errors cannot be reported from the destructor, call close() to see them
+	try {
+		close();
+	} catch (...) {
+	}
+}
+
+void TrajectoryWriter::on_epoch_end(Universe& universe, SimulationContext&) {
+	if (universe.current_simulation_epoch % options.every == 0) {
+		append(universe);
+	}
+}
+
+void TrajectoryWriter::write_header(std::uint64_t arg_num_bodies) {
+	num_bodies = arg_num_bodies;
+	TrajectoryFile::Header header{};
+	std::memcpy(header.magic, trajectory_magic, sizeof(trajectory_magic));
+	header.version = TrajectoryFile::version;
+	header.byte_order = host_byte_order;
+	header.num_bodies = num_bodies;
+	header.flags = (options.velocities ? TrajectoryFile::flag_velocities : 0) | (options.single_precision ? TrajectoryFile::flag_single_precision : 0);
+	header.frames_per_chunk = options.frames_per_chunk;
+	file_writer.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	offset = sizeof(header);
+	header_written = true;
+}
+
+void TrajectoryWriter::append(Universe& universe) {
+	if (closed) {
+		throw std::invalid_argument("Trajectory file is already closed: " + path.string());
+	}
+	if (!header_written) {
+		write_header(universe.num_bodies);
+	}
+	if (!index.empty() && universe.current_simulation_epoch <= index.back().epoch) {
+		throw std::invalid_argument("Trajectory epochs have to increase");
+	}
+
+	const std::uint32_t flags = (options.velocities ? TrajectoryFile::flag_velocities : 0) | (options.single_precision ? TrajectoryFile::flag_single_precision : 0);
+	const std::size_t num_arrays = get_num_arrays(flags);
+	const std::size_t word_size = get_word_size(flags);
+	// differences need the same bodies in both frames
+	const bool key_frame = index.empty() || chunk_frames == options.frames_per_chunk || universe.num_bodies != num_bodies;
+	num_bodies = universe.num_bodies;
+	chunk_frames = key_frame ? 1 : chunk_frames + 1;
+
+	TrajectoryFile::FrameHeader frame_header{};
+	frame_header.epoch = universe.current_simulation_epoch;
+	frame_header.num_bodies = num_bodies;
+	const std::int64_t num_values = num_bodies;
+	for (std::size_t array = 0; array < num_arrays; array++) {
+		auto& previous = previous_bits[array];
+		if (key_frame) {
+			// key frames are differences to zero, i.e. the plain values
+			previous.assign(num_bodies, 0);
+		}
+		auto& vectors = array < 2 ? universe.positions : universe.velocities;
+		const std::int32_t component = array % 2;
+
+		shuffled.resize(num_bodies * word_size);
+#pragma omp parallel for
+		for (std::int64_t i = 0; i < num_values; i++) {
+			const std::uint64_t bits = get_value_bits(vectors[i][component], options.single_precision);
+			const std::uint64_t delta = bits ^ previous[i];
+			previous[i] = bits;
+			for (std::size_t byte = 0; byte < word_size; byte++) {
+				shuffled[byte * num_values + i] = static_cast<std::uint8_t>(delta >> (8 * byte));
+			}
+		}
+		encode_zero_runs(shuffled, encoded[array]);
+		frame_header.encoded_sizes[array] = encoded[array].size();
+	}
+
+	TrajectoryFile::IndexEntry entry{};
+	entry.epoch = universe.current_simulation_epoch;
+	entry.frame_offset = offset;
+	entry.key_frame = key_frame ? index.size() : index.back().key_frame;
+	index.push_back(entry);
+
+	file_writer.write(reinterpret_cast<const char*>(&frame_header), sizeof(frame_header));
+	offset += sizeof(frame_header);
+	for (std::size_t array = 0; array < num_arrays; array++) {
+		file_writer.write(reinterpret_cast<const char*>(encoded[array].data()), encoded[array].size());
+		offset += encoded[array].size();
+	}
+	if (!file_writer) {
+		throw std::runtime_error("Could not write trajectory file " + path.string());
+	}
+}
+
+void TrajectoryWriter::close() {
+	if (closed) {
+		return;
+	}
+	closed = true;
+	if (!header_written) {
+		write_header(0);
+	}
+
+	TrajectoryFile::Trailer trailer{};
+	trailer.index_offset = offset;
+	trailer.num_frames = index.size();
+	std::memcpy(trailer.magic, index_magic, sizeof(index_magic));
+	file_writer.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(TrajectoryFile::IndexEntry));
+	file_writer.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+	file_writer.close();
+	if (!file_writer) {
+		throw std::runtime_error("Could not write trajectory file " + path.string());
+	}
+}
+
+TrajectoryReader::TrajectoryReader(const std::filesystem::path& file_path) : file(file_path) {
+	const std::size_t file_size = file.get_size();
+	if (file_size < sizeof(TrajectoryFile::Header) + sizeof(TrajectoryFile::Trailer)) {
+		throw std::invalid_argument("Not a trajectory file, file too small: " + file_path.string());
+	}
+	std::memcpy(&header, file.get_data(), sizeof(header));
+	if (std::memcmp(header.magic, trajectory_magic, sizeof(trajectory_magic)) != 0) {
+		throw std::invalid_argument("Not a trajectory file: " + file_path.string());
+	}
+	if (header.byte_order != host_byte_order) {
+		throw std::invalid_argument("Trajectory file was written with a different byte order: " + file_path.string());
+	}
+	if (header.version != TrajectoryFile::version) {
+		throw std::invalid_argument("Unsupported trajectory file version " + std::to_string(header.version) + ": " + file_path.string());
+	}
+
+	TrajectoryFile::Trailer trailer;
+	std::memcpy(&trailer, file.get_data() + file_size - sizeof(trailer), sizeof(trailer));
+	if (std::memcmp(trailer.magic, index_magic, sizeof(index_magic)) != 0) {
+		throw std::invalid_argument("Trajectory file has no index, it was not closed: " + file_path.string());
+	}
+	const std::uint64_t index_end = file_size - sizeof(trailer);
+	if (trailer.index_offset < sizeof(header) || trailer.index_offset > index_end || trailer.num_frames != (index_end - trailer.index_offset) / sizeof(TrajectoryFile::IndexEntry)) {
+		throw std::invalid_argument("Trajectory file is truncated or corrupt: " + file_path.string());
+	}
+
+	index.resize(trailer.num_frames);
+	std::memcpy(index.data(), file.get_data() + trailer.index_offset, index.size() * sizeof(TrajectoryFile::IndexEntry));
+	for (std::uint64_t frame = 0; frame < index.size(); frame++) {
+		const auto& entry = index[frame];
+		if (entry.key_frame > frame || entry.frame_offset < sizeof(header) || entry.frame_offset + sizeof(TrajectoryFile::FrameHeader) > trailer.index_offset || (frame > 0 && entry.epoch <= index[frame - 1].epoch)) {
+			throw std::invalid_argument("Trajectory file is truncated or corrupt: " + file_path.string());
+		}
+	}
+}
+
+std::uint64_t TrajectoryReader::get_epoch(std::uint64_t frame) const {
+	if (frame >= index.size()) {
+		throw std::invalid_argument("Trajectory frame out of range: " + std::to_string(frame));
+	}
+	return index[frame].epoch;
+}
+
+TrajectoryFile::FrameHeader TrajectoryReader::read_frame_header(std::uint64_t frame) const {
+	if (frame >= index.size()) {
+		throw std::invalid_argument("Trajectory frame out of range: " + std::to_string(frame));
+	}
+	TrajectoryFile::FrameHeader frame_header;
+	std::memcpy(&frame_header, file.get_data() + index[frame].frame_offset, sizeof(frame_header));
+	return frame_header;
+}
+
+std::uint64_t TrajectoryReader::get_num_bodies(std::uint64_t frame) const {
+	return read_frame_header(frame).num_bodies;
+}
+
+std::uint64_t TrajectoryReader::find_frame(std::uint64_t epoch) const {
+	auto entry = std::lower_bound(index.begin(), index.end(), epoch, [](const TrajectoryFile::IndexEntry& indexed_frame, std::uint64_t value) { return indexed_frame.epoch < value; });
+	if (entry == index.end() || entry->epoch != epoch) {
+		throw std::invalid_argument("Epoch " + std::to_string(epoch) + " is not part of the trajectory");
+	}
+	return entry - index.begin();
+}
+
+void TrajectoryReader::read_frame(std::uint64_t frame, Vector2d<double>* positions, Vector2d<double>* velocities) const {
+	if (frame >= index.size()) {
+		throw std::invalid_argument("Trajectory frame out of range: " + std::to_string(frame));
+	}
+	const std::size_t num_arrays = velocities != nullptr ? 4 : 2;
+	if (num_arrays > get_num_arrays(header.flags)) {
+		throw std::invalid_argument("Trajectory file holds no velocities");
+	}
+	const bool single_precision = is_single_precision();
+	const std::size_t word_size = get_word_size(header.flags);
+	const TrajectoryFile::FrameHeader requested_header = read_frame_header(frame);
+	const std::uint64_t num_bodies = requested_header.num_bodies;
+	const std::int64_t num_values = num_bodies;
+	const std::uint64_t index_offset = file.get_size() - sizeof(TrajectoryFile::Trailer) - index.size() * sizeof(TrajectoryFile::IndexEntry);
+	// Two encoded bytes expand to at most one zero run, which bounds the buffers before decoding.
+	// The decoder then checks that every array holds exactly one word per body.
+	for (std::size_t array = 0; array < num_arrays; array++) {
+		const std::uint64_t encoded_size = requested_header.encoded_sizes[array];
+		if (encoded_size > index_offset || num_bodies > (encoded_size + 1) / 2 * max_zero_run / word_size) {
+			throw std::invalid_argument("Trajectory file is truncated or corrupt");
+		}
+	}
+
+	std::array<std::vector<std::uint64_t>, TrajectoryFile::max_arrays> bits;
+	for (std::size_t array = 0; array < num_arrays; array++) {
+		bits[array].assign(num_values, 0);
+	}
+	std::vector<std::uint8_t> shuffled(num_values * word_size);
+
+	// apply the differences from the key frame up to the frame
+	for (std::uint64_t delta_frame = index[frame].key_frame; delta_frame <= frame; delta_frame++) {
+		const TrajectoryFile::FrameHeader frame_header = read_frame_header(delta_frame);
+		if (frame_header.num_bodies != num_bodies) {
+			throw std::invalid_argument("Trajectory file is truncated or corrupt");
+		}
+		std::uint64_t offset = index[delta_frame].frame_offset + sizeof(frame_header);
+
+		for (std::size_t array = 0; array < num_arrays; array++) {
+			const std::uint64_t encoded_size = frame_header.encoded_sizes[array];
+			if (encoded_size > index_offset - offset) {
+				throw std::invalid_argument("Trajectory file is truncated or corrupt");
+			}
+			decode_zero_runs(reinterpret_cast<const std::uint8_t*>(file.get_data() + offset), encoded_size, shuffled);
+			offset += encoded_size;
+
+			auto& array_bits = bits[array];
+#pragma omp parallel for
+			for (std::int64_t i = 0; i < num_values; i++) {
+				std::uint64_t delta = 0;
+				for (std::size_t byte = 0; byte < word_size; byte++) {
+					delta |= static_cast<std::uint64_t>(shuffled[byte * num_values + i]) << (8 * byte);
+				}
+				array_bits[i] ^= delta;
+			}
+		}
+	}
+
+#pragma omp parallel for
+	for (std::int64_t i = 0; i < num_values; i++) {
+		positions[i] = Vector2d<double>(get_value(bits[0][i], single_precision), get_value(bits[1][i], single_precision));
+		if (velocities != nullptr) {
+			velocities[i] = Vector2d<double>(get_value(bits[2][i], single_precision), get_value(bits[3][i], single_precision));
+		}
+	}
+}
+
+void TrajectoryReader::read_epoch(std::uint64_t epoch, Universe& universe) const {
+	const std::uint64_t frame = find_frame(epoch);
+	const std::uint64_t num_bodies = get_num_bodies(frame);
+	universe.num_bodies = num_bodies;
+	universe.current_simulation_epoch = epoch;
+	universe.positions.resize(num_bodies);
+	universe.velocities.resize(num_bodies);
+	universe.forces.resize(num_bodies);
+	universe.weights.resize(num_bodies);
+	read_frame(frame, universe.positions.data(), has_velocities() ? universe.velocities.data() : nullptr);
+}
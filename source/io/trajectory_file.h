@@ -0,0 +1,158 @@
+#pragma once
+
+#include "structures/universe.h"
+#include "structures/vector2d.h"
+#include "simulation/simulation_observer.h"
+#include "io/mapped_file.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+// Binary time series of body positions and optionally velocities. Frames are grouped into chunks,
+// the first frame of a chunk is a key frame and every other frame stores the XOR of its value bits
+// with the previous frame. The differences are byte shuffled (all lowest bytes, then all second
+// bytes, ...) and runs of zero bytes are run length encoded, so slowly moving bodies cost little.
+// An index of all frames is appended when the file is closed, a frame is decoded from the key frame
+// of its chunk without reading the rest of the file. Every frame stores its number of bodies, a frame
+// with a different number than its predecessor (e.g. after collisions merged bodies) starts a new chunk.
+class TrajectoryFile {
+public:
+	static constexpr std::uint32_t version = 2;
+	static constexpr const char* file_extension = ".traj";
+
+	enum class TrajectoryArray : std::uint8_t {
+		position_x,
+		position_y,
+		velocity_x,
+		velocity_y
+	};
+	static constexpr std::size_t max_arrays = 4;
+
+	static constexpr std::uint32_t flag_velocities = 1;
+	static constexpr std::uint32_t flag_single_precision = 2;
+
+	struct Header {
+		char magic[8];
+		std::uint32_t version;
+		// 0x01020304 as written by the host, detects files of the other byte order
+		std::uint32_t byte_order;
+		// bodies of the first frame
+		std::uint64_t num_bodies;
+		std::uint32_t flags;
+		std::uint32_t frames_per_chunk;
+	};
+
+	struct FrameHeader {
+		std::uint64_t epoch;
+		std::uint64_t num_bodies;
+		std::array<std::uint64_t, max_arrays> encoded_sizes;
+	};
+
+	struct IndexEntry {
+		std::uint64_t epoch;
+		std::uint64_t frame_offset;
+		// index of the key frame the frame is decoded from
+		std::uint64_t key_frame;
+	};
+
+	struct Trailer {
+		std::uint64_t index_offset;
+		std::uint64_t num_frames;
+		char magic[8];
+	};
+};
+
+struct TrajectoryOptions {
+	// a frame is written every `every` epochs
+	std::uint32_t every = 1;
+	bool velocities = false;
+	// values are rounded to float, halves the file before compression
+	bool single_precision = false;
+	// frames from one key frame to the next, bounds the frames decoded to read a single one
+	std::uint32_t frames_per_chunk = 16;
+};
+
+// Appends frames to a trajectory file. As observer it writes a frame at the end of every
+// options.every-th epoch; the index is written by close() or the destructor.
+class TrajectoryWriter : public SimulationObserver {
+public:
+	TrajectoryWriter(const std::filesystem::path& file_path, TrajectoryOptions arg_options);
+	~TrajectoryWriter() override;
+
+	TrajectoryWriter(const TrajectoryWriter&) = delete;
+	TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+	void on_epoch_end(Universe& universe, SimulationContext&) override;
+
+	// writes the current state as next frame, epochs have to increase from frame to frame. The number of bodies may change
+	void append(Universe& universe);
+	// writes the index, no frames can be appended afterwards
+	void close();
+
+	[[nodiscard]] std::uint64_t get_num_frames() const {
+		return index.size();
+	}
+
+private:
+	void write_header(std::uint64_t num_bodies);
+
+	std::filesystem::path path;
+	TrajectoryOptions options;
+	std::ofstream file_writer;
+	std::uint64_t offset = 0;
+	std::uint64_t num_bodies = 0;
+	// frames since the last key frame
+	std::uint32_t chunk_frames = 0;
+	bool header_written = false;
+	bool closed = false;
+
+	std::vector<TrajectoryFile::IndexEntry> index;
+	// value bits of the previous frame per array
+	std::array<std::vector<std::uint64_t>, TrajectoryFile::max_arrays> previous_bits;
+	std::vector<std::uint8_t> shuffled;
+	std::array<std::vector<std::uint8_t>, TrajectoryFile::max_arrays> encoded;
+};
+
+// Random access to the frames of a closed trajectory file. The file is mapped, reading a frame only
+// touches the frames of its chunk.
+class TrajectoryReader {
+public:
+	explicit TrajectoryReader(const std::filesystem::path& file_path);
+
+	// bodies of the first frame
+	[[nodiscard]] std::uint64_t get_num_bodies() const {
+		return header.num_bodies;
+	}
+	[[nodiscard]] std::uint64_t get_num_bodies(std::uint64_t frame) const;
+
+	[[nodiscard]] std::uint64_t get_num_frames() const {
+		return index.size();
+	}
+
+	[[nodiscard]] bool has_velocities() const {
+		return (header.flags & TrajectoryFile::flag_velocities) != 0;
+	}
+
+	[[nodiscard]] bool is_single_precision() const {
+		return (header.flags & TrajectoryFile::flag_single_precision) != 0;
+	}
+
+	[[nodiscard]] std::uint64_t get_epoch(std::uint64_t frame) const;
+	// frame holding the epoch, throws if the epoch was not written
+	[[nodiscard]] std::uint64_t find_frame(std::uint64_t epoch) const;
+
+	// decodes a frame into arrays of get_num_bodies(frame) values, velocities may be null
+	void read_frame(std::uint64_t frame, Vector2d<double>* positions, Vector2d<double>* velocities) const;
+	// sets positions, velocities if stored, and epoch of the universe, the other body arrays are resized only
+	void read_epoch(std::uint64_t epoch, Universe& universe) const;
+
+private:
+	[[nodiscard]] TrajectoryFile::FrameHeader read_frame_header(std::uint64_t frame) const;
+
+	MappedFile file;
+	TrajectoryFile::Header header;
+	std::vector<TrajectoryFile::IndexEntry> index;
+};
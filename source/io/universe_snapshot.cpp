@@ -0,0 +1,146 @@
+#include "io/universe_snapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static constexpr char snapshot_magic[8] = {'N', 'B', 'O', 'D', 'Y', 'S', 'N', 'P'};
+static constexpr std::uint32_t host_byte_order = 0x01020304;
+
+static std::uint64_t align_offset(std::uint64_t offset) {
+	return (offset + UniverseSnapshot::array_alignment - 1) / UniverseSnapshot::array_alignment * UniverseSnapshot::array_alignment;
+}
+
+// value of body i of a snapshot array
+static double get_component(Universe& universe, UniverseSnapshot::SnapshotArray array, std::int64_t i) {
+	switch (array) {
+		case UniverseSnapshot::SnapshotArray::position_x:
+			return universe.positions[i][0];
+		case UniverseSnapshot::SnapshotArray::position_y:
+			return universe.positions[i][1];
+		case UniverseSnapshot::SnapshotArray::velocity_x:
+			return universe.velocities[i][0];
+		case UniverseSnapshot::SnapshotArray::velocity_y:
+			return universe.velocities[i][1];
+		case UniverseSnapshot::SnapshotArray::force_x:
+			return universe.forces[i][0];
+		case UniverseSnapshot::SnapshotArray::force_y:
+			return universe.forces[i][1];
+		case UniverseSnapshot::SnapshotArray::weight:
+			return universe.weights[i];
+	}
+	return 0;
+}
+
+void UniverseSnapshot::save(const std::filesystem::path& file_path, Universe& universe) {
+	Header header{};
+	std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+	header.version = version;
+	header.byte_order = host_byte_order;
+	header.num_bodies = universe.num_bodies;
+	header.simulation_epoch = universe.current_simulation_epoch;
+	header.header_size = sizeof(Header);
+
+	std::uint64_t offset = align_offset(sizeof(Header));
+	for (std::size_t array = 0; array < num_arrays; array++) {
+		header.array_offsets[array] = offset;
+		offset = align_offset(offset + universe.num_bodies * sizeof(double));
+	}
+
+	auto file_writer = std::ofstream{ file_path, std::ios::binary | std::ios::out | std::ios::trunc };
+	if (!file_writer.is_open()) {
+		throw std::invalid_argument("Could not open snapshot file " + file_path.string());
+	}
+	file_writer.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+	// one array at a time, so the staging buffer stays at num_bodies values
+	std::vector<double> values(universe.num_bodies);
+	const char padding[array_alignment] = {};
+	std::uint64_t written = sizeof(Header);
+	for (std::size_t array = 0; array < num_arrays; array++) {
+		file_writer.write(padding, header.array_offsets[array] - written);
+		const std::int64_t num_bodies = universe.num_bodies;
+#pragma omp parallel for
+		for (std::int64_t i = 0; i < num_bodies; i++) {
+			values[i] = get_component(universe, static_cast<SnapshotArray>(array), i);
+		}
+		file_writer.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+		written = header.array_offsets[array] + values.size() * sizeof(double);
+	}
+
+	if (!file_writer) {
+		throw std::runtime_error("Could not write snapshot file " + file_path.string());
+	}
+}
+
+void UniverseSnapshot::load(const std::filesystem::path& file_path, Universe& universe) {
+	UniverseSnapshotView view(file_path);
+	view.copy_to(universe);
+}
+
+bool UniverseSnapshot::is_snapshot_path(const std::filesystem::path& file_path) {
+	return file_path.extension() == file_extension;
+}
+
+UniverseSnapshotView::UniverseSnapshotView(const std::filesystem::path& file_path) : file(file_path) {
+	if (file.get_size() < sizeof(UniverseSnapshot::Header)) {
+		throw std::invalid_argument("Not a universe snapshot, file too small: " + file_path.string());
+	}
+	std::memcpy(&header, file.get_data(), sizeof(UniverseSnapshot::Header));
+
+	if (std::memcmp(header.magic, snapshot_magic, sizeof(snapshot_magic)) != 0) {
+		throw std::invalid_argument("Not a universe snapshot: " + file_path.string());
+	}
+	if (header.byte_order != host_byte_order) {
+		throw std::invalid_argument("Universe snapshot was written with a different byte order: " + file_path.string());
+	}
+	if (header.version != UniverseSnapshot::version) {
+		throw std::invalid_argument("Unsupported universe snapshot version " + std::to_string(header.version) + ": " + file_path.string());
+	}
+	if (header.header_size < sizeof(UniverseSnapshot::Header) || header.header_size > file.get_size() || header.num_bodies > file.get_size() / sizeof(double)) {
+		throw std::invalid_argument("Universe snapshot is truncated or corrupt: " + file_path.string());
+	}
+	// compared without adding to the offset, a corrupt offset close to the maximum would wrap around
+	const std::uint64_t array_size = header.num_bodies * sizeof(double);
+	for (auto offset : header.array_offsets) {
+		if (offset % UniverseSnapshot::array_alignment != 0 || offset < header.header_size || offset > file.get_size() || array_size > file.get_size() - offset) {
+			throw std::invalid_argument("Universe snapshot is truncated or corrupt: " + file_path.string());
+		}
+	}
+}
+
+const double* UniverseSnapshotView::get_array(UniverseSnapshot::SnapshotArray array) const {
+	// mmap returns page aligned memory and the offsets are aligned, so the cast is valid
+	return reinterpret_cast<const double*>(file.get_data() + header.array_offsets[static_cast<std::size_t>(array)]);
+}
+
+void UniverseSnapshotView::copy_to(Universe& universe) const {
+	using SnapshotArray = UniverseSnapshot::SnapshotArray;
+	file.advise_sequential();
+
+	universe.num_bodies = header.num_bodies;
+	universe.current_simulation_epoch = header.simulation_epoch;
+	universe.weights.resize(header.num_bodies);
+	universe.velocities.resize(header.num_bodies);
+	universe.positions.resize(header.num_bodies);
+	universe.forces.resize(header.num_bodies);
+
+	const double* position_x = get_array(SnapshotArray::position_x);
+	const double* position_y = get_array(SnapshotArray::position_y);
+	const double* velocity_x = get_array(SnapshotArray::velocity_x);
+	const double* velocity_y = get_array(SnapshotArray::velocity_y);
+	const double* force_x = get_array(SnapshotArray::force_x);
+	const double* force_y = get_array(SnapshotArray::force_y);
+	const double* weight = get_array(SnapshotArray::weight);
+
+	const std::int64_t num_bodies = header.num_bodies;
+#pragma omp parallel for
+	for (std::int64_t i = 0; i < num_bodies; i++) {
+		universe.positions[i] = Vector2d<double>(position_x[i], position_y[i]);
+		universe.velocities[i] = Vector2d<double>(velocity_x[i], velocity_y[i]);
+		universe.forces[i] = Vector2d<double>(force_x[i], force_y[i]);
+		universe.weights[i] = weight[i];
+	}
+}
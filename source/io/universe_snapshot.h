@@ -0,0 +1,70 @@
+#pragma once
+
+#include "structures/universe.h"
+#include "io/mapped_file.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+
+// Versioned binary universe format. A fixed header with body count and epoch is followed by one raw
+// array of doubles per component (structure of arrays), each starting at a 64 byte aligned offset.
+// Values are stored bit-exact in host byte order, the header records the byte order.
+class UniverseSnapshot {
+public:
+	static constexpr std::uint32_t version = 1;
+	static constexpr std::uint64_t array_alignment = 64;
+	static constexpr const char* file_extension = ".nbody";
+
+	enum class SnapshotArray : std::uint8_t {
+		position_x,
+		position_y,
+		velocity_x,
+		velocity_y,
+		force_x,
+		force_y,
+		weight
+	};
+	static constexpr std::size_t num_arrays = 7;
+
+	struct Header {
+		char magic[8];
+		std::uint32_t version;
+		// 0x01020304 as written by the host, detects files of the other byte order
+		std::uint32_t byte_order;
+		std::uint64_t num_bodies;
+		std::uint64_t simulation_epoch;
+		std::uint64_t header_size;
+		std::array<std::uint64_t, num_arrays> array_offsets;
+	};
+
+	static void save(const std::filesystem::path& file_path, Universe& universe);
+	static void load(const std::filesystem::path& file_path, Universe& universe);
+
+	// true for paths with the snapshot extension, used to choose between text and binary format
+	[[nodiscard]] static bool is_snapshot_path(const std::filesystem::path& file_path);
+};
+
+// Zero-copy access to the arrays of a snapshot. The file is mapped, the arrays are only read from
+// disk when accessed.
+class UniverseSnapshotView {
+public:
+	explicit UniverseSnapshotView(const std::filesystem::path& file_path);
+
+	[[nodiscard]] const UniverseSnapshot::Header& get_header() const {
+		return header;
+	}
+
+	[[nodiscard]] std::uint64_t get_num_bodies() const {
+		return header.num_bodies;
+	}
+
+	[[nodiscard]] const double* get_array(UniverseSnapshot::SnapshotArray array) const;
+
+	// copies the snapshot into the body arrays of the universe
+	void copy_to(Universe& universe) const;
+
+private:
+	MappedFile file;
+	UniverseSnapshot::Header header;
+};
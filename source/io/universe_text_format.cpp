@@ -0,0 +1,279 @@
+#include "io/universe_text_format.h"
+#include "io/mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// lines formatted by one task of the writer
+static constexpr std::uint64_t lines_per_write_chunk = 1 << 15;
+
+// chunks below this size are not split further, the per-chunk overhead would dominate
+static constexpr std::size_t min_chunk_bytes = 1 << 16;
+
+static bool is_blank(char character) {
+	return character == ' ' || character == '\t' || character == '\r';
+}
+
+static std::string_view trim(std::string_view text) {
+	while (!text.empty() && is_blank(text.front())) {
+		text.remove_prefix(1);
+	}
+	while (!text.empty() && is_blank(text.back())) {
+		text.remove_suffix(1);
+	}
+	return text;
+}
+
+// reads the next line of text starting at position and moves position behind it
+static std::string_view next_line(std::string_view text, std::size_t& position) {
+	std::size_t line_end = text.find('\n', position);
+	if (line_end == std::string_view::npos) {
+		line_end = text.size();
+	}
+	std::string_view line = text.substr(position, line_end - position);
+	position = std::min(line_end + 1, text.size());
+	return trim(line);
+}
+
+static void expect_header(std::string_view text, std::size_t& position, std::string_view header) {
+	std::string_view line = next_line(text, position);
+	if (line != header) {
+		throw std::invalid_argument("Invalid universe file: expected '" + std::string(header) + "' but found '" + std::string(line) + "'");
+	}
+}
+
+// Body of the section starting at position, up to the next section header or the end of the file.
+// A single scan for the next header, the values themselves are only touched by the parallel parser.
+static std::string_view next_section(std::string_view text, std::size_t& position) {
+	std::size_t section_end = text.size();
+	if (text.compare(position, 3, "###") == 0) {
+		section_end = position;
+	} else {
+		std::size_t header_start = text.find("\n###", position);
+		if (header_start != std::string_view::npos) {
+			section_end = header_start + 1;
+		}
+	}
+	std::string_view section = text.substr(position, section_end - position);
+	position = section_end;
+	return section;
+}
+
+// parses num_values numbers separated by blanks, false if the line holds anything else
+template <std::size_t num_values>
+static bool parse_values(std::string_view line, double (&values)[num_values]) {
+	const char* current = line.data();
+	const char* end = line.data() + line.size();
+	for (std::size_t value = 0; value < num_values; value++) {
+		while (current != end && is_blank(*current)) {
+			current++;
+		}
+		// from_chars does not accept a leading '+'
+		if (current != end && *current == '+') {
+			current++;
+		}
+		auto [parsed_end, error] = std::from_chars(current, end, values[value], std::chars_format::general);
+		if (error != std::errc{}) {
+			return false;
+		}
+		current = parsed_end;
+	}
+	while (current != end && is_blank(*current)) {
+		current++;
+	}
+	return current == end;
+}
+
+// Calls store(index, values) for every non-empty line of the section. The section is split into
+// chunks at line boundaries; the lines per chunk are counted first, so every chunk knows the index
+// of its first line, then all chunks are parsed in parallel.
+template <std::size_t num_values, typename StoreFunction>
+static void parse_section(std::string_view section, std::string_view section_name, std::uint64_t num_lines, StoreFunction store) {
+	const std::size_t num_chunks = std::max<std::size_t>(1, std::min<std::size_t>(omp_get_max_threads() * 4, section.size() / min_chunk_bytes));
+	std::vector<std::size_t> chunk_begin(num_chunks + 1);
+	for (std::size_t chunk = 0; chunk < num_chunks; chunk++) {
+		std::size_t begin = section.size() * chunk / num_chunks;
+		if (chunk > 0) {
+			std::size_t line_end = section.find('\n', begin - 1);
+			begin = line_end == std::string_view::npos ? section.size() : line_end + 1;
+		}
+		chunk_begin[chunk] = std::max(begin, chunk > 0 ? chunk_begin[chunk - 1] : 0);
+	}
+	chunk_begin[num_chunks] = section.size();
+
+	const auto for_each_line = [&section, &chunk_begin](std::size_t chunk, auto function) {
+		std::size_t position = chunk_begin[chunk];
+		while (position < chunk_begin[chunk + 1]) {
+			std::size_t line_end = std::min(section.find('\n', position), chunk_begin[chunk + 1]);
+			std::string_view line = trim(section.substr(position, line_end - position));
+			if (!line.empty()) {
+				function(line);
+			}
+			position = line_end + 1;
+		}
+	};
+
+	std::vector<std::uint64_t> chunk_first_line(num_chunks + 1, 0);
+#pragma omp parallel for schedule(static, 1)
+	for (std::size_t chunk = 0; chunk < num_chunks; chunk++) {
+		std::uint64_t lines = 0;
+		for_each_line(chunk, [&lines](std::string_view) { lines++; });
+		chunk_first_line[chunk + 1] = lines;
+	}
+	for (std::size_t chunk = 0; chunk < num_chunks; chunk++) {
+		chunk_first_line[chunk + 1] += chunk_first_line[chunk];
+	}
+	if (chunk_first_line[num_chunks] != num_lines) {
+		throw std::invalid_argument("Invalid universe file: section '" + std::string(section_name) + "' holds " + std::to_string(chunk_first_line[num_chunks]) + " entries, expected " + std::to_string(num_lines));
+	}
+
+	// index of the first malformed line, reported after the parallel region
+	std::atomic<std::uint64_t> first_error = std::numeric_limits<std::uint64_t>::max();
+#pragma omp parallel for schedule(static, 1)
+	for (std::size_t chunk = 0; chunk < num_chunks; chunk++) {
+		std::uint64_t index = chunk_first_line[chunk];
+		for_each_line(chunk, [&](std::string_view line) {
+			double values[num_values];
+			if (parse_values(line, values)) {
+				store(index, values);
+			} else {
+				std::uint64_t previous_error = first_error;
+				while (index < previous_error && !first_error.compare_exchange_weak(previous_error, index)) {
+				}
+			}
+			index++;
+		});
+	}
+	if (first_error != std::numeric_limits<std::uint64_t>::max()) {
+		throw std::invalid_argument("Invalid universe file: malformed entry " + std::to_string(first_error.load()) + " in section '" + std::string(section_name) + "'");
+	}
+}
+
+void UniverseTextFormat::load(const std::filesystem::path& file_path, Universe& universe) {
+	MappedFile file(file_path);
+	file.advise_sequential();
+	std::string_view text(reinterpret_cast<const char*>(file.get_data()), file.get_size());
+
+	std::size_t position = 0;
+	expect_header(text, position, "### Bodies");
+	std::string_view count_line = next_line(text, position);
+	std::uint64_t num_bodies = 0;
+	auto [count_end, count_error] = std::from_chars(count_line.data(), count_line.data() + count_line.size(), num_bodies);
+	if (count_error != std::errc{} || count_end != count_line.data() + count_line.size() || num_bodies > std::numeric_limits<std::uint32_t>::max()) {
+		throw std::invalid_argument("Invalid universe file: invalid body count '" + std::string(count_line) + "'");
+	}
+
+	universe.num_bodies = num_bodies;
+	universe.weights.resize(num_bodies);
+	universe.velocities.resize(num_bodies);
+	universe.positions.resize(num_bodies);
+	universe.forces.resize(num_bodies);
+
+	expect_header(text, position, "### Positions");
+	parse_section<2>(next_section(text, position), "Positions", num_bodies, [&universe](std::uint64_t i, double (&values)[2]) {
+		universe.positions[i] = Vector2d<double>(values[0], values[1]);
+	});
+
+	expect_header(text, position, "### Weights");
+	parse_section<1>(next_section(text, position), "Weights", num_bodies, [&universe](std::uint64_t i, double (&values)[1]) {
+		universe.weights[i] = values[0];
+	});
+
+	expect_header(text, position, "### Velocities");
+	parse_section<2>(next_section(text, position), "Velocities", num_bodies, [&universe](std::uint64_t i, double (&values)[2]) {
+		universe.velocities[i] = Vector2d<double>(values[0], values[1]);
+	});
+
+	expect_header(text, position, "### Forces");
+	parse_section<2>(next_section(text, position), "Forces", num_bodies, [&universe](std::uint64_t i, double (&values)[2]) {
+		universe.forces[i] = Vector2d<double>(values[0], values[1]);
+	});
+
+	if (position != text.size()) {
+		throw std::invalid_argument("Invalid universe file: unexpected content after section 'Forces'");
+	}
+}
+
+// Formats the section in chunks of lines_per_write_chunk lines. A batch of chunks is formatted in
+// parallel, then written in order, so the memory stays bounded by the batch size.
+template <std::size_t num_values, typename LoadFunction>
+static void write_section(std::ofstream& file, std::string_view header, std::uint64_t num_lines, std::vector<std::string>& buffers, LoadFunction load) {
+	file.write(header.data(), header.size());
+	file.put('\n');
+
+	const std::uint64_t num_chunks = (num_lines + lines_per_write_chunk - 1) / lines_per_write_chunk;
+	const std::int64_t batch_size = buffers.size();
+	for (std::uint64_t batch_begin = 0; batch_begin < num_chunks; batch_begin += batch_size) {
+		const std::int64_t chunks_in_batch = std::min<std::uint64_t>(batch_size, num_chunks - batch_begin);
+
+#pragma omp parallel for schedule(dynamic, 1)
+		for (std::int64_t batch_chunk = 0; batch_chunk < chunks_in_batch; batch_chunk++) {
+			std::string& buffer = buffers[batch_chunk];
+			buffer.clear();
+			const std::uint64_t first_line = (batch_begin + batch_chunk) * lines_per_write_chunk;
+			const std::uint64_t last_line = std::min(first_line + lines_per_write_chunk, num_lines);
+
+			// up to 24 characters per double, one separator each
+			char line[num_values * 25];
+			double values[num_values];
+			for (std::uint64_t i = first_line; i < last_line; i++) {
+				load(i, values);
+				char* line_end = line;
+				for (std::size_t value = 0; value < num_values; value++) {
+					line_end = std::to_chars(line_end, line + sizeof(line), values[value]).ptr;
+					*line_end++ = value + 1 < num_values ? ' ' : '\n';
+				}
+				buffer.append(line, line_end);
+			}
+		}
+
+		for (std::int64_t batch_chunk = 0; batch_chunk < chunks_in_batch; batch_chunk++) {
+			file.write(buffers[batch_chunk].data(), buffers[batch_chunk].size());
+		}
+	}
+}
+
+void UniverseTextFormat::save(const std::filesystem::path& file_path, Universe& universe) {
+	auto file = std::ofstream{ file_path, std::ios::binary | std::ios::out | std::ios::trunc };
+	if (!file.is_open()) {
+		throw std::invalid_argument("Could not open universe file " + file_path.string());
+	}
+
+	const std::uint64_t num_bodies = universe.num_bodies;
+	std::string count = "### Bodies\n" + std::to_string(num_bodies);
+	file.write(count.data(), count.size());
+	file.put('\n');
+
+	// a few chunks per thread, so dynamic scheduling can balance them
+	std::vector<std::string> buffers(omp_get_max_threads() * 2);
+
+	write_section<2>(file, "### Positions", num_bodies, buffers, [&universe](std::uint64_t i, double (&values)[2]) {
+		values[0] = universe.positions[i][0];
+		values[1] = universe.positions[i][1];
+	});
+	write_section<1>(file, "### Weights", num_bodies, buffers, [&universe](std::uint64_t i, double (&values)[1]) {
+		values[0] = universe.weights[i];
+	});
+	write_section<2>(file, "### Velocities", num_bodies, buffers, [&universe](std::uint64_t i, double (&values)[2]) {
+		values[0] = universe.velocities[i][0];
+		values[1] = universe.velocities[i][1];
+	});
+	write_section<2>(file, "### Forces", num_bodies, buffers, [&universe](std::uint64_t i, double (&values)[2]) {
+		values[0] = universe.forces[i][0];
+		values[1] = universe.forces[i][1];
+	});
+
+	file.close();
+	if (!file) {
+		throw std::runtime_error("Could not write universe file " + file_path.string());
+	}
+}
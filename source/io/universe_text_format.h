@@ -0,0 +1,20 @@
+#pragma once
+
+#include "structures/universe.h"
+
+#include <filesystem>
+
+// The text universe format:
+//   ### Bodies / count / ### Positions / x y per line / ### Weights / w per line /
+//   ### Velocities / x y per line / ### Forces / x y per line
+class UniverseTextFormat {
+public:
+	// Maps the file and parses every section in parallel chunks split at line boundaries. Numbers
+	// may use fixed or scientific notation. Throws std::invalid_argument for unexpected section
+	// headers, wrong value counts and malformed numbers.
+	static void load(const std::filesystem::path& file_path, Universe& universe);
+
+	// Formats the values with std::to_chars (shortest representation that reads back bit-exact) into
+	// per-thread buffers in parallel and writes the buffers in order with few large writes.
+	static void save(const std::filesystem::path& file_path, Universe& universe);
+};
@@ -7,14 +7,21 @@
 #include <iostream>
 #include "io/image_parser.h"
 #include "structures/universe.h"
-#include "simulation/naive_sequential_simulation.h"
-#include "simulation/naive_parallel_simulation.h"
-#include "simulation/barnes_hut_simulation.h"
-#include "simulation/barnes_hut_simulation_with_collisions.h"
+#include "simulation/simulation_context.h"
+#include "simulation/simulation_driver.h"
+#include "simulation/simulation_engine_registry.h"
+#include "parallel/thread_affinity.h"
+#include "io/checkpoint_writer.h"
+#include "io/trajectory_file.h"
 #include "utilities/export.hpp"
 #include "utilities/import.hpp"
 #include "input_generator/input_generator.h"
 #include "plotting/plotter.h"
+#include "plotting/frame_pipeline.h"
+#include "plotting/frame_sink.h"
+#include "plotting/poster_renderer.h"
+#include "profiling/phase_profiler.h"
+#include "profiling/hardware_counters.h"
 #include <exception>
 
 int main(int argc, char** argv) {
@@ -33,7 +40,30 @@ int main(int argc, char** argv) {
 	auto plot_intermediate_epochs = std::uint32_t{5};
 	auto plot_bounding_box_scale = std::uint32_t{5};
 	auto universe_generator = std::uint32_t{ 0 };
+	auto seed = std::uint64_t{0};
 	auto simulation_mode = std::uint32_t{0};
+	auto profile_json_path = std::filesystem::path{};
+	bool hardware_counters = bool{false};
+	auto hardware_counter_raw_event = std::uint64_t{0};
+	auto force_schedule = std::uint32_t{0};
+	auto simulated_ranks = std::int32_t{4};
+	auto thread_affinity = std::uint32_t{0};
+	auto checkpoint_every = std::uint32_t{0};
+	auto checkpoint_path = std::filesystem::path{"./checkpoint.nbody"};
+	auto restart_path = std::filesystem::path{};
+	auto force_schedule_chunk = std::int32_t{0};
+	auto frame_buffers = std::uint32_t{4};
+	auto trajectory_path = std::filesystem::path{};
+	auto trajectory_options = TrajectoryOptions{};
+	auto frame_backpressure = std::uint32_t{0};
+	auto frame_sink_id = std::uint32_t{0};
+	auto plot_style = std::uint32_t{0};
+	auto image_format = std::uint32_t{0};
+	auto frame_sink_command = std::string{};
+	auto frames_per_second = std::uint32_t{30};
+	auto poster_options = PosterOptions{};
+	poster_options.width = 0;
+	poster_options.height = 0;
 
 	lab_cli_app.add_option("--output-image-width", output_image_width, "default: 800px");
 	lab_cli_app.add_option("--output-image-height", output_image_height, "default: 800px");
@@ -41,12 +71,40 @@ int main(int argc, char** argv) {
 	lab_cli_app.add_option("--output-intermediate-states", output_intermediate_states, "Toggle the output of Bitmaps during the simulation. Default: true");
 	lab_cli_app.add_option("--num-bodies", num_bodies, "Number of randomly generated bodies, if not input is specified. Default: 100");
 	lab_cli_app.add_option("--plot-intermediate-epochs", plot_intermediate_epochs, "Control the amount of plotted states. Value of 1 creates a plot for every epoch, a value of 5 plots every 5th intermediate epoch etc. Default: 5");
-	lab_cli_app.add_option("--save-universe-path", save_universe_path, "Path to store the current universe for reproducibility. Default: ./universe.txt");
+	lab_cli_app.add_option("--save-universe-path", save_universe_path, "Path to store the current universe for reproducibility. Files ending in .nbody are written as binary snapshot, all others as text. Default: ./universe.txt");
 	lab_cli_app.add_option("--plot-bounding-box-scale", plot_bounding_box_scale, "Scale of the plotted bounding box compared to the initial bounding box of the system. Default: 5");
-	lab_cli_app.add_option("--universe-generator", universe_generator, "Select universe generator. Options: 0 -> Random universe. 1 -> Earth Orbit. 2 -> Random universe with at least one supermassive black hole. 3 -> Random universe with at least two supermassive black holes. Please feel free to add new generators. 4 -> Create two colliding bodies. Default: 0");
-	auto load_universe_option = lab_cli_app.add_option("--load-universe-path", load_universe_path, "Path to the universe file to be loaded.");
-	lab_cli_app.add_option("--simulation-mode", simulation_mode, "Select simulation mode. Options: 0 -> Naive sequential. 1 -> Naive parallel. 2 -> Barnes-Hut. 3 -> Barnes-Hut with collisions. Default: 0");
+	lab_cli_app.add_option("--universe-generator", universe_generator, "Select universe generator. Options: 0 -> Random universe. 1 -> Earth Orbit. 2 -> Random universe with at least one supermassive black hole. 3 -> Random universe with at least two supermassive black holes. Please feel free to add new generators. 4 -> Create two colliding bodies. 5 -> Plummer star cluster. 6 -> Exponential disk galaxy around a central black hole. 7 -> Merger of two disk galaxies. Default: 0");
+	auto seed_option = lab_cli_app.add_option("--seed", seed, "Seed of the random universe generators. The same seed creates the same universe with any number of threads. Default: derived from the current time");
+	auto load_universe_option = lab_cli_app.add_option("--load-universe-path", load_universe_path, "Path to the universe file to be loaded. Files ending in .nbody are read as binary snapshot, all others as text.");
+	auto& engine_registry = SimulationEngineRegistry::get_instance();
+	lab_cli_app.add_option("--simulation-mode", simulation_mode, "Select simulation mode. Options: " + engine_registry.get_description() + "Default: 0");
 	lab_cli_app.add_option("--save-initial-universe", save_initial_universe, "Toggle saving the initial universe to --save-universe-path. Default: true");
+	lab_cli_app.add_option("--profile-json", profile_json_path, "Write per-epoch phase timings and thread counters to the given JSON file. Default: disabled");
+	lab_cli_app.add_option("--hardware-counters", hardware_counters, "Add cycles, instructions and last level cache misses per phase and thread to --profile-json, read with perf_event_open. Default: false");
+	lab_cli_app.add_option("--hardware-counter-raw-event", hardware_counter_raw_event, "Additional model specific perf event config counted as 'raw', e.g. the retired floating point operations of the cpu. Default: 0, disabled");
+	lab_cli_app.add_option("--force-schedule", force_schedule, "Distribution of the Barnes-Hut force loop to the threads. Options: 0 -> static. 1 -> dynamic. 2 -> guided. 3 -> cost weighted by the interactions of the previous epoch. 4 -> cost zones along the Morton order of the quadtree. Default: 0");
+	lab_cli_app.add_option("--checkpoint-every", checkpoint_every, "Write a binary snapshot of the simulation state to --checkpoint-path every N epochs, 0 disables checkpoints. Default: 0");
+	lab_cli_app.add_option("--checkpoint-path", checkpoint_path, "Checkpoint file, replaced atomically by every checkpoint. Default: ./checkpoint.nbody");
+	lab_cli_app.add_option("--restart-from", restart_path, "Continue the simulation from a checkpoint up to --num-epochs total epochs.")->check(CLI::ExistingFile);
+	lab_cli_app.add_option("--thread-affinity", thread_affinity, "Pin the OpenMP threads. Options: 0 -> no pinning. 1 -> compact, neighbouring threads on neighbouring cpus. 2 -> scatter, threads spread over all cpus. Default: 0");
+	lab_cli_app.add_option("--simulated-ranks", simulated_ranks, "Number of ranks the distributed engine runs as threads of this process. Default: 4");
+	lab_cli_app.add_option("--force-schedule-chunk", force_schedule_chunk, "Chunk size of the dynamic and guided force schedule, 0 selects the OpenMP default. Default: 0");
+
+	lab_cli_app.add_option("--frame-buffers", frame_buffers, "Number of frame buffers of the background thread writing the intermediate plots, 0 writes them on the simulation thread. Default: 4");
+	lab_cli_app.add_option("--frame-backpressure", frame_backpressure, "Behaviour if all frame buffers are in use. Options: 0 -> wait for the writer. 1 -> drop the frame. Default: 0");
+
+	lab_cli_app.add_option("--plot-style", plot_style, "Rendering of the bodies. Options: 0 -> one white pixel per body. 1 -> log scaled number of bodies per pixel. 2 -> log scaled mass per pixel. 3 -> log scaled mass per pixel from the Barnes-Hut tree, nodes below one pixel are drawn as one point. Default: 0");
+	lab_cli_app.add_option("--image-format", image_format, "File format of the plots written by --frame-sink 0. Options: 0 -> bmp. 1 -> png. 2 -> qoi. Default: 0");
+	lab_cli_app.add_option("--frame-sink", frame_sink_id, "Output of the plots. Options: 0 -> one bitmap file per plot. 1 -> raw rgb24 video simulation_result.rgb. 2 -> y4m video simulation_result.y4m. 3 -> raw rgb24 frames piped to --frame-sink-command. Default: 0");
+	lab_cli_app.add_option("--frame-sink-command", frame_sink_command, "Command reading the raw frames of --frame-sink 3 from its standard input. Default: ffmpeg writing simulation_result.mp4");
+	lab_cli_app.add_option("--frames-per-second", frames_per_second, "Frame rate of the video frame sinks. Default: 30");
+	lab_cli_app.add_option("--poster-width", poster_options.width, "Width of a tiled poster of the final state written to <output>/poster, 0 disables the poster. Default: 0");
+	lab_cli_app.add_option("--poster-height", poster_options.height, "Height of the tiled poster of the final state. Default: 0");
+	lab_cli_app.add_option("--poster-tile-size", poster_options.tile_size, "Edge length of the poster tiles, has to be even. Default: 256");
+	lab_cli_app.add_option("--trajectory-path", trajectory_path, "Write the body positions to a compressed trajectory file for post-processing. Default: disabled");
+	lab_cli_app.add_option("--trajectory-every", trajectory_options.every, "Write a trajectory frame every N epochs. Default: 1");
+	lab_cli_app.add_option("--trajectory-velocities", trajectory_options.velocities, "Add the velocities to the trajectory. Default: false");
+	lab_cli_app.add_option("--trajectory-single-precision", trajectory_options.single_precision, "Store the trajectory as float instead of double. Default: false");
 
 	auto output_option = lab_cli_app.add_option("--output", output_path, "Required argument. Set the path to the output directory. MUST contain 'scratch'.");
 
@@ -67,17 +125,31 @@ int main(int argc, char** argv) {
 	output_option->check(CLI::ExistingDirectory);
 
 
+	// pin the threads before the body arrays are allocated, so the first touch already happens on the final cpus
+	auto affinity = get_thread_affinity(thread_affinity);
+	if(!ThreadPinning::apply(affinity)){
+		std::cerr << "Thread affinity " << get_thread_affinity_name(affinity) << " is not supported on this platform, threads are not pinned." << std::endl;
+	}
+
 	// check if a universe shall be loaded or created
 	auto universe = Universe();
-	if(std::filesystem::exists(load_universe_path)){
+	if(!restart_path.empty()){
+		// the checkpoint holds the epoch counter, the run continues where it stopped
+		load_universe(restart_path, universe);
+	}
+	else if(std::filesystem::exists(load_universe_path)){
 		// load existing universe
 		load_universe(load_universe_path, universe);
 	}	
 	else{
+		if(!*seed_option){
+			seed = InputGenerator::get_time_seed();
+		}
+		std::cout << "seed: " << seed << std::endl;
 		switch(universe_generator){
 			case 0:
 				// Create random universe
-				InputGenerator::create_random_universe(num_bodies, universe);
+				InputGenerator::create_random_universe(num_bodies, universe, seed);
 				break;
 			case 1:
 				// create earth orbit
@@ -85,16 +157,28 @@ int main(int argc, char** argv) {
 				break;
 			case 2:
 				// Create random universe with at least one supermassive black hole
-				InputGenerator::create_random_universe_with_supermassive_blackholes(num_bodies, universe, 1);
+				InputGenerator::create_random_universe_with_supermassive_blackholes(num_bodies, universe, 1, seed);
 				break;
 			case 3:
 				// Create random universe with at least two supermassive black hole
-				InputGenerator::create_random_universe_with_supermassive_blackholes(num_bodies, universe, 2);
+				InputGenerator::create_random_universe_with_supermassive_blackholes(num_bodies, universe, 2, seed);
 				break;
 			case 4:
 				// Create two colliding bodies
 				InputGenerator::create_two_body_collision(universe);
 				break;
+			case 5:
+				// Create a star cluster with a Plummer profile
+				InputGenerator::create_plummer_sphere(num_bodies, universe, seed);
+				break;
+			case 6:
+				// Create a disk galaxy around a supermassive black hole
+				InputGenerator::create_disk_galaxy(num_bodies, universe, seed);
+				break;
+			case 7:
+				// Create two colliding disk galaxies
+				InputGenerator::create_galaxy_merger(num_bodies, universe, seed);
+				break;
 			default:
 				throw std::invalid_argument("Invalid Argument for --universe-generator");
 		}		
@@ -113,37 +197,103 @@ int main(int argc, char** argv) {
 	// initialize plotter
 	Plotter plotter(plot_bounding_box, output_path, output_image_width, output_image_height);
 	plotter.set_filename_prefix("simulation_result");
+	plotter.set_plot_style(get_plot_style(plot_style));
+	plotter.set_image_format(get_image_format(image_format));
+	std::shared_ptr<FrameSink> frame_sink;
+	switch(get_frame_sink_type(frame_sink_id)){
+		case FrameSinkType::bitmap_files:
+			break;
+		case FrameSinkType::raw:
+			frame_sink = std::make_shared<RawFrameSink>(std::filesystem::path{output_path} / "simulation_result.rgb", output_image_width, output_image_height);
+			break;
+		case FrameSinkType::y4m:
+			frame_sink = std::make_shared<Y4mFrameSink>(std::filesystem::path{output_path} / "simulation_result.y4m", output_image_width, output_image_height, frames_per_second);
+			break;
+		case FrameSinkType::pipe:
+			if(frame_sink_command.empty()){
+				frame_sink_command = get_default_encoder_command(std::filesystem::path{output_path} / "simulation_result.mp4", output_image_width, output_image_height, frames_per_second);
+			}
+			frame_sink = std::make_shared<PipeFrameSink>(frame_sink_command, output_image_width, output_image_height);
+			break;
+	}
+	plotter.set_frame_sink(frame_sink);
 
 	// plot initial state of the universe
 	plotter.add_bodies_to_image(universe);
 	plotter.write_and_clear();
+	if(frame_buffers > 0){
+		plotter.enable_async_frames(frame_buffers, get_frame_backpressure(frame_backpressure));
+	}
 
 	// save experiment before starting the simulation for reproducibility
-	if(save_initial_universe){
+	if(save_initial_universe && restart_path.empty()){
 		save_universe(save_universe_path, universe);
 	}
 
 	// simulate universe
-	switch(simulation_mode){
-		case 0:
-			NaiveSequentialSimulation::simulate_epochs(plotter, universe, number_epochs, output_intermediate_states, plot_intermediate_epochs);
-			break;
-		case 1:
-			NaiveParallelSimulation::simulate_epochs(plotter, universe, number_epochs, output_intermediate_states, plot_intermediate_epochs);
-			break;
-		case 2:
-			BarnesHutSimulation::simulate_epochs(plotter, universe, number_epochs, output_intermediate_states, plot_intermediate_epochs);
-			break;
-		case 3:
-			BarnesHutSimulationWithCollisions::simulate_epochs(plotter, universe, number_epochs, output_intermediate_states, plot_intermediate_epochs);
-			break;
-		default:
-			throw std::invalid_argument("unknown simulation mode: " + std::to_string(simulation_mode));
+	EngineOptions engine_options;
+	engine_options.simulated_ranks = simulated_ranks;
+	auto engine = engine_registry.create_engine(simulation_mode, engine_options);
+	SimulationContext context(universe);
+	context.force_schedule.schedule = get_force_schedule(force_schedule);
+	context.force_schedule.chunk_size = force_schedule_chunk;
+	PhaseProfiler profiler(engine->get_name());
+	HardwareCounterProfiler hardware_counter_profiler(hardware_counter_raw_event);
+	if(!profile_json_path.empty()){
+		context.add_observer(&profiler);
+		if(hardware_counters){
+			context.add_observer(&hardware_counter_profiler);
+			profiler.set_hardware_counters(&hardware_counter_profiler);
+		}
+	}
+	std::unique_ptr<CheckpointWriter> checkpoint_writer;
+	if(checkpoint_every > 0){
+		checkpoint_writer = std::make_unique<CheckpointWriter>(checkpoint_path, checkpoint_every);
+		context.add_observer(checkpoint_writer.get());
+	}
+	std::unique_ptr<TrajectoryWriter> trajectory_writer;
+	if(!trajectory_path.empty()){
+		trajectory_writer = std::make_unique<TrajectoryWriter>(trajectory_path, trajectory_options);
+		trajectory_writer->append(universe);
+		context.add_observer(trajectory_writer.get());
+	}
+	// --num-epochs counts from the beginning of the run, a restarted run only simulates the remaining epochs
+	std::uint32_t remaining_epochs = number_epochs;
+	if(!restart_path.empty()){
+		remaining_epochs = number_epochs > universe.current_simulation_epoch ? number_epochs - universe.current_simulation_epoch : 0;
+	}
+	SimulationDriver::simulate_epochs(*engine, plotter, universe, context, remaining_epochs, output_intermediate_states, plot_intermediate_epochs);
+	if(checkpoint_writer){
+		checkpoint_writer->flush();
+	}
+	if(trajectory_writer){
+		trajectory_writer->close();
+	}
+	if(!profile_json_path.empty()){
+		profiler.write_json(profile_json_path);
+		if(hardware_counters && !hardware_counter_profiler.is_available()){
+			std::cout << "Hardware counters not available: " << hardware_counter_profiler.get_unavailable_reason() << std::endl;
+		}
+	}
+
+	plotter.flush_frames();
+	if(plotter.get_num_dropped_frames() > 0){
+		std::cout << "Dropped " << plotter.get_num_dropped_frames() << " intermediate plots, the frame writer was too slow." << std::endl;
 	}
 
 	// plot simulation result
 	plotter.add_bodies_to_image(universe);
 	plotter.write_and_clear();
+	if(frame_sink){
+		frame_sink->close();
+	}
+	if(poster_options.width > 0 && poster_options.height > 0){
+		poster_options.style = get_plot_style(plot_style);
+		// a poster without compression would not fit on disk
+		poster_options.format = get_image_format(image_format) == ImageFormat::bmp ? ImageFormat::png : get_image_format(image_format);
+		auto poster_statistics = PosterRenderer::render(universe, plot_bounding_box, std::filesystem::path{output_path} / "poster", poster_options);
+		std::cout << "Wrote " << poster_statistics.num_tiles_written << " poster tiles on " << poster_statistics.num_levels << " levels." << std::endl;
+	}
 
 	return 0;
 }
@@ -0,0 +1,108 @@
+#include "parallel/thread_affinity.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+ThreadAffinity get_thread_affinity(std::uint32_t affinity_id){
+    switch (affinity_id) {
+        case 0:
+            return ThreadAffinity::none;
+        case 1:
+            return ThreadAffinity::compact;
+        case 2:
+            return ThreadAffinity::scatter;
+        default:
+            throw std::invalid_argument("unknown thread affinity: " + std::to_string(affinity_id));
+    }
+}
+
+const char* get_thread_affinity_name(ThreadAffinity affinity){
+    switch (affinity) {
+        case ThreadAffinity::none:
+            return "none";
+        case ThreadAffinity::compact:
+            return "compact";
+        case ThreadAffinity::scatter:
+            return "scatter";
+    }
+    return "unknown";
+}
+
+std::vector<std::int32_t> ThreadPinning::get_allowed_cpus(){
+    std::vector<std::int32_t> cpus;
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+        for (std::int32_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &cpu_set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        for (std::uint32_t cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::int32_t ThreadPinning::get_num_numa_nodes(){
+    std::int32_t num_nodes = 0;
+    std::error_code error;
+    for (auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) == 0 && name.size() > 4 && std::isdigit(static_cast<unsigned char>(name[4]))) {
+            num_nodes++;
+        }
+    }
+    return std::max(num_nodes, 1);
+}
+
+bool ThreadPinning::apply(ThreadAffinity affinity){
+#ifdef __linux__
+    // the allowed set is read before pinning, a second call must not see the pinned set of the master
+    static const std::vector<std::int32_t> allowed_cpus = get_allowed_cpus();
+    bool pinned = true;
+
+#pragma omp parallel reduction(&& : pinned)
+    {
+        const std::int32_t thread_id = omp_get_thread_num();
+        const std::int32_t num_threads = omp_get_num_threads();
+        const std::int32_t num_cpus = allowed_cpus.size();
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        switch (affinity) {
+            case ThreadAffinity::none:
+                for (auto cpu : allowed_cpus) {
+                    CPU_SET(cpu, &cpu_set);
+                }
+                break;
+            case ThreadAffinity::compact:
+                CPU_SET(allowed_cpus[thread_id % num_cpus], &cpu_set);
+                break;
+            case ThreadAffinity::scatter:
+                // stride over the cpus, with the usual numbering of one socket after the other this
+                // alternates between the sockets
+                CPU_SET(allowed_cpus[(static_cast<std::int64_t>(thread_id) * num_cpus / num_threads) % num_cpus], &cpu_set);
+                break;
+        }
+        pinned = sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+    }
+    return pinned;
+#else
+    return affinity == ThreadAffinity::none;
+#endif
+}
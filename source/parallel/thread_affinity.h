@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// pinning of the OpenMP threads to cpus
+enum class ThreadAffinity : std::uint8_t {
+    // leave the placement to the operating system
+    none,
+    // thread i on the i-th allowed cpu, neighbouring threads share a socket
+    compact,
+    // threads spread evenly over the allowed cpus, so every socket gets threads
+    scatter
+};
+
+[[nodiscard]] ThreadAffinity get_thread_affinity(std::uint32_t affinity_id);
+[[nodiscard]] const char* get_thread_affinity_name(ThreadAffinity affinity);
+
+class ThreadPinning {
+public:
+    // Pins the threads of the OpenMP pool. OpenMP reuses its threads, so later parallel regions with
+    // the same thread count keep the placement. Returns false if pinning is not supported on this
+    // platform, the policy is then a no-op.
+    static bool apply(ThreadAffinity affinity);
+
+    // cpus this process may run on, in ascending order
+    [[nodiscard]] static std::vector<std::int32_t> get_allowed_cpus();
+    // number of NUMA nodes, 1 if unknown
+    [[nodiscard]] static std::int32_t get_num_numa_nodes();
+};
@@ -0,0 +1,147 @@
+#include "plotting/density_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include <omp.h>
+
+PlotStyle get_plot_style(std::uint32_t style_id){
+    switch (style_id) {
+        case 0:
+            return PlotStyle::points;
+        case 1:
+            return PlotStyle::density;
+        case 2:
+            return PlotStyle::mass;
+        case 3:
+            return PlotStyle::level_of_detail;
+        default:
+            throw std::invalid_argument("unknown plot style: " + std::to_string(style_id));
+    }
+}
+
+// pixel of a position with the rounding of Plotter::mark_position, false outside the box
+static bool get_pixel_index(const BoundingBox& bounding_box, double x_scale, double y_scale, std::uint32_t width, Vector2d<double> position, std::size_t& index){
+    const double x = position[0];
+    const double y = position[1];
+    if (!(bounding_box.x_min <= x && x <= bounding_box.x_max && bounding_box.y_min <= y && y <= bounding_box.y_max)) {
+        return false;
+    }
+    const auto pixel_x = static_cast<std::uint32_t>((x - bounding_box.x_min) * x_scale);
+    const auto pixel_y = static_cast<std::uint32_t>((y - bounding_box.y_min) * y_scale);
+    index = static_cast<std::size_t>(pixel_y) * width + pixel_x;
+    return true;
+}
+
+DensityRenderer::DensityRenderer(std::uint32_t arg_width, std::uint32_t arg_height)
+    : width(arg_width), height(arg_height), values(static_cast<std::size_t>(arg_width) * arg_height, 0.0){
+    // black over purple and orange to pale yellow, interpolated to 256 entries
+    constexpr std::array<std::array<double, 3>, 5> control_points = {{
+        {0, 0, 4}, {87, 16, 110}, {188, 55, 84}, {249, 142, 9}, {252, 255, 164}
+    }};
+    for (std::size_t entry = 0; entry < colormap.size(); entry++) {
+        const double t = static_cast<double>(entry) / (colormap.size() - 1) * (control_points.size() - 1);
+        const std::size_t segment = std::min<std::size_t>(static_cast<std::size_t>(t), control_points.size() - 2);
+        const double fraction = t - segment;
+        std::array<std::uint8_t, 3> color{};
+        for (std::size_t channel = 0; channel < 3; channel++) {
+            color[channel] = static_cast<std::uint8_t>(std::lround(control_points[segment][channel] * (1 - fraction) + control_points[segment + 1][channel] * fraction));
+        }
+        colormap[entry] = BitmapImage::BitmapPixel(color[0], color[1], color[2]);
+    }
+}
+
+void DensityRenderer::clear(){
+    std::fill(values.begin(), values.end(), 0.0);
+}
+
+void DensityRenderer::accumulate(const BoundingBox& bounding_box, const Vector2d<double>* positions, const double* weights, std::size_t num_positions){
+    const double x_scale = (width - 1) / (bounding_box.x_max - bounding_box.x_min);
+    const double y_scale = (height - 1) / (bounding_box.y_max - bounding_box.y_min);
+    const std::int64_t num_bodies = num_positions;
+    const std::int64_t num_pixels = values.size();
+    thread_values.resize(omp_get_max_threads());
+    std::int32_t num_threads = 1;
+
+#pragma omp parallel
+    {
+        // every thread bins into its own buffer, touched by the thread itself
+        auto& local_values = thread_values[omp_get_thread_num()];
+        local_values.assign(num_pixels, 0.0);
+#pragma omp single
+        num_threads = omp_get_num_threads();
+
+#pragma omp for schedule(static)
+        for (std::int64_t i = 0; i < num_bodies; i++) {
+            std::size_t index;
+            if (get_pixel_index(bounding_box, x_scale, y_scale, width, positions[i], index)) {
+                local_values[index] += weights != nullptr ? weights[i] : 1.0;
+            }
+        }
+
+#pragma omp for schedule(static)
+        for (std::int64_t pixel = 0; pixel < num_pixels; pixel++) {
+            double sum = values[pixel];
+            for (std::int32_t thread = 0; thread < num_threads; thread++) {
+                sum += thread_values[thread][pixel];
+            }
+            values[pixel] = sum;
+        }
+    }
+}
+
+void DensityRenderer::accumulate_point(const BoundingBox& bounding_box, Vector2d<double> position, double value){
+    const double x_scale = (width - 1) / (bounding_box.x_max - bounding_box.x_min);
+    const double y_scale = (height - 1) / (bounding_box.y_max - bounding_box.y_min);
+    std::size_t index;
+    if (get_pixel_index(bounding_box, x_scale, y_scale, width, position, index)) {
+        values[index] += value;
+    }
+}
+
+void DensityRenderer::tone_map(BitmapImage& image) const{
+    if (image.get_width() != width || image.get_height() != height) {
+        throw std::invalid_argument("image size differs from the size of the renderer");
+    }
+    const std::int64_t num_pixels = values.size();
+    double max_value = 0;
+#pragma omp parallel for reduction(max:max_value)
+    for (std::int64_t pixel = 0; pixel < num_pixels; pixel++) {
+        max_value = std::max(max_value, values[pixel]);
+    }
+    if (max_value <= 0) {
+        return;
+    }
+
+    // log scale relative to the smallest positive value, a single light body is still visible
+    double min_value = max_value;
+#pragma omp parallel for reduction(min:min_value)
+    for (std::int64_t pixel = 0; pixel < num_pixels; pixel++) {
+        if (values[pixel] > 0) {
+            min_value = std::min(min_value, values[pixel]);
+        }
+    }
+
+    const std::int64_t num_rows = height;
+#pragma omp parallel for
+    for (std::int64_t y = 0; y < num_rows; y++) {
+        const double* row_values = values.data() + y * width;
+        for (std::uint32_t x = 0; x < width; x++) {
+            if (row_values[x] > 0) {
+                image.set_pixel(static_cast<std::uint32_t>(y), x, get_color(row_values[x], min_value, max_value));
+            }
+        }
+    }
+}
+
+BitmapImage::BitmapPixel DensityRenderer::get_color(double value, double min_value, double max_value) const{
+    const double log_range = std::log(max_value / min_value);
+    // the lowest entries are too dark to see, occupied pixels start a quarter up the colormap
+    const double t = log_range > 0 ? std::log(value / min_value) / log_range : 1.0;
+    // an infinite value gives NaN, which clamp passes through and lround must not see
+    const double clamped_t = std::isnan(t) ? 1.0 : std::clamp(t, 0.0, 1.0);
+    const auto entry = static_cast<std::size_t>(64 + std::lround(clamped_t * (colormap.size() - 65)));
+    return colormap[std::min(entry, colormap.size() - 1)];
+}
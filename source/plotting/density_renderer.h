@@ -0,0 +1,55 @@
+#pragma once
+
+#include "image/bitmap_image.h"
+#include "structures/bounding_box.h"
+#include "structures/vector2d.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// how the bodies are drawn into a plot
+enum class PlotStyle : std::uint8_t {
+    // every body sets its pixel to white
+    points,
+    // number of bodies per pixel, log scaled and colored
+    density,
+    // mass per pixel, log scaled and colored
+    mass,
+    // mass per pixel from the quadtree, nodes below one pixel are drawn as a single point
+    level_of_detail
+};
+
+[[nodiscard]] PlotStyle get_plot_style(std::uint32_t style_id);
+
+// Accumulates bodies into a double buffer with one value per pixel. The bodies are binned in parallel
+// into one buffer per thread and the buffers are summed afterwards, so no atomics are needed.
+// tone_map() turns the buffer into colors with a log scale, dense regions stay distinguishable.
+class DensityRenderer {
+public:
+    DensityRenderer(std::uint32_t arg_width, std::uint32_t arg_height);
+
+    void clear();
+
+    // adds weights[i], or 1 without weights, at the pixel of every position inside the box
+    void accumulate(const BoundingBox& bounding_box, const Vector2d<double>* positions, const double* weights, std::size_t num_positions);
+    // adds the value at the pixel of a single position, used to splat aggregated tree nodes
+    void accumulate_point(const BoundingBox& bounding_box, Vector2d<double> position, double value);
+
+    // colors every pixel with a value, pixels without value are left unchanged
+    void tone_map(BitmapImage& image) const;
+
+    // color of a value on the log scale between the smallest and largest positive value
+    [[nodiscard]] BitmapImage::BitmapPixel get_color(double value, double min_value, double max_value) const;
+
+    [[nodiscard]] const std::vector<double>& get_values() const{
+        return values;
+    }
+
+private:
+    std::uint32_t width;
+    std::uint32_t height;
+    std::vector<double> values;
+    std::vector<std::vector<double>> thread_values;
+    std::array<BitmapImage::BitmapPixel, 256> colormap;
+};
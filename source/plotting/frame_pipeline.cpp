@@ -0,0 +1,131 @@
+#include "plotting/frame_pipeline.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+FrameBackpressure get_frame_backpressure(std::uint32_t backpressure_id){
+    switch (backpressure_id) {
+        case 0:
+            return FrameBackpressure::block;
+        case 1:
+            return FrameBackpressure::drop;
+        default:
+            throw std::invalid_argument("unknown frame backpressure: " + std::to_string(backpressure_id));
+    }
+}
+
+AsyncFramePipeline::AsyncFramePipeline(const Plotter& arg_plotter, std::size_t num_buffers, FrameBackpressure arg_backpressure)
+    : plotter(arg_plotter), backpressure(arg_backpressure), buffers(num_buffers){
+    if (num_buffers == 0) {
+        throw std::invalid_argument("the frame pipeline needs at least one buffer");
+    }
+    for (std::size_t buffer = 0; buffer < num_buffers; buffer++) {
+        free_buffers.push_back(buffer);
+    }
+    worker = std::thread([this]() { run(); });
+}
+
+AsyncFramePipeline::~AsyncFramePipeline(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    state_changed.notify_all();
+    worker.join();
+}
+
+bool AsyncFramePipeline::submit(Universe& universe, QuadtreeNode* tree_root){
+    std::size_t buffer;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (free_buffers.empty()) {
+            if (backpressure == FrameBackpressure::drop) {
+                num_frames_dropped++;
+                return false;
+            }
+            state_changed.wait(lock, [this]() { return !free_buffers.empty(); });
+        }
+        buffer = free_buffers.front();
+        free_buffers.pop_front();
+    }
+
+    // the buffer belongs to this thread until it is queued, the copy needs no lock
+    // the tree is reused by the next epoch, only its level of detail points are copied
+    FrameBuffer& frame = buffers[buffer];
+    if (tree_root != nullptr) {
+        plotter.get_level_of_detail_points(tree_root, frame.positions, frame.weights);
+    } else {
+        frame.positions.assign(universe.positions.begin(), universe.positions.begin() + universe.num_bodies);
+        if (plotter.needs_weights()) {
+            frame.weights.assign(universe.weights.begin(), universe.weights.begin() + universe.num_bodies);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued_buffers.push_back(buffer);
+    }
+    state_changed.notify_all();
+    return true;
+}
+
+void AsyncFramePipeline::flush(){
+    std::unique_lock<std::mutex> lock(mutex);
+    state_changed.wait(lock, [this]() { return queued_buffers.empty() && !writing; });
+    if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+}
+
+std::uint32_t AsyncFramePipeline::get_num_frames_written() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_frames_written;
+}
+
+std::uint32_t AsyncFramePipeline::get_num_frames_dropped() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_frames_dropped;
+}
+
+std::uint32_t AsyncFramePipeline::get_next_image_serial_number() const{
+    std::lock_guard<std::mutex> lock(mutex);
+    return plotter.get_next_image_serial_number();
+}
+
+void AsyncFramePipeline::run(){
+    while (true) {
+        std::size_t buffer;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            state_changed.wait(lock, [this]() { return !queued_buffers.empty() || stopping; });
+            if (queued_buffers.empty()) {
+                return;
+            }
+            buffer = queued_buffers.front();
+            queued_buffers.pop_front();
+            writing = true;
+        }
+
+        std::exception_ptr write_error;
+        try {
+            const FrameBuffer& frame = buffers[buffer];
+            plotter.add_positions_to_image(frame.positions.data(), frame.weights.empty() ? nullptr : frame.weights.data(), frame.positions.size());
+            plotter.write_and_clear();
+        } catch (...) {
+            write_error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            writing = false;
+            free_buffers.push_back(buffer);
+            if (write_error) {
+                error = write_error;
+            } else {
+                num_frames_written++;
+            }
+        }
+        state_changed.notify_all();
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "plotting/plotter.h"
+#include "structures/universe.h"
+
+// what happens if all frame buffers are in use
+enum class FrameBackpressure : std::uint8_t {
+    // the simulation waits for the writer
+    block,
+    // the frame is skipped, the simulation never waits
+    drop
+};
+
+[[nodiscard]] FrameBackpressure get_frame_backpressure(std::uint32_t backpressure_id);
+
+// Moves rasterizing and writing of frames to a background thread. submit() only copies the body
+// positions into one of a fixed ring of buffers; the writer thread plots them with its own Plotter
+// and writes the frame. The buffers are allocated once and reused.
+class AsyncFramePipeline {
+public:
+    AsyncFramePipeline(const Plotter& arg_plotter, std::size_t num_buffers, FrameBackpressure arg_backpressure);
+    ~AsyncFramePipeline();
+
+    AsyncFramePipeline(const AsyncFramePipeline&) = delete;
+    AsyncFramePipeline& operator=(const AsyncFramePipeline&) = delete;
+
+    // queues the current positions, or the level of detail points of the tree, as next frame. False if the frame was dropped.
+    bool submit(Universe& universe, QuadtreeNode* tree_root = nullptr);
+    // waits until all queued frames are written, rethrows errors of the writer thread
+    void flush();
+
+    [[nodiscard]] std::uint32_t get_num_frames_written() const;
+    [[nodiscard]] std::uint32_t get_num_frames_dropped() const;
+    // serial number the next written frame gets, valid after flush()
+    [[nodiscard]] std::uint32_t get_next_image_serial_number() const;
+
+private:
+    void run();
+
+    Plotter plotter;
+    FrameBackpressure backpressure;
+
+    struct FrameBuffer {
+        std::vector<Vector2d<double>> positions;
+        // only filled if the plot style needs the masses
+        std::vector<double> weights;
+    };
+
+    std::vector<FrameBuffer> buffers;
+    std::deque<std::size_t> free_buffers;
+    std::deque<std::size_t> queued_buffers;
+
+    mutable std::mutex mutex;
+    std::condition_variable state_changed;
+    bool writing = false;
+    bool stopping = false;
+    std::uint32_t num_frames_written = 0;
+    std::uint32_t num_frames_dropped = 0;
+    std::exception_ptr error;
+
+    std::thread worker;
+};
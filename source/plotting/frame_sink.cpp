@@ -0,0 +1,199 @@
+#include "plotting/frame_sink.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#else
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+
+#include <pthread.h>
+#endif
+
+// Blocks SIGPIPE for the calling thread while data goes into the pipe. A SIGPIPE raised by an exited
+// consumer is discarded before the signal is unblocked again, so the write fails with EPIPE instead
+// of terminating the process. The process wide disposition is left alone, handlers of an embedding
+// program keep working.
+class SigpipeGuard {
+public:
+    SigpipeGuard(){
+#ifndef _WIN32
+        sigemptyset(&sigpipe_set);
+        sigaddset(&sigpipe_set, SIGPIPE);
+        sigset_t pending_set;
+        sigpending(&pending_set);
+        was_pending = sigismember(&pending_set, SIGPIPE) == 1;
+        pthread_sigmask(SIG_BLOCK, &sigpipe_set, &previous_set);
+#endif
+    }
+
+    ~SigpipeGuard(){
+#ifndef _WIN32
+        // a SIGPIPE that was pending before belongs to someone else and is delivered on unblocking
+        if (!was_pending) {
+            const int saved_errno = errno;
+            const timespec no_wait{0, 0};
+            while (sigtimedwait(&sigpipe_set, nullptr, &no_wait) == -1 && errno == EINTR) {
+            }
+            errno = saved_errno;
+        }
+        pthread_sigmask(SIG_SETMASK, &previous_set, nullptr);
+#endif
+    }
+
+    SigpipeGuard(const SigpipeGuard&) = delete;
+    SigpipeGuard& operator=(const SigpipeGuard&) = delete;
+
+private:
+#ifndef _WIN32
+    sigset_t sigpipe_set;
+    sigset_t previous_set;
+    bool was_pending = false;
+#endif
+};
+
+void FrameSink::write_frame(const BitmapImage& image){
+    if (image.get_width() != width || image.get_height() != height) {
+        throw std::invalid_argument("frame size differs from the size of the frame sink");
+    }
+    write_frame_data(image);
+    num_frames++;
+}
+
+void FrameSink::encode_rgb(const BitmapImage& image, std::vector<char>& buffer) const{
+    const std::size_t row_size = 3 * static_cast<std::size_t>(width);
+    buffer.resize(row_size * height);
+    const std::int64_t num_rows = height;
+    // row 0 of the image is the bottom row of the plot
+#pragma omp parallel for if(row_size * height >= (1 << 20))
+    for (std::int64_t y = 0; y < num_rows; y++) {
+        const auto* pixels = image.get_row(static_cast<std::uint32_t>(num_rows - 1 - y));
+        char* row = buffer.data() + y * row_size;
+        for (std::uint32_t x = 0; x < width; x++) {
+            row[3 * x] = static_cast<char>(pixels[x].get_red_channel());
+            row[3 * x + 1] = static_cast<char>(pixels[x].get_green_channel());
+            row[3 * x + 2] = static_cast<char>(pixels[x].get_blue_channel());
+        }
+    }
+}
+
+RawFrameSink::RawFrameSink(const std::filesystem::path& file_path, std::uint32_t arg_width, std::uint32_t arg_height)
+    : FrameSink(arg_width, arg_height), file_writer(file_path, std::ios::binary | std::ios::out | std::ios::trunc){
+    if (!file_writer.is_open()) {
+        throw std::invalid_argument("Could not open frame file " + file_path.string());
+    }
+}
+
+void RawFrameSink::write_frame_data(const BitmapImage& image){
+    encode_rgb(image, frame_buffer);
+    file_writer.write(frame_buffer.data(), frame_buffer.size());
+    if (!file_writer) {
+        throw std::runtime_error("Could not write frame");
+    }
+}
+
+void RawFrameSink::close(){
+    file_writer.close();
+}
+
+Y4mFrameSink::Y4mFrameSink(const std::filesystem::path& file_path, std::uint32_t arg_width, std::uint32_t arg_height, std::uint32_t frames_per_second)
+    : FrameSink(arg_width, arg_height), file_writer(file_path, std::ios::binary | std::ios::out | std::ios::trunc){
+    if (!file_writer.is_open()) {
+        throw std::invalid_argument("Could not open frame file " + file_path.string());
+    }
+    file_writer << "YUV4MPEG2 W" << width << " H" << height << " F" << frames_per_second << ":1 Ip A1:1 C444\n";
+}
+
+void Y4mFrameSink::write_frame_data(const BitmapImage& image){
+    const std::size_t plane_size = static_cast<std::size_t>(width) * height;
+    frame_buffer.resize(3 * plane_size);
+    const std::int64_t num_rows = height;
+#pragma omp parallel for if(plane_size >= (1 << 20))
+    for (std::int64_t y = 0; y < num_rows; y++) {
+        const auto* pixels = image.get_row(static_cast<std::uint32_t>(num_rows - 1 - y));
+        for (std::uint32_t x = 0; x < width; x++) {
+            const int red = pixels[x].get_red_channel();
+            const int green = pixels[x].get_green_channel();
+            const int blue = pixels[x].get_blue_channel();
+            // BT.601 studio range
+            const std::size_t index = y * width + x;
+            frame_buffer[index] = static_cast<char>(((66 * red + 129 * green + 25 * blue + 128) >> 8) + 16);
+            frame_buffer[plane_size + index] = static_cast<char>(((-38 * red - 74 * green + 112 * blue + 128) >> 8) + 128);
+            frame_buffer[2 * plane_size + index] = static_cast<char>(((112 * red - 94 * green - 18 * blue + 128) >> 8) + 128);
+        }
+    }
+    file_writer << "FRAME\n";
+    file_writer.write(frame_buffer.data(), frame_buffer.size());
+    if (!file_writer) {
+        throw std::runtime_error("Could not write frame");
+    }
+}
+
+void Y4mFrameSink::close(){
+    file_writer.close();
+}
+
+PipeFrameSink::PipeFrameSink(const std::string& command, std::uint32_t arg_width, std::uint32_t arg_height)
+    : FrameSink(arg_width, arg_height), pipe_command(command){
+    pipe = popen(pipe_command.c_str(), "w");
+    if (pipe == nullptr) {
+        throw std::invalid_argument("Could not start frame consumer: " + pipe_command);
+    }
+}
+
+PipeFrameSink::~PipeFrameSink(){
+    if (pipe != nullptr) {
+        // pclose flushes the buffered rest of the stream
+        SigpipeGuard guard;
+        pclose(pipe);
+    }
+}
+
+void PipeFrameSink::write_frame_data(const BitmapImage& image){
+    if (pipe == nullptr) {
+        throw std::invalid_argument("frame consumer already closed");
+    }
+    encode_rgb(image, frame_buffer);
+    SigpipeGuard guard;
+    if (std::fwrite(frame_buffer.data(), 1, frame_buffer.size(), pipe) != frame_buffer.size()) {
+        throw std::runtime_error("Frame consumer stopped reading: " + pipe_command);
+    }
+}
+
+void PipeFrameSink::close(){
+    if (pipe == nullptr) {
+        return;
+    }
+    int status;
+    {
+        SigpipeGuard guard;
+        status = pclose(pipe);
+    }
+    pipe = nullptr;
+    if (status != 0) {
+        throw std::runtime_error("Frame consumer failed: " + pipe_command);
+    }
+}
+
+FrameSinkType get_frame_sink_type(std::uint32_t sink_id){
+    switch (sink_id) {
+        case 0:
+            return FrameSinkType::bitmap_files;
+        case 1:
+            return FrameSinkType::raw;
+        case 2:
+            return FrameSinkType::y4m;
+        case 3:
+            return FrameSinkType::pipe;
+        default:
+            throw std::invalid_argument("unknown frame sink: " + std::to_string(sink_id));
+    }
+}
+
+std::string get_default_encoder_command(const std::filesystem::path& video_path, std::uint32_t width, std::uint32_t height, std::uint32_t frames_per_second){
+    return "ffmpeg -loglevel error -y -f rawvideo -pix_fmt rgb24 -s " + std::to_string(width) + "x" + std::to_string(height)
+        + " -r " + std::to_string(frames_per_second) + " -i - -pix_fmt yuv420p \"" + video_path.string() + "\"";
+}
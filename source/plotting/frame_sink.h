@@ -0,0 +1,95 @@
+#pragma once
+
+#include "image/bitmap_image.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Destination of the frames of a Plotter. Without a sink every frame is written as separate bitmap
+// file; the sinks below write all frames of a run into one stream instead. Frames are passed top
+// row first, as they are displayed.
+class FrameSink {
+public:
+    FrameSink(std::uint32_t arg_width, std::uint32_t arg_height) : width(arg_width), height(arg_height){}
+    virtual ~FrameSink() = default;
+
+    // appends the image as next frame, all frames must have the size of the sink
+    void write_frame(const BitmapImage& image);
+    // finishes the stream, no frames can be written afterwards
+    virtual void close(){}
+
+    [[nodiscard]] std::uint32_t get_num_frames() const{
+        return num_frames;
+    }
+
+protected:
+    virtual void write_frame_data(const BitmapImage& image) = 0;
+
+    // packed rgb24 rows, top row first
+    void encode_rgb(const BitmapImage& image, std::vector<char>& buffer) const;
+
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t num_frames = 0;
+    std::vector<char> frame_buffer;
+};
+
+// raw rgb24 frames back to back, e.g. for ffmpeg -f rawvideo -pix_fmt rgb24
+class RawFrameSink : public FrameSink {
+public:
+    RawFrameSink(const std::filesystem::path& file_path, std::uint32_t arg_width, std::uint32_t arg_height);
+    void close() override;
+
+protected:
+    void write_frame_data(const BitmapImage& image) override;
+
+private:
+    std::ofstream file_writer;
+};
+
+// YUV4MPEG2 stream with full chroma resolution (C444), playable and encodable without further options
+class Y4mFrameSink : public FrameSink {
+public:
+    Y4mFrameSink(const std::filesystem::path& file_path, std::uint32_t arg_width, std::uint32_t arg_height, std::uint32_t frames_per_second);
+    void close() override;
+
+protected:
+    void write_frame_data(const BitmapImage& image) override;
+
+private:
+    std::ofstream file_writer;
+};
+
+// Streams raw rgb24 frames to the standard input of a child process, e.g. a video encoder. SIGPIPE
+// is blocked for the writing thread during writes, a consumer that exits early makes the write throw.
+class PipeFrameSink : public FrameSink {
+public:
+    PipeFrameSink(const std::string& command, std::uint32_t arg_width, std::uint32_t arg_height);
+    ~PipeFrameSink() override;
+    // waits for the child process, throws if it failed
+    void close() override;
+
+protected:
+    void write_frame_data(const BitmapImage& image) override;
+
+private:
+    std::string pipe_command;
+    std::FILE* pipe = nullptr;
+};
+
+enum class FrameSinkType : std::uint8_t {
+    bitmap_files,
+    raw,
+    y4m,
+    pipe
+};
+
+[[nodiscard]] FrameSinkType get_frame_sink_type(std::uint32_t sink_id);
+
+// ffmpeg command encoding the raw frames of a PipeFrameSink into an mp4 file
+[[nodiscard]] std::string get_default_encoder_command(const std::filesystem::path& video_path, std::uint32_t width, std::uint32_t height, std::uint32_t frames_per_second);
@@ -1,5 +1,7 @@
 #include "plotting/plotter.h"
 #include "io/image_parser.h"
+#include "plotting/frame_pipeline.h"
+#include "plotting/frame_sink.h"
 
 #include <exception>
 
@@ -28,14 +30,21 @@ void Plotter::highlight_position(Vector2d<double> position, std::uint8_t red, st
 }
 
 void Plotter::write_and_clear(){
+    if(frame_sink){
+        frame_sink->write_frame(image);
+        clear_image();
+        image_serial_number += 1;
+        return;
+    }
+
     // create plot serial number string
     std::string serial_number_string = std::to_string(image_serial_number);
     while(serial_number_string.length() < 9){
         serial_number_string = "0" + serial_number_string;
     }
 
-    std::string file_name = filename_prefix + "_" + serial_number_string + ".bmp";
-    ImageParser::write_bitmap(output_folder_path / file_name, image);
+    std::string file_name = filename_prefix + "_" + serial_number_string + ImageParser::get_file_extension(image_format);
+    ImageParser::write_image(output_folder_path / file_name, image, image_format);
     clear_image();
     image_serial_number += 1;
 }
@@ -63,3 +72,44 @@ void Plotter::mark_pixel(std::uint32_t x, std::uint32_t y, std::uint8_t red, std
     Pixel<std::uint8_t> pixel = Pixel<std::uint8_t>(red, green, blue);
     image.set_pixel(y, x, pixel);
 }
+
+void Plotter::plot_frame(Universe& universe, QuadtreeNode* tree_root){
+    if(plot_style != PlotStyle::level_of_detail){
+        tree_root = nullptr;
+    }
+    if(frame_pipeline){
+        frame_pipeline->submit(universe, tree_root);
+        return;
+    }
+    if(tree_root != nullptr){
+        get_level_of_detail_points(tree_root, level_of_detail_positions, level_of_detail_weights);
+        add_positions_to_image(level_of_detail_positions.data(), level_of_detail_weights.data(), level_of_detail_positions.size());
+    }
+    else{
+        add_bodies_to_image(universe);
+    }
+    write_and_clear();
+}
+
+void Plotter::enable_async_frames(std::size_t num_buffers, FrameBackpressure backpressure){
+    flush_frames();
+    frame_pipeline.reset();
+    // the pipeline plots with a copy of this plotter, frames continue the serial numbers
+    frame_pipeline = std::make_shared<AsyncFramePipeline>(*this, num_buffers, backpressure);
+}
+
+void Plotter::flush_frames(){
+    if(!frame_pipeline){
+        return;
+    }
+    frame_pipeline->flush();
+    image_serial_number = frame_pipeline->get_next_image_serial_number();
+}
+
+std::uint32_t Plotter::get_num_dropped_frames() const{
+    return frame_pipeline ? frame_pipeline->get_num_frames_dropped() : 0;
+}
+
+BitmapImage::BitmapPixel Plotter::get_pixel(std::uint32_t x, std::uint32_t y){
+    return image.get_pixel(y, x);
+}
@@ -5,17 +5,49 @@
 #include "quadtree/quadtreeNode.h"
 #include "quadtree/quadtree.h"
 #include "structures/universe.h"
+#include "plotting/density_renderer.h"
+#include "io/image_parser.h"
 #include <cstdint>
-#include <set>
+#include <memory>
+#include <utility>
+
+class AsyncFramePipeline;
+class FrameSink;
+enum class FrameBackpressure : std::uint8_t;
 
 class Plotter{
 public:
-    Plotter(BoundingBox bb, const std::filesystem::path & arg_output_folder_path, std::uint32_t plot_width_arg, std::uint32_t plot_height_arg): plot_bounding_box(bb), output_folder_path(arg_output_folder_path), plot_width(plot_width_arg), plot_height(plot_height_arg), image(BitmapImage(plot_height_arg, plot_width_arg)), image_serial_number(0){
+    Plotter(BoundingBox bb, const std::filesystem::path & arg_output_folder_path, std::uint32_t plot_width_arg, std::uint32_t plot_height_arg): plot_bounding_box(bb), output_folder_path(arg_output_folder_path), plot_width(plot_width_arg), plot_height(plot_height_arg), image(BitmapImage(plot_height_arg, plot_width_arg)), density_renderer(plot_width_arg, plot_height_arg), image_serial_number(0){
         // set default filename prefix
         filename_prefix = "plot";
     }
 
     void add_bodies_to_image(Universe& universe);
+    // weights are only read by PlotStyle::mass and may be null otherwise
+    void add_positions_to_image(const Vector2d<double>* positions, const double* weights, std::size_t num_positions);
+
+    void set_plot_style(PlotStyle style){
+        plot_style = style;
+    }
+
+    [[nodiscard]] PlotStyle get_plot_style() const{
+        return plot_style;
+    }
+
+    // plots the bodies as next frame, in the background if async frames are enabled. PlotStyle::level_of_detail
+    // draws the aggregated tree instead of the bodies if one is given
+    void plot_frame(Universe& universe, QuadtreeNode* tree_root = nullptr);
+    // centers of mass and masses of the nodes at which the tree gets smaller than a pixel, and of the leaves above
+    void get_level_of_detail_points(QuadtreeNode* tree_root, std::vector<Vector2d<double>>& positions, std::vector<double>& weights) const;
+    // true if the plot style reads the masses of the bodies
+    [[nodiscard]] bool needs_weights() const{
+        return plot_style == PlotStyle::mass || plot_style == PlotStyle::level_of_detail;
+    }
+    // hands rasterizing and writing of plot_frame() to a background thread with num_buffers frame buffers
+    void enable_async_frames(std::size_t num_buffers, FrameBackpressure backpressure);
+    // waits for all frames of plot_frame(), afterwards the plotter can be used directly again
+    void flush_frames();
+    std::uint32_t get_num_dropped_frames() const;
     void highlight_position(Vector2d<double> position, std::uint8_t red, std::uint8_t green, std::uint8_t blue);
     
     void set_plot_bounding_box(BoundingBox bb){
@@ -25,24 +57,34 @@ public:
     void write_and_clear();
     
     void clear_image(){
-        image = BitmapImage(plot_height, plot_width);
+        image.clear();
     }
 
     void set_filename_prefix(std::string prefix){
         filename_prefix = prefix;
     }
 
+    void set_image_format(ImageFormat format){
+        image_format = format;
+    }
+
+    // write_and_clear() appends the frames to the sink instead of writing bitmap files, copies of the plotter share the sink
+    void set_frame_sink(std::shared_ptr<FrameSink> sink){
+        frame_sink = std::move(sink);
+    }
+
     void add_quadtree_to_bitmap(Quadtree& quadtree);
     void add_quadtreenode_to_bitmap(QuadtreeNode* qtn, std::uint8_t red, std::uint8_t green, std::uint8_t blue);
 
-    std::set<std::tuple<std::uint32_t, std::uint32_t>> get_bounding_box_pixels(std::vector<BoundingBox>& bounding_boxes);
+    // draws the border of the box, clipped to the plot
+    void add_bounding_box_to_bitmap(const BoundingBox& bb, BitmapImage::BitmapPixel pixel);
 
     void mark_position(Vector2d<double> position, std::uint8_t red, std::uint8_t green, std::uint8_t blue);
     void mark_pixel(std::uint32_t x, std::uint32_t y, std::uint8_t red, std::uint8_t green, std::uint8_t blue);
 
     BitmapImage::BitmapPixel get_pixel(std::uint32_t x, std::uint32_t y);
 
-    std::uint32_t get_next_image_serial_number(){
+    std::uint32_t get_next_image_serial_number() const{
         return image_serial_number;
     }
 
@@ -50,7 +92,14 @@ private:
     std::string filename_prefix;
     std::uint32_t image_serial_number;
     BitmapImage image;
+    PlotStyle plot_style = PlotStyle::points;
+    ImageFormat image_format = ImageFormat::bmp;
+    DensityRenderer density_renderer;
     BoundingBox plot_bounding_box;
     std::uint32_t plot_width, plot_height;
     std::filesystem::path output_folder_path;
+    std::shared_ptr<AsyncFramePipeline> frame_pipeline;
+    std::shared_ptr<FrameSink> frame_sink;
+    std::vector<Vector2d<double>> level_of_detail_positions;
+    std::vector<double> level_of_detail_weights;
 };
\ No newline at end of file
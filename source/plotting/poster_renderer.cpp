@@ -0,0 +1,276 @@
+#include "plotting/poster_renderer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct PosterLayout {
+    std::uint32_t num_levels;
+    std::uint32_t tile_size;
+    std::vector<std::uint32_t> level_widths;
+    std::vector<std::uint32_t> level_heights;
+
+    [[nodiscard]] std::uint32_t get_num_tiles_x(std::uint32_t level) const{
+        return (level_widths[level] + tile_size - 1) / tile_size;
+    }
+
+    [[nodiscard]] std::uint32_t get_num_tiles_y(std::uint32_t level) const{
+        return (level_heights[level] + tile_size - 1) / tile_size;
+    }
+};
+
+// state shared by all tile tasks of one render call
+struct PosterJob {
+    PosterJob(const PosterLayout& arg_layout, const PosterOptions& arg_options, const std::filesystem::path& arg_output_folder, const DensityRenderer& arg_colors, const double* arg_weights)
+        : layout(arg_layout), options(arg_options), output_folder(arg_output_folder), colors(arg_colors), weights(arg_weights){
+    }
+
+    const PosterLayout& layout;
+    const PosterOptions& options;
+    const std::filesystem::path& output_folder;
+    const DensityRenderer& colors;
+    // body indices sorted by finest level tile and their pixel within the poster, top row is 0
+    std::vector<std::uint32_t> tile_offsets;
+    std::vector<std::uint32_t> sorted_bodies;
+    std::vector<std::uint32_t> pixel_x;
+    std::vector<std::uint32_t> pixel_y;
+    const double* weights;
+    double min_value = 0;
+    double max_value = 0;
+    std::atomic<std::uint64_t> num_tiles_written{0};
+};
+
+// pixel of a tile counted from its top row, bitmaps store the bottom row first
+BitmapImage::BitmapPixel& get_tile_pixel(BitmapImage& tile, std::uint32_t x, std::uint32_t y_from_top){
+    return tile.get_row(tile.get_height() - 1 - y_from_top)[x];
+}
+
+std::uint32_t get_tile_extent(std::uint32_t level_extent, std::uint32_t tile_index, std::uint32_t tile_size){
+    return std::min(tile_size, level_extent - tile_index * tile_size);
+}
+
+// density of the bodies of a finest level tile, one value per pixel, top row first
+void accumulate_tile(const PosterJob& job, std::uint32_t tile_id, std::uint32_t origin_x, std::uint32_t origin_y, std::uint32_t tile_width, std::vector<double>& values){
+    const bool use_weights = job.options.style == PlotStyle::mass || job.options.style == PlotStyle::level_of_detail;
+    for (std::uint32_t sorted = job.tile_offsets[tile_id]; sorted < job.tile_offsets[tile_id + 1]; sorted++) {
+        const std::uint32_t body = job.sorted_bodies[sorted];
+        const std::size_t index = static_cast<std::size_t>(job.pixel_y[body] - origin_y) * tile_width + (job.pixel_x[body] - origin_x);
+        values[index] += use_weights ? job.weights[body] : 1.0;
+    }
+}
+
+std::unique_ptr<BitmapImage> render_finest_tile(const PosterJob& job, std::uint32_t tile_x, std::uint32_t tile_y){
+    const PosterLayout& layout = job.layout;
+    const std::uint32_t level = layout.num_levels - 1;
+    const std::uint32_t tile_id = tile_y * layout.get_num_tiles_x(level) + tile_x;
+    if (job.tile_offsets[tile_id] == job.tile_offsets[tile_id + 1]) {
+        return nullptr;
+    }
+    const std::uint32_t tile_width = get_tile_extent(layout.level_widths[level], tile_x, layout.tile_size);
+    const std::uint32_t tile_height = get_tile_extent(layout.level_heights[level], tile_y, layout.tile_size);
+    const std::uint32_t origin_x = tile_x * layout.tile_size;
+    const std::uint32_t origin_y = tile_y * layout.tile_size;
+    auto tile = std::make_unique<BitmapImage>(tile_height, tile_width);
+
+    if (job.options.style == PlotStyle::points) {
+        for (std::uint32_t sorted = job.tile_offsets[tile_id]; sorted < job.tile_offsets[tile_id + 1]; sorted++) {
+            const std::uint32_t body = job.sorted_bodies[sorted];
+            get_tile_pixel(*tile, job.pixel_x[body] - origin_x, job.pixel_y[body] - origin_y) = BitmapImage::BitmapPixel(255, 255, 255);
+        }
+        return tile;
+    }
+
+    std::vector<double> values(static_cast<std::size_t>(tile_width) * tile_height, 0.0);
+    accumulate_tile(job, tile_id, origin_x, origin_y, tile_width, values);
+    for (std::uint32_t y = 0; y < tile_height; y++) {
+        for (std::uint32_t x = 0; x < tile_width; x++) {
+            const double value = values[static_cast<std::size_t>(y) * tile_width + x];
+            if (value > 0) {
+                get_tile_pixel(*tile, x, y) = job.colors.get_color(value, job.min_value, job.max_value);
+            }
+        }
+    }
+    return tile;
+}
+
+// every channel keeps the brightest of the four pixels, single bodies stay visible on coarse levels
+std::unique_ptr<BitmapImage> downsample_children(const PosterJob& job, std::uint32_t level, std::uint32_t tile_x, std::uint32_t tile_y, std::array<std::unique_ptr<BitmapImage>, 4>& children){
+    const PosterLayout& layout = job.layout;
+    const std::uint32_t tile_width = get_tile_extent(layout.level_widths[level], tile_x, layout.tile_size);
+    const std::uint32_t tile_height = get_tile_extent(layout.level_heights[level], tile_y, layout.tile_size);
+    auto tile = std::make_unique<BitmapImage>(tile_height, tile_width);
+    const std::uint32_t half = layout.tile_size / 2;
+
+    for (std::uint32_t child = 0; child < 4; child++) {
+        if (!children[child]) {
+            continue;
+        }
+        BitmapImage& child_tile = *children[child];
+        const std::uint32_t offset_x = (child % 2) * half;
+        const std::uint32_t offset_y = (child / 2) * half;
+        for (std::uint32_t y = 0; y < child_tile.get_height(); y++) {
+            for (std::uint32_t x = 0; x < child_tile.get_width(); x++) {
+                const BitmapImage::BitmapPixel child_pixel = get_tile_pixel(child_tile, x, y);
+                BitmapImage::BitmapPixel& pixel = get_tile_pixel(*tile, offset_x + x / 2, offset_y + y / 2);
+                pixel = BitmapImage::BitmapPixel(
+                    std::max(pixel.get_red_channel(), child_pixel.get_red_channel()),
+                    std::max(pixel.get_green_channel(), child_pixel.get_green_channel()),
+                    std::max(pixel.get_blue_channel(), child_pixel.get_blue_channel()));
+            }
+        }
+    }
+    return tile;
+}
+
+std::unique_ptr<BitmapImage> render_tile(PosterJob& job, std::uint32_t level, std::uint32_t tile_x, std::uint32_t tile_y){
+    const PosterLayout& layout = job.layout;
+    std::unique_ptr<BitmapImage> tile;
+    if (level + 1 == layout.num_levels) {
+        tile = render_finest_tile(job, tile_x, tile_y);
+    } else {
+        std::array<std::unique_ptr<BitmapImage>, 4> children;
+        bool has_children = false;
+        for (std::uint32_t child = 0; child < 4; child++) {
+            const std::uint32_t child_x = 2 * tile_x + child % 2;
+            const std::uint32_t child_y = 2 * tile_y + child / 2;
+            if (child_x >= layout.get_num_tiles_x(level + 1) || child_y >= layout.get_num_tiles_y(level + 1)) {
+                continue;
+            }
+#pragma omp task default(shared) firstprivate(child, child_x, child_y)
+            children[child] = render_tile(job, level + 1, child_x, child_y);
+        }
+#pragma omp taskwait
+        for (auto& child : children) {
+            has_children = has_children || child != nullptr;
+        }
+        if (has_children) {
+            tile = downsample_children(job, level, tile_x, tile_y, children);
+        }
+    }
+
+    if (tile) {
+        const auto file_name = std::to_string(tile_x) + "_" + std::to_string(tile_y) + ImageParser::get_file_extension(job.options.format);
+        ImageParser::write_image(job.output_folder / std::to_string(level) / file_name, *tile, job.options.format);
+        job.num_tiles_written++;
+    }
+    return tile;
+}
+
+}
+
+PosterStatistics PosterRenderer::render(Universe& universe, const BoundingBox& bounding_box, const std::filesystem::path& output_folder, const PosterOptions& options){
+    if (options.width == 0 || options.height == 0 || options.tile_size < 2 || options.tile_size % 2 != 0 || options.tile_size > 8192) {
+        throw std::invalid_argument("invalid poster size or tile size");
+    }
+
+    PosterLayout layout;
+    layout.tile_size = options.tile_size;
+    layout.num_levels = 1;
+    while (((std::max(options.width, options.height) - 1) >> (layout.num_levels - 1)) + 1 > options.tile_size) {
+        layout.num_levels++;
+    }
+    layout.level_widths.resize(layout.num_levels);
+    layout.level_heights.resize(layout.num_levels);
+    for (std::uint32_t level = 0; level < layout.num_levels; level++) {
+        const std::uint32_t shift = layout.num_levels - 1 - level;
+        layout.level_widths[level] = ((options.width - 1) >> shift) + 1;
+        layout.level_heights[level] = ((options.height - 1) >> shift) + 1;
+    }
+    for (std::uint32_t level = 0; level < layout.num_levels; level++) {
+        std::filesystem::create_directories(output_folder / std::to_string(level));
+    }
+
+    DensityRenderer colors(1, 1);
+    PosterJob job(layout, options, output_folder, colors, universe.weights.data());
+
+    // pixel and finest level tile of every body, the same rounding as Plotter::mark_position
+    const std::uint32_t finest_level = layout.num_levels - 1;
+    const std::uint32_t num_tiles_x = layout.get_num_tiles_x(finest_level);
+    const std::uint32_t num_tiles = num_tiles_x * layout.get_num_tiles_y(finest_level);
+    const std::int64_t num_bodies = universe.num_bodies;
+    job.pixel_x.resize(num_bodies);
+    job.pixel_y.resize(num_bodies);
+    std::vector<std::uint32_t> body_tiles(num_bodies);
+#pragma omp parallel for
+    for (std::int64_t i = 0; i < num_bodies; i++) {
+        const double x = universe.positions[i][0];
+        const double y = universe.positions[i][1];
+        if (!(bounding_box.x_min <= x && x <= bounding_box.x_max && bounding_box.y_min <= y && y <= bounding_box.y_max)) {
+            body_tiles[i] = num_tiles;
+            continue;
+        }
+        job.pixel_x[i] = static_cast<std::uint32_t>(((x - bounding_box.x_min) / (bounding_box.x_max - bounding_box.x_min)) * (options.width - 1));
+        job.pixel_y[i] = options.height - 1 - static_cast<std::uint32_t>(((y - bounding_box.y_min) / (bounding_box.y_max - bounding_box.y_min)) * (options.height - 1));
+        body_tiles[i] = (job.pixel_y[i] / options.tile_size) * num_tiles_x + job.pixel_x[i] / options.tile_size;
+    }
+
+    // counting sort of the bodies by tile, bodies outside the poster land behind the last tile
+    job.tile_offsets.assign(num_tiles + 2, 0);
+    for (std::int64_t i = 0; i < num_bodies; i++) {
+        job.tile_offsets[body_tiles[i] + 1]++;
+    }
+    for (std::uint32_t tile = 0; tile <= num_tiles; tile++) {
+        job.tile_offsets[tile + 1] += job.tile_offsets[tile];
+    }
+    job.sorted_bodies.resize(num_bodies);
+    std::vector<std::uint32_t> insert_positions(job.tile_offsets.begin(), job.tile_offsets.end() - 1);
+    for (std::int64_t i = 0; i < num_bodies; i++) {
+        job.sorted_bodies[insert_positions[body_tiles[i]]++] = static_cast<std::uint32_t>(i);
+    }
+
+    // the log scale has to be the same for all tiles
+    if (options.style != PlotStyle::points) {
+        double min_value = std::numeric_limits<double>::max();
+        double max_value = 0;
+#pragma omp parallel
+        {
+            std::vector<double> values;
+#pragma omp for schedule(dynamic) reduction(min:min_value) reduction(max:max_value)
+            for (std::int64_t tile = 0; tile < num_tiles; tile++) {
+                if (job.tile_offsets[tile] == job.tile_offsets[tile + 1]) {
+                    continue;
+                }
+                const std::uint32_t tile_x = tile % num_tiles_x;
+                const std::uint32_t tile_y = tile / num_tiles_x;
+                const std::uint32_t tile_width = get_tile_extent(options.width, tile_x, options.tile_size);
+                const std::uint32_t tile_height = get_tile_extent(options.height, tile_y, options.tile_size);
+                values.assign(static_cast<std::size_t>(tile_width) * tile_height, 0.0);
+                accumulate_tile(job, tile, tile_x * options.tile_size, tile_y * options.tile_size, tile_width, values);
+                for (double value : values) {
+                    if (value > 0) {
+                        min_value = std::min(min_value, value);
+                        max_value = std::max(max_value, value);
+                    }
+                }
+            }
+        }
+        job.min_value = min_value;
+        job.max_value = max_value;
+    }
+
+#pragma omp parallel
+#pragma omp single
+    render_tile(job, 0, 0, 0);
+
+    auto manifest = std::ofstream{output_folder / "poster.json"};
+    manifest << "{\n";
+    manifest << "  \"width\": " << options.width << ",\n";
+    manifest << "  \"height\": " << options.height << ",\n";
+    manifest << "  \"tile_size\": " << options.tile_size << ",\n";
+    manifest << "  \"levels\": " << layout.num_levels << ",\n";
+    manifest << "  \"tile_path\": \"{level}/{column}_{row}" << ImageParser::get_file_extension(options.format) << "\"\n";
+    manifest << "}\n";
+
+    PosterStatistics statistics;
+    statistics.num_levels = layout.num_levels;
+    statistics.num_tiles_written = job.num_tiles_written;
+    return statistics;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "io/image_parser.h"
+#include "plotting/density_renderer.h"
+#include "structures/bounding_box.h"
+#include "structures/universe.h"
+
+#include <cstdint>
+#include <filesystem>
+
+struct PosterOptions {
+    std::uint32_t width = 32768;
+    std::uint32_t height = 32768;
+    // edge length of the square tiles, has to be even
+    std::uint32_t tile_size = 256;
+    PlotStyle style = PlotStyle::density;
+    ImageFormat format = ImageFormat::png;
+};
+
+struct PosterStatistics {
+    // level 0 is a single tile holding the whole poster, every further level doubles the resolution
+    std::uint32_t num_levels = 0;
+    std::uint64_t num_tiles_written = 0;
+};
+
+// Renders a poster of arbitrary size as pyramid of tiles, <output_folder>/<level>/<column>_<row>.<ext>,
+// with a poster.json that describes the layout for a tile viewer. Only the tiles of the finest level
+// are rendered from the bodies, the coarser levels are downsampled from their four children. The
+// pyramid is built depth first with OpenMP tasks, so only the tiles on the current paths of the
+// threads are in memory, never the whole poster. Tiles without any body are not written.
+class PosterRenderer {
+public:
+    static PosterStatistics render(Universe& universe, const BoundingBox& bounding_box, const std::filesystem::path& output_folder, const PosterOptions& options);
+};
@@ -1,24 +1,65 @@
 #include "plotting/plotter.h"
 
+#include <vector>
 
 void Plotter::add_quadtree_to_bitmap(Quadtree& quadtree){
-    // fill bitmap with quadtree bounding boxes
-    std::vector<BoundingBox> bounding_boxes = quadtree.get_bounding_boxes(quadtree.root);
-    std::set<std::tuple<std::uint32_t, std::uint32_t>> bounding_box_pixels = get_bounding_box_pixels(bounding_boxes);
-    for(auto pixel_pair : bounding_box_pixels){
-        Pixel<std::uint8_t> green_pixel = Pixel<std::uint8_t>(0, 255, 0); 
-        image.set_pixel(std::get<1>(pixel_pair), std::get<0>(pixel_pair), green_pixel);
+    if(quadtree.root == nullptr){
+        return;
     }
+    // fill bitmap with quadtree bounding boxes
+    Pixel<std::uint8_t> green_pixel = Pixel<std::uint8_t>(0, 255, 0);
+    const double pixel_width = (plot_bounding_box.x_max - plot_bounding_box.x_min) / plot_width;
+    const double pixel_height = (plot_bounding_box.y_max - plot_bounding_box.y_min) / plot_height;
+
+    std::vector<QuadtreeNode*> stack{quadtree.root};
+    while(!stack.empty()){
+        QuadtreeNode* node = stack.back();
+        stack.pop_back();
+        const BoundingBox& bb = node->bounding_box;
+        add_bounding_box_to_bitmap(bb, green_pixel);
 
+        // children of a box below one pixel only redraw its pixels, boxes outside the plot contain no visible children
+        const bool below_pixel = (bb.x_max - bb.x_min) < pixel_width && (bb.y_max - bb.y_min) < pixel_height;
+        const bool outside = bb.x_max < plot_bounding_box.x_min || bb.x_min > plot_bounding_box.x_max || bb.y_max < plot_bounding_box.y_min || bb.y_min > plot_bounding_box.y_max;
+        if(below_pixel || outside){
+            continue;
+        }
+        for(auto child: node->children){
+            stack.push_back(child);
+        }
+    }
 }
 
 void Plotter::add_quadtreenode_to_bitmap(QuadtreeNode* qtn, std::uint8_t red, std::uint8_t green, std::uint8_t blue){
-    // fill bitmap with quadtree bounding boxes
-    std::vector<BoundingBox> bounding_boxes;
-    bounding_boxes.push_back(qtn->bounding_box);
-    std::set<std::tuple<std::uint32_t, std::uint32_t>> bounding_box_pixels = get_bounding_box_pixels(bounding_boxes);
-    for(auto pixel_pair : bounding_box_pixels){
-        Pixel<std::uint8_t> green_pixel = Pixel<std::uint8_t>(red, green, blue); 
-        image.set_pixel(std::get<1>(pixel_pair), std::get<0>(pixel_pair), green_pixel);
+    add_bounding_box_to_bitmap(qtn->bounding_box, Pixel<std::uint8_t>(red, green, blue));
+}
+
+void Plotter::get_level_of_detail_points(QuadtreeNode* tree_root, std::vector<Vector2d<double>>& positions, std::vector<double>& weights) const{
+    positions.clear();
+    weights.clear();
+    if(tree_root == nullptr){
+        return;
+    }
+    const double pixel_width = (plot_bounding_box.x_max - plot_bounding_box.x_min) / plot_width;
+    const double pixel_height = (plot_bounding_box.y_max - plot_bounding_box.y_min) / plot_height;
+
+    std::vector<QuadtreeNode*> stack{tree_root};
+    while(!stack.empty()){
+        QuadtreeNode* node = stack.back();
+        stack.pop_back();
+        const BoundingBox& bb = node->bounding_box;
+        if(node->cumulative_mass <= 0 || bb.x_max < plot_bounding_box.x_min || bb.x_min > plot_bounding_box.x_max || bb.y_max < plot_bounding_box.y_min || bb.y_min > plot_bounding_box.y_max){
+            continue;
+        }
+        // the whole subtree falls onto at most a few pixels, its center of mass stands in for all bodies
+        const bool below_pixel = (bb.x_max - bb.x_min) < pixel_width && (bb.y_max - bb.y_min) < pixel_height;
+        if(below_pixel || node->children.empty()){
+            positions.push_back(node->center_of_mass);
+            weights.push_back(node->cumulative_mass);
+            continue;
+        }
+        for(auto child: node->children){
+            stack.push_back(child);
+        }
     }
 }
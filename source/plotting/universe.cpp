@@ -3,9 +3,19 @@
 void Plotter::add_bodies_to_image(Universe& universe){
     // fill bitmap
 
-    for(auto position : universe.positions){
-        double position_x = position[0];
-        double position_y = position[1];
+    add_positions_to_image(universe.positions.data(), universe.weights.data(), universe.num_bodies);
+}
+
+void Plotter::add_positions_to_image(const Vector2d<double>* positions, const double* weights, std::size_t num_positions){
+    if(plot_style != PlotStyle::points){
+        density_renderer.clear();
+        density_renderer.accumulate(plot_bounding_box, positions, needs_weights() ? weights : nullptr, num_positions);
+        density_renderer.tone_map(image);
+        return;
+    }
+
+    for(std::size_t body_idx = 0; body_idx < num_positions; body_idx++){
+        const Vector2d<double>& position = positions[body_idx];
 
         if(!plot_bounding_box.contains(position)){
             // body not within the plotted box
@@ -0,0 +1,260 @@
+#include "profiling/hardware_counters.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <omp.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* get_hardware_event_name(HardwareEvent event){
+    switch (event) {
+        case HardwareEvent::cycles:
+            return "cycles";
+        case HardwareEvent::instructions:
+            return "instructions";
+        case HardwareEvent::llc_references:
+            return "llc_references";
+        case HardwareEvent::llc_misses:
+            return "llc_misses";
+        case HardwareEvent::raw:
+            return "raw";
+    }
+    return "unknown";
+}
+
+namespace {
+
+#ifdef __linux__
+// all counters of one thread in a single perf group, so they are scheduled together and one read returns all of them
+class PerfEventGroup {
+public:
+    PerfEventGroup(std::uint64_t raw_event){
+        for (std::size_t event = 0; event < num_hardware_events; event++) {
+            perf_event_attr attributes{};
+            attributes.size = sizeof(perf_event_attr);
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            switch (static_cast<HardwareEvent>(event)) {
+                case HardwareEvent::cycles:
+                    attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+                    break;
+                case HardwareEvent::instructions:
+                    attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+                    break;
+                case HardwareEvent::llc_references:
+                    attributes.config = PERF_COUNT_HW_CACHE_REFERENCES;
+                    break;
+                case HardwareEvent::llc_misses:
+                    attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+                    break;
+                case HardwareEvent::raw:
+                    if (raw_event == 0) {
+                        continue;
+                    }
+                    attributes.type = PERF_TYPE_RAW;
+                    attributes.config = raw_event;
+                    break;
+            }
+
+            // counting only, this thread on any cpu
+            const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, leader_fd, 0));
+            if (fd < 0) {
+                if (leader_fd < 0 && error.empty()) {
+                    error = std::string("perf_event_open(") + get_hardware_event_name(static_cast<HardwareEvent>(event)) + "): " + std::strerror(errno);
+                }
+                continue;
+            }
+            std::uint64_t id = 0;
+            ioctl(fd, PERF_EVENT_IOC_ID, &id);
+            if (leader_fd < 0) {
+                leader_fd = fd;
+            }
+            fds.push_back(fd);
+            ids.push_back(id);
+            events.push_back(static_cast<HardwareEvent>(event));
+        }
+    }
+
+    ~PerfEventGroup(){
+        for (int fd : fds) {
+            close(fd);
+        }
+    }
+
+    PerfEventGroup(const PerfEventGroup&) = delete;
+    PerfEventGroup& operator=(const PerfEventGroup&) = delete;
+
+    [[nodiscard]] bool is_open() const{
+        return leader_fd >= 0;
+    }
+
+    [[nodiscard]] const std::string& get_error() const{
+        return error;
+    }
+
+    bool read_counts(HardwareCounts& counts) const{
+        counts = HardwareCounts{};
+        if (!is_open()) {
+            return false;
+        }
+        // nr, time_enabled, time_running, then value and id of every event
+        std::array<std::uint64_t, 3 + 2 * num_hardware_events> buffer{};
+        if (read(leader_fd, buffer.data(), sizeof(buffer)) <= 0) {
+            return false;
+        }
+        const std::uint64_t num_values = buffer[0];
+        const std::uint64_t time_enabled = buffer[1];
+        const std::uint64_t time_running = buffer[2];
+        // extrapolate if the kernel had to multiplex the counters
+        const double scale = time_running > 0 ? static_cast<double>(time_enabled) / time_running : 1.0;
+        for (std::uint64_t value_index = 0; value_index < num_values && value_index < ids.size(); value_index++) {
+            const std::uint64_t value = buffer[3 + 2 * value_index];
+            const std::uint64_t id = buffer[4 + 2 * value_index];
+            for (std::size_t event_index = 0; event_index < ids.size(); event_index++) {
+                if (ids[event_index] == id) {
+                    const auto event = static_cast<std::size_t>(events[event_index]);
+                    counts.values[event] = static_cast<std::uint64_t>(value * scale);
+                    counts.available[event] = true;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    int leader_fd = -1;
+    std::vector<int> fds;
+    std::vector<std::uint64_t> ids;
+    std::vector<HardwareEvent> events;
+    std::string error;
+};
+
+thread_local std::unique_ptr<PerfEventGroup> thread_event_group;
+// profiler the counters of this thread were opened for, another profiler opens its own
+thread_local std::uint64_t thread_event_group_profiler = 0;
+#endif
+
+std::atomic<std::uint64_t> next_profiler_id{1};
+
+}
+
+HardwareCounterProfiler::HardwareCounterProfiler(std::uint64_t arg_raw_event) : raw_event(arg_raw_event), profiler_id(next_profiler_id++) {
+#ifndef __linux__
+    unavailable_reason = "hardware counters need perf_event_open, only available on linux";
+#endif
+}
+
+void HardwareCounterProfiler::read_thread_counters(std::vector<HardwareCounts>& readings){
+#ifdef __linux__
+    readings.assign(omp_get_max_threads(), HardwareCounts{});
+    // the same team size as the loops of the phase, so every worker thread reads its own counters
+#pragma omp parallel
+    {
+        const auto thread_id = omp_get_thread_num();
+        if (!thread_event_group || thread_event_group_profiler != profiler_id) {
+            thread_event_group = std::make_unique<PerfEventGroup>(raw_event);
+            thread_event_group_profiler = profiler_id;
+#pragma omp critical(hardware_counter_status)
+            {
+                if (thread_event_group->is_open()) {
+                    available = true;
+                } else if (unavailable_reason.empty()) {
+                    unavailable_reason = thread_event_group->get_error();
+                }
+            }
+        }
+        if (thread_id < static_cast<std::int32_t>(readings.size())) {
+            thread_event_group->read_counts(readings[thread_id]);
+        }
+    }
+#endif
+}
+
+void HardwareCounterProfiler::on_phase_begin(SimulationPhase){
+    read_thread_counters(phase_begin);
+}
+
+void HardwareCounterProfiler::on_phase_end(SimulationPhase phase, double){
+    std::vector<HardwareCounts> phase_end;
+    read_thread_counters(phase_end);
+    auto& counts = phase_counts[static_cast<std::size_t>(phase)];
+    if (counts.size() < phase_end.size()) {
+        counts.resize(phase_end.size());
+    }
+    for (std::size_t thread = 0; thread < phase_end.size() && thread < phase_begin.size(); thread++) {
+        for (std::size_t event = 0; event < num_hardware_events; event++) {
+            if (!phase_begin[thread].available[event] || !phase_end[thread].available[event]) {
+                continue;
+            }
+            // the extrapolation of multiplexed counters is not monotonic
+            if (phase_end[thread].values[event] > phase_begin[thread].values[event]) {
+                counts[thread].values[event] += phase_end[thread].values[event] - phase_begin[thread].values[event];
+            }
+            counts[thread].available[event] = true;
+        }
+    }
+}
+
+bool HardwareCounterProfiler::is_available() const{
+    return available;
+}
+
+const std::string& HardwareCounterProfiler::get_unavailable_reason() const{
+    return unavailable_reason;
+}
+
+const std::vector<HardwareCounts>& HardwareCounterProfiler::get_phase_counts(SimulationPhase phase) const{
+    return phase_counts[static_cast<std::size_t>(phase)];
+}
+
+void HardwareCounterProfiler::write_json(std::ostream& json_file) const{
+    json_file << "{\"available\": " << (available ? "true" : "false");
+    if (!available) {
+        // the reason is a strerror message, no characters that need escaping
+        json_file << ", \"reason\": \"" << unavailable_reason << "\"}";
+        return;
+    }
+    if (raw_event != 0) {
+        json_file << ", \"raw_event\": " << raw_event;
+    }
+    json_file << ", \"phases\": {";
+    bool first_phase = true;
+    for (std::size_t phase = 0; phase < num_simulation_phases; phase++) {
+        const auto& counts = phase_counts[phase];
+        if (counts.empty()) {
+            continue;
+        }
+        json_file << (first_phase ? "" : ", ") << "\"" << get_phase_name(static_cast<SimulationPhase>(phase)) << "\": [";
+        first_phase = false;
+        for (std::size_t thread = 0; thread < counts.size(); thread++) {
+            json_file << (thread == 0 ? "" : ", ") << "{\"thread\": " << thread;
+            for (std::size_t event = 0; event < num_hardware_events; event++) {
+                if (counts[thread].available[event]) {
+                    json_file << ", \"" << get_hardware_event_name(static_cast<HardwareEvent>(event)) << "\": " << counts[thread].values[event];
+                }
+            }
+            const auto cycles = static_cast<std::size_t>(HardwareEvent::cycles);
+            const auto instructions = static_cast<std::size_t>(HardwareEvent::instructions);
+            const auto llc_references = static_cast<std::size_t>(HardwareEvent::llc_references);
+            const auto llc_misses = static_cast<std::size_t>(HardwareEvent::llc_misses);
+            if (counts[thread].values[cycles] > 0 && counts[thread].available[instructions]) {
+                json_file << ", \"ipc\": " << static_cast<double>(counts[thread].values[instructions]) / counts[thread].values[cycles];
+            }
+            if (counts[thread].values[llc_references] > 0 && counts[thread].available[llc_misses]) {
+                json_file << ", \"llc_miss_rate\": " << static_cast<double>(counts[thread].values[llc_misses]) / counts[thread].values[llc_references];
+            }
+            json_file << "}";
+        }
+        json_file << "]";
+    }
+    json_file << "}}";
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "simulation/simulation_observer.h"
+
+enum class HardwareEvent : std::uint8_t {
+    cycles,
+    instructions,
+    llc_references,
+    llc_misses,
+    // model specific event given as raw perf config, e.g. the retired floating point operations
+    raw
+};
+
+static constexpr std::size_t num_hardware_events = 5;
+
+[[nodiscard]] const char* get_hardware_event_name(HardwareEvent event);
+
+// counts of one thread, events the cpu or the kernel does not offer stay unavailable
+struct HardwareCounts {
+    std::array<std::uint64_t, num_hardware_events> values = {};
+    std::array<bool, num_hardware_events> available = {};
+};
+
+// Reads the hardware counters of every OpenMP thread at the begin and end of every phase with
+// perf_event_open and sums the differences per phase and thread. Every thread opens its counters on
+// first use and keeps them until another profiler reads the counters of that thread. Counters the kernel does not permit (see
+// /proc/sys/kernel/perf_event_paranoid) or does not know are left out, without any counter the
+// profiler only records the reason. The counters only include user space, and the reads at the
+// phase borders run outside of the phase timers.
+class HardwareCounterProfiler : public SimulationObserver {
+public:
+    // raw_event 0 disables the raw counter
+    explicit HardwareCounterProfiler(std::uint64_t arg_raw_event = 0);
+
+    void on_phase_begin(SimulationPhase phase) override;
+    void on_phase_end(SimulationPhase phase, double seconds) override;
+
+    [[nodiscard]] bool is_available() const;
+    [[nodiscard]] const std::string& get_unavailable_reason() const;
+    // summed counts of every thread that took part in the phase
+    [[nodiscard]] const std::vector<HardwareCounts>& get_phase_counts(SimulationPhase phase) const;
+
+    // JSON object with the counts and the derived IPC and LLC miss rate per phase and thread
+    void write_json(std::ostream& json_file) const;
+
+private:
+    void read_thread_counters(std::vector<HardwareCounts>& readings);
+
+    std::uint64_t raw_event;
+    std::uint64_t profiler_id;
+    bool available = false;
+    std::string unavailable_reason;
+    std::vector<HardwareCounts> phase_begin;
+    std::array<std::vector<HardwareCounts>, num_simulation_phases> phase_counts;
+};
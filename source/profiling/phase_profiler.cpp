@@ -0,0 +1,101 @@
+#include "profiling/phase_profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <omp.h>
+#include <stdexcept>
+
+PhaseProfiler::PhaseProfiler(std::string arg_engine_name) : engine_name(std::move(arg_engine_name)){
+}
+
+void PhaseProfiler::on_epoch_begin(Universe& universe, SimulationContext&){
+    current_epoch = EpochProfile{};
+    current_epoch.epoch = universe.current_simulation_epoch;
+    current_epoch.num_bodies = universe.num_bodies;
+    epoch_start = std::chrono::steady_clock::now();
+}
+
+void PhaseProfiler::on_phase_end(SimulationPhase phase, double seconds){
+    current_epoch.phase_seconds[static_cast<std::size_t>(phase)] += seconds;
+}
+
+void PhaseProfiler::on_epoch_end(Universe&, SimulationContext& context){
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - epoch_start;
+    current_epoch.total_seconds = elapsed.count();
+    current_epoch.tree_depth = context.tree_depth;
+    current_epoch.tree_nodes = context.tree_nodes;
+    for (auto& scratch : context.thread_scratch) {
+        current_epoch.thread_counters.push_back(scratch.counters);
+    }
+    if (context.force_threads > 0 && !context.body_interactions.empty()) {
+        current_epoch.load_imbalance = context.get_load_imbalance();
+        auto [min_interactions, max_interactions] = std::minmax_element(context.body_interactions.begin(), context.body_interactions.end());
+        current_epoch.min_body_interactions = *min_interactions;
+        current_epoch.max_body_interactions = *max_interactions;
+        std::uint64_t summed_interactions = 0;
+        for (auto interactions : context.body_interactions) {
+            summed_interactions += interactions;
+        }
+        current_epoch.mean_body_interactions = static_cast<double>(summed_interactions) / context.body_interactions.size();
+    }
+    epochs.push_back(current_epoch);
+}
+
+const std::vector<PhaseProfiler::EpochProfile>& PhaseProfiler::get_epochs() const{
+    return epochs;
+}
+
+void PhaseProfiler::set_hardware_counters(const HardwareCounterProfiler* arg_hardware_counters){
+    hardware_counters = arg_hardware_counters;
+}
+
+void PhaseProfiler::write_json(const std::filesystem::path& file_path) const{
+    std::ofstream json_file(file_path);
+    if (!json_file.is_open()) {
+        throw std::invalid_argument("Could not open profile output file " + file_path.string());
+    }
+    json_file.precision(9);
+
+    std::array<double, num_simulation_phases> summed_phase_seconds = {};
+    double summed_total_seconds = 0.0;
+
+    json_file << "{\n";
+    json_file << "  \"engine\": \"" << engine_name << "\",\n";
+    json_file << "  \"max_threads\": " << omp_get_max_threads() << ",\n";
+    json_file << "  \"epochs\": [";
+    for (std::size_t epoch_index = 0; epoch_index < epochs.size(); epoch_index++) {
+        const EpochProfile& profile = epochs[epoch_index];
+        json_file << (epoch_index == 0 ? "\n" : ",\n");
+        json_file << "    {\"epoch\": " << profile.epoch << ", \"num_bodies\": " << profile.num_bodies;
+        json_file << ", \"total_seconds\": " << profile.total_seconds;
+        json_file << ", \"phases\": {";
+        for (std::size_t phase = 0; phase < num_simulation_phases; phase++) {
+            json_file << (phase == 0 ? "" : ", ") << "\"" << get_phase_name(static_cast<SimulationPhase>(phase)) << "\": " << profile.phase_seconds[phase];
+            summed_phase_seconds[phase] += profile.phase_seconds[phase];
+        }
+        json_file << "}, \"tree_depth\": " << profile.tree_depth << ", \"tree_nodes\": " << profile.tree_nodes;
+        json_file << ", \"load_imbalance\": " << profile.load_imbalance;
+        json_file << ", \"body_interactions\": {\"min\": " << profile.min_body_interactions << ", \"max\": " << profile.max_body_interactions << ", \"mean\": " << profile.mean_body_interactions << "}";
+        json_file << ", \"threads\": [";
+        for (std::size_t thread = 0; thread < profile.thread_counters.size(); thread++) {
+            json_file << (thread == 0 ? "" : ", ") << "{\"thread\": " << thread;
+            json_file << ", \"nodes_visited\": " << profile.thread_counters[thread].nodes_visited;
+            json_file << ", \"interactions\": " << profile.thread_counters[thread].interactions;
+            json_file << ", \"busy_seconds\": " << profile.thread_counters[thread].busy_seconds << "}";
+        }
+        json_file << "]}";
+        summed_total_seconds += profile.total_seconds;
+    }
+    json_file << "\n  ],\n";
+
+    json_file << "  \"summary\": {\"epochs\": " << epochs.size() << ", \"total_seconds\": " << summed_total_seconds << ", \"phases\": {";
+    for (std::size_t phase = 0; phase < num_simulation_phases; phase++) {
+        json_file << (phase == 0 ? "" : ", ") << "\"" << get_phase_name(static_cast<SimulationPhase>(phase)) << "\": " << summed_phase_seconds[phase];
+    }
+    json_file << "}}";
+    if (hardware_counters != nullptr) {
+        json_file << ",\n  \"hardware_counters\": ";
+        hardware_counters->write_json(json_file);
+    }
+    json_file << "\n}\n";
+}
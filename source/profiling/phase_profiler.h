@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "simulation/simulation_observer.h"
+#include "simulation/simulation_context.h"
+#include "profiling/hardware_counters.h"
+
+// Collects the phase timings and thread counters of every epoch and writes them as JSON.
+// Registered as observer, so nothing is measured if no profiler is attached to the context.
+class PhaseProfiler : public SimulationObserver {
+public:
+    struct EpochProfile {
+        std::uint32_t epoch = 0;
+        std::uint32_t num_bodies = 0;
+        std::array<double, num_simulation_phases> phase_seconds = {};
+        double total_seconds = 0.0;
+        std::uint32_t tree_depth = 0;
+        std::size_t tree_nodes = 0;
+        std::vector<ThreadCounters> thread_counters;
+        // only filled by engines reporting per-body interactions
+        double load_imbalance = 0.0;
+        std::uint32_t min_body_interactions = 0;
+        std::uint32_t max_body_interactions = 0;
+        double mean_body_interactions = 0.0;
+    };
+
+    explicit PhaseProfiler(std::string arg_engine_name);
+
+    void on_epoch_begin(Universe& universe, SimulationContext& context) override;
+    void on_phase_end(SimulationPhase phase, double seconds) override;
+    void on_epoch_end(Universe& universe, SimulationContext& context) override;
+
+    [[nodiscard]] const std::vector<EpochProfile>& get_epochs() const;
+    // the counts of this profiler are written as "hardware_counters" next to the timings
+    void set_hardware_counters(const HardwareCounterProfiler* arg_hardware_counters);
+
+    void write_json(const std::filesystem::path& file_path) const;
+
+private:
+    std::string engine_name;
+    const HardwareCounterProfiler* hardware_counters = nullptr;
+    std::vector<EpochProfile> epochs;
+    EpochProfile current_epoch;
+    std::chrono::steady_clock::time_point epoch_start;
+};
@@ -28,8 +28,20 @@ Quadtree::Quadtree(Universe& universe, BoundingBox bounding_box, std::int8_t con
     }
 }
 
+Quadtree::Quadtree(Universe& universe, BoundingBox bounding_box, QuadtreeNodeArena& node_arena, std::vector<std::int32_t>& body_indices)
+    : arena(&node_arena) {
+    arena->reset();
+    root = arena->acquire(bounding_box);
+    if (!body_indices.empty()) {
+        construct_in_arena(universe, root, body_indices.data(), body_indices.data() + body_indices.size(), 0);
+    }
+}
+
 Quadtree::~Quadtree(){
+    // nodes taken from an arena are released by the arena itself
+    if (arena == nullptr) {
         delete root;
+    }
 }
 
 void Quadtree::calculate_cumulative_masses(){
@@ -77,6 +89,38 @@ std::vector<QuadtreeNode *> Quadtree::construct(Universe &universe, BoundingBox
     }
 }
 
+void Quadtree::construct_in_arena(Universe& universe, QuadtreeNode* node, std::int32_t* body_indices_begin, std::int32_t* body_indices_end, std::uint32_t node_depth) {
+    // same tree layout as construct(): a single body is stored in a leaf below a node with the same bounding box
+    if (body_indices_end - body_indices_begin == 1) {
+        QuadtreeNode* child_node = arena->acquire(node->bounding_box);
+        child_node->body_identifier = *body_indices_begin;
+        child_node->center_of_mass = universe.positions[*body_indices_begin];
+        child_node->cumulative_mass = universe.weights[*body_indices_begin];
+        child_node->center_of_mass_ready = true;
+        child_node->cumulative_mass_ready = true;
+        node->children.push_back(child_node);
+        depth = std::max(depth, node_depth + 1);
+        return;
+    }
+
+    // partition the index range in place instead of copying the bodies of every quadrant. A body on a
+    // shared border is assigned to the first quadrant containing it
+    std::int32_t* quadrant_begin = body_indices_begin;
+    for (std::uint8_t quadrant_id = 0; quadrant_id < 4; quadrant_id++) {
+        BoundingBox child_BB = node->bounding_box.get_quadrant(quadrant_id);
+        std::int32_t* quadrant_end = std::partition(quadrant_begin, body_indices_end, [&](std::int32_t body_index) {
+            return child_BB.contains(universe.positions[body_index]);
+        });
+        if (quadrant_end == quadrant_begin) {
+            continue;
+        }
+        QuadtreeNode* child_node = arena->acquire(child_BB);
+        node->children.push_back(child_node);
+        construct_in_arena(universe, child_node, quadrant_begin, quadrant_end, node_depth + 1);
+        quadrant_begin = quadrant_end;
+    }
+}
+
 std::vector<QuadtreeNode*> Quadtree::construct_task(Universe& universe, BoundingBox BB, std::vector<std::int32_t> body_indices) {
     if (body_indices.size() ==1) {
         QuadtreeNode* child_node = new QuadtreeNode(BB);
@@ -169,15 +213,19 @@ std::vector<QuadtreeNode*> Quadtree::construct_task_with_cutoff(Universe& univer
 
 
 std::vector<BoundingBox> Quadtree::get_bounding_boxes(QuadtreeNode* qtn){
-    // traverse quadtree and collect bounding boxes
+    // traverse quadtree and collect bounding boxes, children before their parent
     std::vector<BoundingBox> result;
-    // collect bounding boxes from children
-    for(auto child: qtn->children){
-        for(auto bb: get_bounding_boxes(child)){
-            result.push_back(bb);
+    std::vector<QuadtreeNode*> stack{qtn};
+    while(!stack.empty()){
+        QuadtreeNode* node = stack.back();
+        stack.pop_back();
+        result.push_back(node->bounding_box);
+        for(auto child: node->children){
+            stack.push_back(child);
         }
     }
-    result.push_back(qtn->bounding_box);
+    // the reversed pre-order with the last child first is the post-order with the first child first
+    std::reverse(result.begin(), result.end());
     return result;
 }
 
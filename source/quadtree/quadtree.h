@@ -3,19 +3,27 @@
 #include "structures/vector2d.h"
 #include "structures/universe.h"
 #include "quadtreeNode.h"
+#include "quadtreeNodeArena.h"
 
 class Quadtree {
 public:
     Quadtree(Universe& universe, BoundingBox bounding_box, std::int8_t construct_mode);
+    // builds the tree from nodes of the arena. body_indices has to contain the bodies to insert and
+    // is reordered in place, afterwards it lists the bodies in tree (depth-first) order
+    Quadtree(Universe& universe, BoundingBox bounding_box, QuadtreeNodeArena& arena, std::vector<std::int32_t>& body_indices);
     ~Quadtree();
 
     std::vector<QuadtreeNode*> construct(Universe& universe, BoundingBox BB, std::vector<std::int32_t> body_indices);
     std::vector<QuadtreeNode*> construct_task(Universe& universe, BoundingBox BB, std::vector<std::int32_t> body_indices);
     std::vector<QuadtreeNode*> construct_task_with_cutoff(Universe& universe, BoundingBox& BB, std::vector<std::int32_t>& body_indices);
+    void construct_in_arena(Universe& universe, QuadtreeNode* node, std::int32_t* body_indices_begin, std::int32_t* body_indices_end, std::uint32_t node_depth);
 
     void calculate_cumulative_masses();
     void calculate_center_of_mass();
     QuadtreeNode* root = nullptr;
+    QuadtreeNodeArena* arena = nullptr;
+    // depth of the deepest leaf, only tracked for trees built in an arena
+    std::uint32_t depth = 0;
 
     std::vector<BoundingBox> get_bounding_boxes(QuadtreeNode* qtn);
 };
\ No newline at end of file
@@ -53,4 +53,32 @@ Vector2d<double> QuadtreeNode::calculate_node_center_of_mass(){
         center_of_mass_ready = true;
         return center_of_mass;
     }
-}
\ No newline at end of file
+}
+
+void QuadtreeNode::aggregate_mass(){
+    // single post-order pass, every node is visited exactly once
+    if (children.empty()) {
+        cumulative_mass_ready = true;
+        center_of_mass_ready = true;
+        return;
+    }
+
+    double total_mass = 0.0;
+    double weighted_x = 0.0;
+    double weighted_y = 0.0;
+    for (auto child : children) {
+        child->aggregate_mass();
+        total_mass += child->cumulative_mass;
+        weighted_x += child->center_of_mass[0] * child->cumulative_mass;
+        weighted_y += child->center_of_mass[1] * child->cumulative_mass;
+    }
+
+    cumulative_mass = total_mass;
+    if (total_mass != 0) {
+        center_of_mass = Vector2d<double>(weighted_x / total_mass, weighted_y / total_mass);
+    } else {
+        center_of_mass = Vector2d<double>(0.0, 0.0);
+    }
+    cumulative_mass_ready = true;
+    center_of_mass_ready = true;
+}
@@ -11,6 +11,7 @@ public:
     ~QuadtreeNode();
     double calculate_node_cumulative_mass();
     Vector2d<double> calculate_node_center_of_mass();
+    void aggregate_mass();
     std::vector<QuadtreeNode*> children;    
     Vector2d<double> center_of_mass;
     double cumulative_mass;
@@ -20,5 +21,4 @@ public:
     bool cumulative_mass_ready = false;
 
     BoundingBox bounding_box;
-    Universe universe ;
 };
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "quadtreeNodeArena.h"
+
+QuadtreeNodeArena::~QuadtreeNodeArena(){
+    // children point into the pool as well, detach them so ~QuadtreeNode does not delete them
+    for (auto& node : nodes) {
+        node.children.clear();
+    }
+}
+
+QuadtreeNode* QuadtreeNodeArena::acquire(BoundingBox bounding_box){
+    if (used_nodes == nodes.size()) {
+        nodes.emplace_back(bounding_box);
+        used_nodes++;
+        return &nodes.back();
+    }
+
+    // recycle a node of a previous tree, clear() keeps the capacity of the children vector
+    QuadtreeNode* node = &nodes[used_nodes++];
+    node->bounding_box = bounding_box;
+    node->children.clear();
+    node->center_of_mass = Vector2d<double>(0.0, 0.0);
+    node->cumulative_mass = 0.0;
+    node->body_identifier = -1;
+    node->center_of_mass_ready = false;
+    node->cumulative_mass_ready = false;
+    return node;
+}
+
+void QuadtreeNodeArena::reset(){
+    used_nodes = 0;
+}
+
+std::size_t QuadtreeNodeArena::get_used_nodes() const{
+    return used_nodes;
+}
+
+std::size_t QuadtreeNodeArena::get_capacity() const{
+    return nodes.size();
+}
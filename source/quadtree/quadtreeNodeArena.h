@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include "structures/bounding_box.h"
+#include "quadtreeNode.h"
+
+// Pool of quadtree nodes that is reused across epochs. Nodes handed out by the arena are owned by
+// the arena and must not be deleted, the whole tree is released at once by reset().
+class QuadtreeNodeArena {
+public:
+    QuadtreeNodeArena() = default;
+    ~QuadtreeNodeArena();
+
+    QuadtreeNodeArena(const QuadtreeNodeArena&) = delete;
+    QuadtreeNodeArena& operator=(const QuadtreeNodeArena&) = delete;
+
+    QuadtreeNode* acquire(BoundingBox bounding_box);
+    void reset();
+
+    [[nodiscard]] std::size_t get_used_nodes() const;
+    [[nodiscard]] std::size_t get_capacity() const;
+
+private:
+    // std::deque keeps node addresses stable while the pool grows
+    std::deque<QuadtreeNode> nodes;
+    std::size_t used_nodes = 0;
+};
@@ -1,62 +1,76 @@
 #include "simulation/barnes_hut_simulation.h"
 #include "simulation/naive_parallel_simulation.h"
+#include "simulation/simulation_driver.h"
 #include "physics/gravitation.h"
 #include "physics/mechanics.h"
 #include "plotting/plotter.h"
 
 #include <cmath>
 #include <functional>
+#include <omp.h>
 
 void BarnesHutSimulation::simulate_epochs(Plotter& plotter, Universe& universe, std::uint32_t num_epochs, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
-    for(int i = 0; i < num_epochs; i++){
-        simulate_epoch(plotter, universe, create_intermediate_plots, plot_intermediate_epochs);
-    }
+    BarnesHutEngine engine;
+    SimulationContext context(universe);
+    SimulationDriver::simulate_epochs(engine, plotter, universe, context, num_epochs, create_intermediate_plots, plot_intermediate_epochs);
 }
 
 void BarnesHutSimulation::simulate_epoch(Plotter& plotter, Universe& universe, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
-    BoundingBox universe_bb = universe.get_bounding_box();
-    std::vector<std::int32_t> all_body_indices;
-    for (std::int32_t i = 0; i < universe.num_bodies; i++) {
-        all_body_indices.push_back(i);
-    }
+    simulate_epoch(plotter, universe, SimulationContext::get_thread_context(universe), create_intermediate_plots, plot_intermediate_epochs);
+}
 
-    Quadtree quadtree(universe, universe_bb, 0);  // Quadtree với mức độ 0
-    quadtree.root->children = quadtree.construct(universe, universe_bb, all_body_indices);  // Xây dựng Quadtree
+void BarnesHutSimulation::simulate_epoch(Plotter& plotter, Universe& universe, SimulationContext& context, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
+    BarnesHutEngine engine;
+    SimulationDriver::simulate_epoch(engine, plotter, universe, context, create_intermediate_plots, plot_intermediate_epochs);
+}
 
-    std::vector<QuadtreeNode*> queue = {quadtree.root};
-    while (!queue.empty()) {
-        auto current_node = queue.back();
-        queue.pop_back();
+void BarnesHutSimulation::simulate_epoch(Universe& universe, SimulationContext& context){
+    context.prepare(universe);
+    context.reset_body_indices(universe);
 
-        current_node->calculate_node_cumulative_mass();
-        current_node->calculate_node_center_of_mass();
+    ScopedPhaseTimer bounding_box_timer(context, SimulationPhase::bounding_box);
+    BoundingBox universe_bb = universe.get_bounding_box();
+    bounding_box_timer.stop();
 
-        for (auto& child : current_node->children) {
-            queue.push_back(child);
-        }
-    }
+    ScopedPhaseTimer tree_build_timer(context, SimulationPhase::tree_build);
+    Quadtree quadtree(universe, universe_bb, context.node_arena, context.body_indices);
+    tree_build_timer.stop();
+    context.tree_depth = quadtree.depth;
+    context.tree_nodes = context.node_arena.get_used_nodes();
+
+    ScopedPhaseTimer mass_aggregation_timer(context, SimulationPhase::mass_aggregation);
+    quadtree.root->aggregate_mass();
+    mass_aggregation_timer.stop();
+    context.tree_root = quadtree.root;
 
-    calculate_forces(universe,quadtree);
+    ScopedPhaseTimer force_calculation_timer(context, SimulationPhase::force_calculation);
+    calculate_forces(universe, quadtree, context);
+    force_calculation_timer.stop();
 
+    ScopedPhaseTimer integration_timer(context, SimulationPhase::integration);
     NaiveParallelSimulation::calculate_velocities(universe);
     NaiveParallelSimulation::calculate_positions(universe);
+    integration_timer.stop();
 
     universe.current_simulation_epoch++;
-
-    if (create_intermediate_plots && (universe.current_simulation_epoch % plot_intermediate_epochs == 0)) {
-        plotter.add_bodies_to_image(universe);
-        plotter.write_and_clear();
-    }
 }
 
 
 
 void BarnesHutSimulation::get_relevant_nodes(Universe& universe, Quadtree& quadtree, std::vector<QuadtreeNode*>& relevant_nodes, Vector2d<double>& body_position, std::int32_t body_index, double threshold_theta) {
     std::vector<QuadtreeNode*> all_vectors;
+    get_relevant_nodes(universe, quadtree, relevant_nodes, all_vectors, body_position, body_index, threshold_theta);
+}
+
+std::size_t BarnesHutSimulation::get_relevant_nodes(Universe& universe, Quadtree& quadtree, std::vector<QuadtreeNode*>& relevant_nodes, std::vector<QuadtreeNode*>& traversal_stack, Vector2d<double>& body_position, std::int32_t body_index, double threshold_theta) {
+    std::vector<QuadtreeNode*>& all_vectors = traversal_stack;
+    std::size_t visited_nodes = 0;
+    all_vectors.clear();
     all_vectors.push_back(quadtree.root);
     while (!all_vectors.empty()) {
         auto current_node = all_vectors.back();
         all_vectors.pop_back();
+        visited_nodes++;
 
         double diagonal = current_node->bounding_box.get_diagonal();
         Vector2d<double> direction = current_node->center_of_mass - body_position;
@@ -81,39 +95,118 @@ void BarnesHutSimulation::get_relevant_nodes(Universe& universe, Quadtree& quadt
             }
         }
     }
+    return visited_nodes;
 }
 
 void BarnesHutSimulation::calculate_forces(Universe& universe, Quadtree& quadtree){
-    const double threshold_theta = 0.2;
-    const double G = 6.67430e-11;
+    calculate_forces(universe, quadtree, SimulationContext::get_thread_context(universe));
+}
+
+void BarnesHutSimulation::calculate_forces(Universe& universe, Quadtree& quadtree, SimulationContext& context){
+    const double threshold_theta = default_threshold_theta;
+    const ForceSchedule schedule = context.force_schedule.schedule;
+
+    // the loop below uses schedule(runtime), the run-schedule of the caller is restored afterwards
+    omp_sched_t caller_schedule_kind;
+    int caller_chunk_size;
+    omp_get_schedule(&caller_schedule_kind, &caller_chunk_size);
+    switch (schedule) {
+        case ForceSchedule::static_schedule:
+            omp_set_schedule(omp_sched_static, context.force_schedule.chunk_size);
+            break;
+        case ForceSchedule::dynamic:
+            omp_set_schedule(omp_sched_dynamic, context.force_schedule.chunk_size);
+            break;
+        case ForceSchedule::guided:
+            omp_set_schedule(omp_sched_guided, context.force_schedule.chunk_size);
+            break;
+        case ForceSchedule::cost_weighted:
+            // uses the interaction counts of the previous epoch, which are overwritten in this loop
+            partition_by_cost(context.body_interactions, omp_get_max_threads(), context.cost_partition);
+            break;
+        case ForceSchedule::cost_zones:
+            // body_indices holds the bodies in the leaf order of the tree built in this epoch
+            partition_by_cost(context.body_interactions, context.body_indices, omp_get_max_threads(), context.cost_partition);
+            break;
+    }
+
+#pragma omp parallel
+    {
+        // traversal stack and node list are reused for all bodies of this thread
+        const std::int32_t thread_id = omp_get_thread_num();
+        ThreadScratch& scratch = context.get_thread_scratch(thread_id);
+        const double start_time = omp_get_wtime();
+
+        if (schedule == ForceSchedule::cost_weighted || schedule == ForceSchedule::cost_zones) {
+            const bool tree_order = schedule == ForceSchedule::cost_zones;
+            // a smaller team than requested takes over the remaining parts round robin
+            const std::int32_t num_parts = context.cost_partition.size() - 1;
+            for (std::int32_t part = thread_id; part < num_parts; part += omp_get_num_threads()) {
+                for (std::int32_t position = context.cost_partition[part]; position < context.cost_partition[part + 1]; position++) {
+                    std::int32_t body_index = tree_order ? context.body_indices[position] : position;
+                    calculate_force(universe, quadtree, context, scratch, body_index, threshold_theta);
+                }
+            }
+        } else {
+            // no barrier at the end, so the busy time of a thread does not include waiting for the others
+#pragma omp for schedule(runtime) nowait
+            for (std::int32_t body_index = 0; body_index < universe.num_bodies; body_index++) {
+                calculate_force(universe, quadtree, context, scratch, body_index, threshold_theta);
+            }
+        }
 
-#pragma omp parallel for
-    for (std::int32_t body_index = 0; body_index < universe.num_bodies; body_index++) {
-        // Vị trí và các thông tin của cơ thể
-        Vector2d<double>& body_position = universe.positions[body_index];
-        Vector2d<double>& body_velocity = universe.velocities[body_index];
-        double body_force_x = universe.forces[body_index][0];
-        double body_force_y = universe.forces[body_index][1];
+        scratch.counters.busy_seconds += omp_get_wtime() - start_time;
+#pragma omp single nowait
+        context.force_threads = omp_get_num_threads();
+    }
+    omp_set_schedule(caller_schedule_kind, caller_chunk_size);
+}
 
-        body_force_x = 0;
-        body_force_y = 0;
+void BarnesHutSimulation::calculate_force(Universe& universe, Quadtree& quadtree, SimulationContext& context, ThreadScratch& scratch, std::int32_t body_index, double threshold_theta){
+    const double G = 6.67430e-11;
 
-        std::vector<QuadtreeNode*> relevant_nodes;
-        get_relevant_nodes(universe, quadtree, relevant_nodes, body_position, body_index, threshold_theta);
+    // Vị trí và các thông tin của cơ thể
+    Vector2d<double>& body_position = universe.positions[body_index];
+    double body_force_x = 0;
+    double body_force_y = 0;
 
-        for (QuadtreeNode* node : relevant_nodes) {
-            if (node->center_of_mass_ready) {
-                Vector2d<double> direction = node->center_of_mass - body_position;
-                double distance = sqrt(pow(direction[0], 2) + pow(direction[1], 2));
+    scratch.relevant_nodes.clear();
+    scratch.counters.nodes_visited += get_relevant_nodes(universe, quadtree, scratch.relevant_nodes, scratch.traversal_stack, body_position, body_index, threshold_theta);
+    scratch.counters.interactions += scratch.relevant_nodes.size();
+    context.body_interactions[body_index] = scratch.relevant_nodes.size();
 
-                if (distance > 0) {
-                    double force_magnitude = (G * universe.weights[body_index] * node->cumulative_mass) / (distance * distance);
-                    direction = direction / distance;
+    for (QuadtreeNode* node : scratch.relevant_nodes) {
+        if (node->center_of_mass_ready) {
+            Vector2d<double> direction = node->center_of_mass - body_position;
+            double distance = sqrt(pow(direction[0], 2) + pow(direction[1], 2));
 
-                    body_force_x += force_magnitude * direction[0];
-                    body_force_y += force_magnitude * direction[1];
-                }
+            if (distance > 0) {
+                double force_magnitude = (G * universe.weights[body_index] * node->cumulative_mass) / (distance * distance);
+                direction = direction / distance;
+
+                body_force_x += force_magnitude * direction[0];
+                body_force_y += force_magnitude * direction[1];
             }
         }
     }
+
+    universe.forces[body_index] = Vector2d<double>(body_force_x, body_force_y);
+}
+
+
+std::string BarnesHutEngine::get_name() const{
+    return "barnes_hut";
+}
+
+EngineCapabilities BarnesHutEngine::get_capabilities() const{
+    EngineCapabilities capabilities;
+    // every body walks the tree on its own, the summation order does not depend on the threads
+    capabilities.deterministic = true;
+    capabilities.parallel = true;
+    capabilities.uses_quadtree = true;
+    return capabilities;
+}
+
+void BarnesHutEngine::simulate_epoch(Universe& universe, SimulationContext& context){
+    BarnesHutSimulation::simulate_epoch(universe, context);
 }
\ No newline at end of file
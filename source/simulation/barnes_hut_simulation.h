@@ -4,14 +4,35 @@
 #include "structures/universe.h"
 #include "quadtree/quadtree.h"
 #include "plotting/plotter.h"
+#include "simulation/simulation_context.h"
+#include "simulation/simulation_engine.h"
 
 
 class BarnesHutSimulation{
 public:
+    // opening criterion of the force calculation, nodes with diagonal / distance <= theta are approximated
+    static constexpr double default_threshold_theta = 0.2;
+
+    // one context for all epochs of the run
     static void simulate_epochs(Plotter& plotter, Universe& universe, std::uint32_t num_epochs, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs);
+    // without a context the buffers of the calling thread are reused, see SimulationContext::get_thread_context
     static void simulate_epoch(Plotter& plotter, Universe& universe, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs);
+    static void simulate_epoch(Plotter& plotter, Universe& universe, SimulationContext& context, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs);
+    static void simulate_epoch(Universe& universe, SimulationContext& context);
     static void calculate_forces(Universe& universe, Quadtree& quadtree);
+    // distributes the bodies according to context.force_schedule
+    static void calculate_forces(Universe& universe, Quadtree& quadtree, SimulationContext& context);
+    static void calculate_force(Universe& universe, Quadtree& quadtree, SimulationContext& context, ThreadScratch& scratch, std::int32_t body_index, double threshold_theta);
     static void get_relevant_nodes(Universe& universe, Quadtree& quadtree, std::vector<QuadtreeNode*>& relevant_nodes, Vector2d<double>& body_position, std::int32_t body_index, double threshold_theta);
+    // returns the number of visited nodes
+    static std::size_t get_relevant_nodes(Universe& universe, Quadtree& quadtree, std::vector<QuadtreeNode*>& relevant_nodes, std::vector<QuadtreeNode*>& traversal_stack, Vector2d<double>& body_position, std::int32_t body_index, double threshold_theta);
 
     static void get_relevant_nodes_recursive(Universe& universe, QuadtreeNode* node, std::vector<QuadtreeNode*>& relevant_nodes, Vector2d<double>& body_position, std::int32_t body_index, double threshold_theta);
+};
+
+class BarnesHutEngine : public SimulationEngine {
+public:
+    [[nodiscard]] std::string get_name() const override;
+    [[nodiscard]] EngineCapabilities get_capabilities() const override;
+    void simulate_epoch(Universe& universe, SimulationContext& context) override;
 };
\ No newline at end of file
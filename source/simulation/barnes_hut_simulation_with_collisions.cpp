@@ -4,26 +4,27 @@
 
 #include "simulation/barnes_hut_simulation.h"
 #include "simulation/naive_parallel_simulation.h"
+#include "simulation/simulation_driver.h"
 #include <omp.h>
 
 void BarnesHutSimulationWithCollisions::simulate_epochs(Plotter& plotter, Universe& universe, std::uint32_t num_epochs, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
-    for(int i = 0; i < num_epochs; i++){
-        simulate_epoch(plotter, universe, create_intermediate_plots, plot_intermediate_epochs);
-    }
+    BarnesHutWithCollisionsEngine engine;
+    SimulationContext context(universe);
+    SimulationDriver::simulate_epochs(engine, plotter, universe, context, num_epochs, create_intermediate_plots, plot_intermediate_epochs);
 }
 
 void BarnesHutSimulationWithCollisions::simulate_epoch(Plotter& plotter, Universe& universe, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
+    BarnesHutWithCollisionsEngine engine;
+    SimulationDriver::simulate_epoch(engine, plotter, universe, SimulationContext::get_thread_context(universe), create_intermediate_plots, plot_intermediate_epochs);
+}
+
+void BarnesHutSimulationWithCollisions::simulate_epoch(Universe& universe, SimulationContext& context){
     // Tính toán lực và vị trí của các cơ thể (tương tự như trong simulate_epoch của BarnesHutSimulation)
-    BarnesHutSimulation::simulate_epoch(plotter, universe, create_intermediate_plots, plot_intermediate_epochs);
+    BarnesHutSimulation::simulate_epoch(universe, context);
 
     // Tìm và xử lý các va chạm
+    ScopedPhaseTimer timer(context, SimulationPhase::collisions);
     find_collisions(universe);
-
-    // Nếu yêu cầu vẽ hình, thực hiện vẽ
-    if (create_intermediate_plots && (universe.current_simulation_epoch % plot_intermediate_epochs == 0)) {
-        plotter.add_bodies_to_image(universe);
-        plotter.write_and_clear();
-    }
 }
 
 void BarnesHutSimulationWithCollisions::find_collisions(Universe& universe){
@@ -131,3 +132,23 @@ void BarnesHutSimulationWithCollisions::find_collisions_parallel(Universe& unive
         }
     }
 }
+
+
+std::string BarnesHutWithCollisionsEngine::get_name() const{
+    return "barnes_hut_with_collisions";
+}
+
+EngineCapabilities BarnesHutWithCollisionsEngine::get_capabilities() const{
+    EngineCapabilities capabilities;
+    capabilities.supports_collisions = true;
+    capabilities.deterministic = true;
+    capabilities.parallel = true;
+    capabilities.uses_quadtree = true;
+    // the collision search compares every pair of bodies
+    capabilities.quadratic_cost = true;
+    return capabilities;
+}
+
+void BarnesHutWithCollisionsEngine::simulate_epoch(Universe& universe, SimulationContext& context){
+    BarnesHutSimulationWithCollisions::simulate_epoch(universe, context);
+}
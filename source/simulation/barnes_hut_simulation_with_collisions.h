@@ -6,7 +6,15 @@ class BarnesHutSimulationWithCollisions : BarnesHutSimulation {
 public:
     static void simulate_epochs(Plotter& plotter, Universe& universe, std::uint32_t num_epochs, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs);
     static void simulate_epoch(Plotter& plotter, Universe& universe, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs);
+    static void simulate_epoch(Universe& universe, SimulationContext& context);
 
     static void find_collisions(Universe& universe);
     static void find_collisions_parallel(Universe& universe);
+};
+
+class BarnesHutWithCollisionsEngine : public SimulationEngine {
+public:
+    [[nodiscard]] std::string get_name() const override;
+    [[nodiscard]] EngineCapabilities get_capabilities() const override;
+    void simulate_epoch(Universe& universe, SimulationContext& context) override;
 };
\ No newline at end of file
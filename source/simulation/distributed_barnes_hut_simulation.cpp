@@ -0,0 +1,447 @@
+#include "simulation/distributed_barnes_hut_simulation.h"
+#include "simulation/barnes_hut_simulation.h"
+#include "simulation/naive_parallel_simulation.h"
+#include "distributed/in_process_transport.h"
+#include "structures/morton.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <omp.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+static void append_body(Universe& universe, Vector2d<double> position, Vector2d<double> velocity, Vector2d<double> force, double weight){
+    universe.positions.push_back(position);
+    universe.velocities.push_back(velocity);
+    universe.forces.push_back(force);
+    universe.weights.push_back(weight);
+    universe.num_bodies++;
+}
+
+static MigratingBody get_migrating_body(Universe& universe, std::int32_t body_index, std::int32_t body_identifier){
+    return MigratingBody{body_identifier,
+        universe.positions[body_index][0], universe.positions[body_index][1],
+        universe.velocities[body_index][0], universe.velocities[body_index][1],
+        universe.forces[body_index][0], universe.forces[body_index][1],
+        universe.weights[body_index]};
+}
+
+// distance of a position to the closest point of the bounding box, 0 inside
+static double get_distance_to_box(Vector2d<double> position, BoundingBox& bounding_box){
+    double dx = std::max({bounding_box.x_min - position[0], 0.0, position[0] - bounding_box.x_max});
+    double dy = std::max({bounding_box.y_min - position[1], 0.0, position[1] - bounding_box.y_max});
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+std::vector<BoundingBox> DistributedBarnesHutSimulation::gather_domains(Transport& transport, Universe& local_universe){
+    // inverted box for ranks without bodies, merging it changes nothing
+    double x_min = std::numeric_limits<double>::max();
+    double x_max = std::numeric_limits<double>::lowest();
+    double y_min = std::numeric_limits<double>::max();
+    double y_max = std::numeric_limits<double>::lowest();
+    for (std::uint32_t body_index = 0; body_index < local_universe.num_bodies; body_index++) {
+        x_min = std::min(x_min, local_universe.positions[body_index][0]);
+        x_max = std::max(x_max, local_universe.positions[body_index][0]);
+        y_min = std::min(y_min, local_universe.positions[body_index][1]);
+        y_max = std::max(y_max, local_universe.positions[body_index][1]);
+    }
+
+    MessageBuffer message;
+    message.write(BoundingBox(x_min, x_max, y_min, y_max));
+    std::vector<MessageBuffer> messages = all_gather(transport, MessageTag::bounding_box, message);
+
+    std::vector<BoundingBox> domains;
+    for (auto& rank_message : messages) {
+        domains.push_back(rank_message.read<BoundingBox>());
+    }
+    return domains;
+}
+
+static BoundingBox merge_domains(std::vector<BoundingBox>& domains){
+    BoundingBox merged(std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest());
+    for (auto& domain : domains) {
+        merged.x_min = std::min(merged.x_min, domain.x_min);
+        merged.x_max = std::max(merged.x_max, domain.x_max);
+        merged.y_min = std::min(merged.y_min, domain.y_min);
+        merged.y_max = std::max(merged.y_max, domain.y_max);
+    }
+    return merged;
+}
+
+void DistributedBarnesHutSimulation::export_essential_nodes(QuadtreeNode* root, BoundingBox remote_domain, double threshold_theta, std::vector<EssentialNode>& essential_nodes){
+    if (remote_domain.x_min > remote_domain.x_max) {
+        // the remote rank has no bodies
+        return;
+    }
+
+    // A node is sent as aggregate if the opening criterion holds for the closest point of the remote
+    // domain and therefore for every remote body. Otherwise its children are checked, down to single bodies.
+    std::vector<QuadtreeNode*> stack = {root};
+    while (!stack.empty()) {
+        QuadtreeNode* node = stack.back();
+        stack.pop_back();
+        if (node->cumulative_mass <= 0) {
+            continue;
+        }
+
+        double distance = get_distance_to_box(node->center_of_mass, remote_domain);
+        if (node->body_identifier != -1 || (distance > 0 && node->bounding_box.get_diagonal() / distance <= threshold_theta)) {
+            essential_nodes.push_back(EssentialNode{node->center_of_mass[0], node->center_of_mass[1], node->cumulative_mass});
+            continue;
+        }
+        // reversed, so the nodes are exported in depth-first quadrant order
+        for (auto child = node->children.rbegin(); child != node->children.rend(); ++child) {
+            stack.push_back(*child);
+        }
+    }
+}
+
+std::vector<std::uint32_t> DistributedBarnesHutSimulation::get_key_ranges(const std::vector<std::uint32_t>& bucket_counts, std::int32_t num_ranks){
+    std::uint64_t total_count = 0;
+    for (auto count : bucket_counts) {
+        total_count += count;
+    }
+
+    // rank r starts at the first bucket after r/num_ranks of all bodies
+    std::vector<std::uint32_t> key_ranges(num_ranks + 1, bucket_counts.size());
+    key_ranges[0] = 0;
+    std::int32_t rank = 1;
+    std::uint64_t prefix_count = 0;
+    for (std::uint32_t bucket = 0; bucket < bucket_counts.size() && rank < num_ranks; bucket++) {
+        prefix_count += bucket_counts[bucket];
+        while (rank < num_ranks && prefix_count * num_ranks >= total_count * rank) {
+            key_ranges[rank] = bucket + 1;
+            rank++;
+        }
+    }
+    return key_ranges;
+}
+
+void DistributedBarnesHutSimulation::migrate_bodies(Transport& transport, Universe& local_universe, std::vector<std::int32_t>& owned_bodies, std::vector<MigratingBody>& migrated_bodies){
+    const std::int32_t rank = transport.get_rank();
+    const std::int32_t num_ranks = transport.get_num_ranks();
+
+    // the keys are relative to the bounding box of all bodies after the integration
+    std::vector<BoundingBox> domains = gather_domains(transport, local_universe);
+    BoundingBox universe_bb = merge_domains(domains);
+
+    const std::uint32_t num_buckets = 1u << decomposition_bits;
+    std::vector<std::uint32_t> buckets(local_universe.num_bodies);
+    std::vector<std::uint32_t> bucket_counts(num_buckets, 0);
+    for (std::uint32_t body_index = 0; body_index < local_universe.num_bodies; body_index++) {
+        buckets[body_index] = get_morton_key(local_universe.positions[body_index], universe_bb) >> (64 - decomposition_bits);
+        bucket_counts[buckets[body_index]]++;
+    }
+
+    // every rank sums up the same histograms, so all ranks agree on the key ranges
+    MessageBuffer histogram_message;
+    histogram_message.write_vector(bucket_counts);
+    std::vector<MessageBuffer> histograms = all_gather(transport, MessageTag::key_histogram, histogram_message);
+    std::vector<std::uint32_t> rank_counts;
+    std::fill(bucket_counts.begin(), bucket_counts.end(), 0);
+    for (auto& histogram : histograms) {
+        histogram.read_vector(rank_counts);
+        for (std::uint32_t bucket = 0; bucket < num_buckets; bucket++) {
+            bucket_counts[bucket] += rank_counts[bucket];
+        }
+    }
+    std::vector<std::uint32_t> key_ranges = get_key_ranges(bucket_counts, num_ranks);
+
+    std::vector<std::vector<MigratingBody>> outgoing(num_ranks);
+    for (std::uint32_t body_index = 0; body_index < local_universe.num_bodies; body_index++) {
+        std::int32_t destination = std::upper_bound(key_ranges.begin() + 1, key_ranges.end() - 1, buckets[body_index]) - (key_ranges.begin() + 1);
+        outgoing[destination].push_back(get_migrating_body(local_universe, body_index, owned_bodies[body_index]));
+    }
+    for (std::int32_t destination = 0; destination < num_ranks; destination++) {
+        if (destination != rank) {
+            MessageBuffer message;
+            message.write_vector(outgoing[destination]);
+            transport.send(destination, MessageTag::migration, std::move(message));
+        }
+    }
+
+    // bodies are appended in rank order, the result does not depend on the arrival order
+    migrated_bodies.clear();
+    std::vector<MigratingBody> incoming;
+    for (std::int32_t source = 0; source < num_ranks; source++) {
+        if (source == rank) {
+            incoming = outgoing[rank];
+        } else {
+            transport.receive(source, MessageTag::migration).read_vector(incoming);
+        }
+        migrated_bodies.insert(migrated_bodies.end(), incoming.begin(), incoming.end());
+    }
+
+    local_universe = Universe();
+    owned_bodies.clear();
+    for (auto& body : migrated_bodies) {
+        append_body(local_universe, Vector2d<double>(body.position_x, body.position_y), Vector2d<double>(body.velocity_x, body.velocity_y), Vector2d<double>(body.force_x, body.force_y), body.weight);
+        owned_bodies.push_back(body.body_identifier);
+    }
+}
+
+void DistributedBarnesHutSimulation::simulate_rank_epoch(Transport& transport, Universe& universe, std::vector<std::int32_t>& owned_bodies, SimulationContext& rank_context, SimulationContext& phase_context){
+    const std::int32_t rank = transport.get_rank();
+    const std::int32_t num_ranks = transport.get_num_ranks();
+    const double threshold_theta = BarnesHutSimulation::default_threshold_theta;
+
+    // scatter: the rank copies its bodies, afterwards data only moves through the transport
+    Universe local_universe;
+    for (auto body_identifier : owned_bodies) {
+        append_body(local_universe, universe.positions[body_identifier], universe.velocities[body_identifier], Vector2d<double>(0, 0), universe.weights[body_identifier]);
+    }
+
+    ScopedPhaseTimer bounding_box_timer(phase_context, SimulationPhase::bounding_box);
+    std::vector<BoundingBox> domains = gather_domains(transport, local_universe);
+    BoundingBox universe_bb = merge_domains(domains);
+    bounding_box_timer.stop();
+
+    // locally essential trees: every rank sends the others the parts of its tree they need
+    ScopedPhaseTimer tree_build_timer(phase_context, SimulationPhase::tree_build);
+    std::vector<std::vector<EssentialNode>> exported_nodes(num_ranks);
+    if (local_universe.num_bodies > 0) {
+        rank_context.prepare(local_universe);
+        rank_context.reset_body_indices(local_universe);
+        Quadtree local_tree(local_universe, domains[rank], rank_context.node_arena, rank_context.body_indices);
+        local_tree.root->aggregate_mass();
+        for (std::int32_t destination = 0; destination < num_ranks; destination++) {
+            if (destination != rank) {
+                export_essential_nodes(local_tree.root, domains[destination], threshold_theta, exported_nodes[destination]);
+            }
+        }
+    }
+    for (std::int32_t destination = 0; destination < num_ranks; destination++) {
+        if (destination != rank) {
+            MessageBuffer message;
+            message.write_vector(exported_nodes[destination]);
+            transport.send(destination, MessageTag::essential_tree, std::move(message));
+        }
+    }
+
+    // the force tree holds the own bodies first, followed by the essential nodes of the other ranks
+    Universe force_universe = local_universe;
+    std::vector<EssentialNode> imported_nodes;
+    for (std::int32_t source = 0; source < num_ranks; source++) {
+        if (source == rank) {
+            continue;
+        }
+        transport.receive(source, MessageTag::essential_tree).read_vector(imported_nodes);
+        for (auto& node : imported_nodes) {
+            append_body(force_universe, Vector2d<double>(node.center_of_mass_x, node.center_of_mass_y), Vector2d<double>(0, 0), Vector2d<double>(0, 0), node.mass);
+        }
+    }
+
+    rank_context.prepare(force_universe);
+    rank_context.reset_body_indices(force_universe);
+    if (local_universe.num_bodies > 0) {
+        Quadtree force_tree(force_universe, universe_bb, rank_context.node_arena, rank_context.body_indices);
+        rank_context.tree_depth = force_tree.depth;
+        rank_context.tree_nodes = rank_context.node_arena.get_used_nodes();
+        tree_build_timer.stop();
+
+        ScopedPhaseTimer mass_aggregation_timer(phase_context, SimulationPhase::mass_aggregation);
+        force_tree.root->aggregate_mass();
+        mass_aggregation_timer.stop();
+
+        ScopedPhaseTimer force_calculation_timer(phase_context, SimulationPhase::force_calculation);
+#pragma omp parallel
+        {
+            ThreadScratch& scratch = rank_context.get_thread_scratch(omp_get_thread_num());
+#pragma omp for
+            for (std::int32_t body_index = 0; body_index < static_cast<std::int32_t>(local_universe.num_bodies); body_index++) {
+                BarnesHutSimulation::calculate_force(force_universe, force_tree, rank_context, scratch, body_index, threshold_theta);
+            }
+        }
+        std::copy(force_universe.forces.begin(), force_universe.forces.begin() + local_universe.num_bodies, local_universe.forces.begin());
+        force_calculation_timer.stop();
+    }
+    tree_build_timer.stop();
+
+    ScopedPhaseTimer integration_timer(phase_context, SimulationPhase::integration);
+    NaiveParallelSimulation::calculate_velocities(local_universe);
+    NaiveParallelSimulation::calculate_positions(local_universe);
+    integration_timer.stop();
+
+    std::vector<MigratingBody> migrated_bodies;
+    migrate_bodies(transport, local_universe, owned_bodies, migrated_bodies);
+
+    // gather: rank 0 writes the bodies of all ranks back to the global universe
+    if (rank != 0) {
+        MessageBuffer message;
+        message.write_vector(migrated_bodies);
+        transport.send(0, MessageTag::gather, std::move(message));
+        return;
+    }
+    std::vector<MigratingBody> gathered_bodies;
+    for (std::int32_t source = 0; source < num_ranks; source++) {
+        if (source == 0) {
+            gathered_bodies = migrated_bodies;
+        } else {
+            transport.receive(source, MessageTag::gather).read_vector(gathered_bodies);
+        }
+        for (auto& body : gathered_bodies) {
+            universe.positions[body.body_identifier] = Vector2d<double>(body.position_x, body.position_y);
+            universe.velocities[body.body_identifier] = Vector2d<double>(body.velocity_x, body.velocity_y);
+            universe.forces[body.body_identifier] = Vector2d<double>(body.force_x, body.force_y);
+        }
+    }
+}
+
+
+DistributedBarnesHutEngine::DistributedBarnesHutEngine(std::int32_t arg_num_ranks){
+    set_num_ranks(arg_num_ranks);
+}
+
+DistributedBarnesHutEngine::~DistributedBarnesHutEngine(){
+    stop_rank_threads();
+}
+
+void DistributedBarnesHutEngine::set_num_ranks(std::int32_t arg_num_ranks){
+    if (arg_num_ranks < 1) {
+        throw std::invalid_argument("at least one rank is required, got " + std::to_string(arg_num_ranks));
+    }
+    stop_rank_threads();
+    num_ranks = arg_num_ranks;
+    owned_bodies.clear();
+    rank_contexts.clear();
+}
+
+std::int32_t DistributedBarnesHutEngine::get_num_ranks() const{
+    return num_ranks;
+}
+
+std::string DistributedBarnesHutEngine::get_name() const{
+    return "distributed_barnes_hut";
+}
+
+EngineCapabilities DistributedBarnesHutEngine::get_capabilities() const{
+    EngineCapabilities capabilities;
+    // messages are matched by source rank, the arrival order does not influence the result
+    capabilities.deterministic = true;
+    capabilities.parallel = true;
+    capabilities.uses_quadtree = true;
+    return capabilities;
+}
+
+void DistributedBarnesHutEngine::simulate_epoch(Universe& universe, SimulationContext& context){
+    std::size_t owned_count = 0;
+    for (auto& bodies : owned_bodies) {
+        owned_count += bodies.size();
+    }
+    if (owned_bodies.size() != static_cast<std::size_t>(num_ranks) || owned_count != universe.num_bodies) {
+        // new universe: contiguous blocks of ids, the first migration sorts them into key ranges
+        owned_bodies.assign(num_ranks, {});
+        for (std::int32_t rank = 0; rank < num_ranks; rank++) {
+            std::uint64_t begin = static_cast<std::uint64_t>(universe.num_bodies) * rank / num_ranks;
+            std::uint64_t end = static_cast<std::uint64_t>(universe.num_bodies) * (rank + 1) / num_ranks;
+            for (std::uint64_t body_identifier = begin; body_identifier < end; body_identifier++) {
+                owned_bodies[rank].push_back(body_identifier);
+            }
+        }
+    }
+    if (rank_contexts.size() != static_cast<std::size_t>(num_ranks)) {
+        rank_contexts = std::vector<SimulationContext>(num_ranks);
+    }
+    universe.forces.resize(universe.num_bodies);
+
+    if (rank_threads.empty()) {
+        start_rank_threads();
+    }
+    {
+        std::lock_guard<std::mutex> lock(epoch_mutex);
+        epoch_universe = &universe;
+        epoch_context = &context;
+        // the OpenMP threads are split between the ranks
+        threads_per_rank = std::max(1, omp_get_max_threads() / num_ranks);
+        num_finished_ranks = 0;
+        num_started_epochs++;
+    }
+    epoch_started.notify_all();
+    {
+        std::unique_lock<std::mutex> lock(epoch_mutex);
+        epoch_finished.wait(lock, [this]() { return num_finished_ranks == num_ranks; });
+    }
+    std::exception_ptr first_error;
+    for (auto& error : rank_errors) {
+        if (error && !first_error) {
+            first_error = error;
+        }
+        error = nullptr;
+    }
+    if (first_error) {
+        // an aborted hub may still hold messages of the failed epoch
+        hub = std::make_unique<InProcessTransportHub>(num_ranks);
+        std::rethrow_exception(first_error);
+    }
+
+    // the counters of every rank are reported as one thread
+    context.prepare(universe);
+    for (std::int32_t rank = 0; rank < num_ranks; rank++) {
+        ThreadCounters& counters = context.get_thread_scratch(rank % context.thread_scratch.size()).counters;
+        for (auto& scratch : rank_contexts[rank].thread_scratch) {
+            counters.nodes_visited += scratch.counters.nodes_visited;
+            counters.interactions += scratch.counters.interactions;
+        }
+        context.tree_depth = std::max(context.tree_depth, rank_contexts[rank].tree_depth);
+        context.tree_nodes += rank_contexts[rank].tree_nodes;
+    }
+
+    universe.current_simulation_epoch++;
+}
+
+void DistributedBarnesHutEngine::start_rank_threads(){
+    hub = std::make_unique<InProcessTransportHub>(num_ranks);
+    rank_errors.assign(num_ranks, nullptr);
+    num_started_epochs = 0;
+    for (std::int32_t rank = 0; rank < num_ranks; rank++) {
+        rank_threads.emplace_back([this, rank]() { run_rank(rank); });
+    }
+}
+
+void DistributedBarnesHutEngine::stop_rank_threads(){
+    {
+        std::lock_guard<std::mutex> lock(epoch_mutex);
+        stopping = true;
+    }
+    epoch_started.notify_all();
+    for (auto& rank_thread : rank_threads) {
+        rank_thread.join();
+    }
+    rank_threads.clear();
+    stopping = false;
+}
+
+void DistributedBarnesHutEngine::run_rank(std::int32_t rank){
+    std::uint64_t num_finished_epochs = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(epoch_mutex);
+            epoch_started.wait(lock, [&]() { return stopping || num_started_epochs > num_finished_epochs; });
+            if (stopping) {
+                return;
+            }
+        }
+
+        try {
+            omp_set_num_threads(threads_per_rank);
+            rank_contexts[rank].reset_counters();
+            InProcessTransport transport(*hub, rank);
+            // only rank 0 reports its phases, the observers are not thread safe
+            SimulationContext& phase_context = rank == 0 ? *epoch_context : rank_contexts[rank];
+            DistributedBarnesHutSimulation::simulate_rank_epoch(transport, *epoch_universe, owned_bodies[rank], rank_contexts[rank], phase_context);
+        } catch (...) {
+            rank_errors[rank] = std::current_exception();
+            hub->abort();
+        }
+        num_finished_epochs++;
+
+        {
+            std::lock_guard<std::mutex> lock(epoch_mutex);
+            num_finished_ranks++;
+        }
+        epoch_finished.notify_all();
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "structures/universe.h"
+#include "quadtree/quadtree.h"
+#include "distributed/transport.h"
+#include "distributed/in_process_transport.h"
+#include "simulation/simulation_context.h"
+#include "simulation/simulation_engine.h"
+
+// a body moved between ranks, trivially copyable so it can be sent as is
+struct MigratingBody {
+    std::int32_t body_identifier;
+    double position_x, position_y;
+    double velocity_x, velocity_y;
+    double force_x, force_y;
+    double weight;
+};
+
+// a node of the locally essential tree: a single remote body or the aggregate of a remote subtree
+struct EssentialNode {
+    double center_of_mass_x, center_of_mass_y;
+    double mass;
+};
+
+// Barnes-Hut distributed over ranks that only communicate through a Transport. Every rank owns a
+// contiguous range of Morton keys, builds a tree of its own bodies and sends every other rank the
+// part of it that rank needs (its locally essential tree). After the integration bodies that left
+// the key range of their rank migrate to the new owner.
+class DistributedBarnesHutSimulation {
+public:
+    // top bits of the Morton key used to balance the key ranges
+    static constexpr std::uint32_t decomposition_bits = 16;
+
+    // One epoch of a single rank. owned_bodies holds the global ids of the bodies of the rank and is
+    // updated by the migration. The rank reads its bodies from universe, rank 0 gathers the results
+    // into it. Phase timings of the rank are reported to phase_context.
+    static void simulate_rank_epoch(Transport& transport, Universe& universe, std::vector<std::int32_t>& owned_bodies, SimulationContext& rank_context, SimulationContext& phase_context);
+
+    // nodes of the tree below root that a rank owning remote_domain needs for its forces
+    static void export_essential_nodes(QuadtreeNode* root, BoundingBox remote_domain, double threshold_theta, std::vector<EssentialNode>& essential_nodes);
+
+    // bounding boxes of the bodies of all ranks, an empty rank has an inverted box
+    static std::vector<BoundingBox> gather_domains(Transport& transport, Universe& local_universe);
+
+    // rank owning each decomposition bucket, balanced by the number of bodies per bucket.
+    // Returns num_ranks + 1 bucket boundaries.
+    static std::vector<std::uint32_t> get_key_ranges(const std::vector<std::uint32_t>& bucket_counts, std::int32_t num_ranks);
+
+    static void migrate_bodies(Transport& transport, Universe& local_universe, std::vector<std::int32_t>& owned_bodies, std::vector<MigratingBody>& migrated_bodies);
+};
+
+// Runs every rank as a thread of this process. The rank threads and their mailboxes are created by
+// the first epoch and kept until the engine is destroyed or the number of ranks changes, every epoch
+// only hands the universe to the waiting threads.
+class DistributedBarnesHutEngine : public SimulationEngine {
+public:
+    explicit DistributedBarnesHutEngine(std::int32_t arg_num_ranks = 4);
+    ~DistributedBarnesHutEngine() override;
+
+    DistributedBarnesHutEngine(const DistributedBarnesHutEngine&) = delete;
+    DistributedBarnesHutEngine& operator=(const DistributedBarnesHutEngine&) = delete;
+
+    [[nodiscard]] std::string get_name() const override;
+    [[nodiscard]] EngineCapabilities get_capabilities() const override;
+    void simulate_epoch(Universe& universe, SimulationContext& context) override;
+
+    void set_num_ranks(std::int32_t arg_num_ranks);
+    [[nodiscard]] std::int32_t get_num_ranks() const;
+
+private:
+    void start_rank_threads();
+    void stop_rank_threads();
+    void run_rank(std::int32_t rank);
+
+    std::int32_t num_ranks;
+    // global ids of the bodies of every rank, kept across epochs so the decomposition carries over
+    std::vector<std::vector<std::int32_t>> owned_bodies;
+    std::vector<SimulationContext> rank_contexts;
+
+    std::unique_ptr<InProcessTransportHub> hub;
+    std::vector<std::thread> rank_threads;
+    std::mutex epoch_mutex;
+    std::condition_variable epoch_started;
+    std::condition_variable epoch_finished;
+    // the epoch handed to the rank threads, only changed while all ranks wait for the next epoch
+    std::uint64_t num_started_epochs = 0;
+    std::int32_t num_finished_ranks = 0;
+    bool stopping = false;
+    Universe* epoch_universe = nullptr;
+    SimulationContext* epoch_context = nullptr;
+    std::int32_t threads_per_rank = 1;
+    std::vector<std::exception_ptr> rank_errors;
+};
@@ -0,0 +1,71 @@
+#include "simulation/force_schedule.h"
+
+#include <stdexcept>
+#include <string>
+
+ForceSchedule get_force_schedule(std::uint32_t schedule_id){
+    switch (schedule_id) {
+        case 0:
+            return ForceSchedule::static_schedule;
+        case 1:
+            return ForceSchedule::dynamic;
+        case 2:
+            return ForceSchedule::guided;
+        case 3:
+            return ForceSchedule::cost_weighted;
+        case 4:
+            return ForceSchedule::cost_zones;
+        default:
+            throw std::invalid_argument("unknown force schedule: " + std::to_string(schedule_id));
+    }
+}
+
+const char* get_force_schedule_name(ForceSchedule schedule){
+    switch (schedule) {
+        case ForceSchedule::static_schedule:
+            return "static";
+        case ForceSchedule::dynamic:
+            return "dynamic";
+        case ForceSchedule::guided:
+            return "guided";
+        case ForceSchedule::cost_weighted:
+            return "cost_weighted";
+        case ForceSchedule::cost_zones:
+            return "cost_zones";
+    }
+    return "unknown";
+}
+
+template<typename CostFunction>
+static void partition_positions_by_cost(std::int32_t num_positions, CostFunction get_cost, std::int32_t num_parts, std::vector<std::int32_t>& boundaries){
+    boundaries.resize(num_parts + 1);
+
+    // every body costs at least one unit, so bodies without interactions are still spread evenly
+    std::uint64_t total_cost = 0;
+    for (std::int32_t position = 0; position < num_positions; position++) {
+        total_cost += get_cost(position) + 1;
+    }
+
+    // close part p as soon as the prefix sum reaches p/num_parts of the total cost
+    boundaries[0] = 0;
+    std::int32_t part = 1;
+    std::uint64_t prefix_cost = 0;
+    for (std::int32_t position = 0; position < num_positions && part < num_parts; position++) {
+        prefix_cost += get_cost(position) + 1;
+        while (part < num_parts && prefix_cost * num_parts >= total_cost * part) {
+            boundaries[part] = position + 1;
+            part++;
+        }
+    }
+    for (; part <= num_parts; part++) {
+        boundaries[part] = num_positions;
+    }
+}
+
+void partition_by_cost(const std::vector<std::uint32_t>& costs, std::int32_t num_parts, std::vector<std::int32_t>& boundaries){
+    partition_positions_by_cost(costs.size(), [&costs](std::int32_t body_index) -> std::uint64_t { return costs[body_index]; }, num_parts, boundaries);
+}
+
+void partition_by_cost(const std::vector<std::uint32_t>& costs, const std::vector<std::int32_t>& order, std::int32_t num_parts, std::vector<std::int32_t>& boundaries){
+    partition_positions_by_cost(order.size(), [&costs, &order](std::int32_t position) -> std::uint64_t { return costs[order[position]]; }, num_parts, boundaries);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// distribution of the bodies of the force phase to the threads
+enum class ForceSchedule : std::uint8_t {
+    static_schedule,
+    dynamic,
+    guided,
+    // contiguous ranges of equal cost, weighted by the interactions of the previous epoch
+    cost_weighted,
+    // cost zones: contiguous ranges of equal cost along the Morton order of the quadtree leaves, so
+    // every thread walks the tree for a spatially coherent set of bodies
+    cost_zones
+};
+
+struct ForceScheduleOptions {
+    ForceSchedule schedule = ForceSchedule::static_schedule;
+    // chunk size of the dynamic and guided schedule, 0 selects the OpenMP default
+    std::int32_t chunk_size = 0;
+};
+
+// maps the --force-schedule ids to schedules
+[[nodiscard]] ForceSchedule get_force_schedule(std::uint32_t schedule_id);
+[[nodiscard]] const char* get_force_schedule_name(ForceSchedule schedule);
+
+// Splits the bodies 0..costs.size()-1 into num_parts contiguous ranges with roughly equal summed
+// cost. boundaries receives num_parts + 1 entries, part p covers [boundaries[p], boundaries[p + 1]).
+void partition_by_cost(const std::vector<std::uint32_t>& costs, std::int32_t num_parts, std::vector<std::int32_t>& boundaries);
+// Same as above, but position i of the split sequence is body order[i], e.g. the tree order of the
+// quadtree leaves.
+void partition_by_cost(const std::vector<std::uint32_t>& costs, const std::vector<std::int32_t>& order, std::int32_t num_parts, std::vector<std::int32_t>& boundaries);
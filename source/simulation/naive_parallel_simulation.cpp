@@ -1,55 +1,75 @@
 #include "simulation/naive_parallel_simulation.h"
+#include "simulation/simulation_driver.h"
 #include "physics/gravitation.h"
 #include "physics/mechanics.h"
 
 #include <cmath>
+#include <omp.h>
 
 void NaiveParallelSimulation::simulate_epochs(Plotter& plotter, Universe& universe, std::uint32_t num_epochs, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
-    for(int i = 0; i < num_epochs; i++){
-        simulate_epoch(plotter, universe, create_intermediate_plots, plot_intermediate_epochs);
-    }
+    NaiveParallelEngine engine;
+    SimulationContext context(universe);
+    SimulationDriver::simulate_epochs(engine, plotter, universe, context, num_epochs, create_intermediate_plots, plot_intermediate_epochs);
 }
 
 void NaiveParallelSimulation::simulate_epoch(Plotter& plotter, Universe& universe, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
-    calculate_forces(universe);
-    calculate_velocities(universe);
-    calculate_positions(universe);
-    universe.current_simulation_epoch++;
-    if(create_intermediate_plots){
-        if(universe.current_simulation_epoch % plot_intermediate_epochs == 0){
-            plotter.add_bodies_to_image(universe);
-            plotter.write_and_clear();
-        }
+    NaiveParallelEngine engine;
+    SimulationContext context(universe);
+    SimulationDriver::simulate_epoch(engine, plotter, universe, context, create_intermediate_plots, plot_intermediate_epochs);
+}
+
+void NaiveParallelSimulation::simulate_epoch(Universe& universe, SimulationContext& context){
+    context.prepare(universe);
+    {
+        ScopedPhaseTimer timer(context, SimulationPhase::force_calculation);
+        calculate_forces(universe, context);
+    }
+    {
+        ScopedPhaseTimer timer(context, SimulationPhase::integration);
+        calculate_velocities(universe);
+        calculate_positions(universe);
     }
+    universe.current_simulation_epoch++;
 }
 
 
 void NaiveParallelSimulation::calculate_forces(Universe& universe){
+    SimulationContext context(universe);
+    calculate_forces(universe, context);
+}
+
+void NaiveParallelSimulation::calculate_forces(Universe& universe, SimulationContext& context){
     std::size_t num_bodies = universe.num_bodies;
-    universe.forces.clear();
-    universe.forces.resize(num_bodies, Vector2d<double>(0, 0));
+    // every force is overwritten below, only grow the buffer if necessary
+    universe.forces.resize(num_bodies);
 
     // Song song hóa vòng lặp ngoài với OpenMP
-#pragma omp parallel for
-    for (size_t i = 0; i < num_bodies; i++) {
-        Vector2d<double> force_sum(0, 0); // Lực tổng cho body thứ i
-
-        for (size_t j = 0; j < num_bodies; j++) {
-            if (i == j) continue; // Bỏ qua lực của chính nó
-
-            Vector2d<double> direction = universe.positions[j] - universe.positions[i];
-            double distance = sqrt(pow(direction[0], 2) + pow(direction[1], 2));
-
-            if (distance > 0) {
-                direction = direction / distance;
-                double force_magnitude = gravitational_force(universe.weights[i], universe.weights[j], distance);
-                Vector2d<double> force = direction * force_magnitude;
-                force_sum = force_sum + force;
+#pragma omp parallel
+    {
+        ThreadCounters& counters = context.get_thread_scratch(omp_get_thread_num()).counters;
+
+#pragma omp for
+        for (size_t i = 0; i < num_bodies; i++) {
+            Vector2d<double> force_sum(0, 0); // Lực tổng cho body thứ i
+
+            for (size_t j = 0; j < num_bodies; j++) {
+                if (i == j) continue; // Bỏ qua lực của chính nó
+
+                Vector2d<double> direction = universe.positions[j] - universe.positions[i];
+                double distance = sqrt(pow(direction[0], 2) + pow(direction[1], 2));
+
+                if (distance > 0) {
+                    direction = direction / distance;
+                    double force_magnitude = gravitational_force(universe.weights[i], universe.weights[j], distance);
+                    Vector2d<double> force = direction * force_magnitude;
+                    force_sum = force_sum + force;
+                }
             }
-        }
 
-        // Cập nhật lực vào danh sách lực của universe
-        universe.forces[i] = force_sum;
+            // Cập nhật lực vào danh sách lực của universe
+            universe.forces[i] = force_sum;
+            counters.interactions += num_bodies - 1;
+        }
     }
 }
 
@@ -88,4 +108,22 @@ void NaiveParallelSimulation::calculate_positions(Universe& universe){
         // Cập nhật vị trí mới vào universe
         universe.positions[i] = new_position;
     }
+}
+
+
+std::string NaiveParallelEngine::get_name() const{
+    return "naive_parallel";
+}
+
+EngineCapabilities NaiveParallelEngine::get_capabilities() const{
+    EngineCapabilities capabilities;
+    // every force is summed up by a single thread in a fixed order
+    capabilities.deterministic = true;
+    capabilities.parallel = true;
+    capabilities.quadratic_cost = true;
+    return capabilities;
+}
+
+void NaiveParallelEngine::simulate_epoch(Universe& universe, SimulationContext& context){
+    NaiveParallelSimulation::simulate_epoch(universe, context);
 }
\ No newline at end of file
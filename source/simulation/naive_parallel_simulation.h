@@ -3,12 +3,23 @@
 
 #include "structures/universe.h"
 #include "plotting/plotter.h"
+#include "simulation/simulation_context.h"
+#include "simulation/simulation_engine.h"
 
 class NaiveParallelSimulation{
 public:
     static void simulate_epochs(Plotter& plotter, Universe& universe, std::uint32_t num_epochs, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs);
     static void simulate_epoch(Plotter& plotter, Universe& universe, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs);
+    static void simulate_epoch(Universe& universe, SimulationContext& context);
     static void calculate_velocities(Universe& universe);
     static void calculate_positions(Universe& universe);
     static void calculate_forces(Universe& universe);
+    static void calculate_forces(Universe& universe, SimulationContext& context);
+};
+
+class NaiveParallelEngine : public SimulationEngine {
+public:
+    [[nodiscard]] std::string get_name() const override;
+    [[nodiscard]] EngineCapabilities get_capabilities() const override;
+    void simulate_epoch(Universe& universe, SimulationContext& context) override;
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "simulation/naive_sequential_simulation.h"
 #include "simulation/constants.h"
+#include "simulation/simulation_driver.h"
 #include "physics/gravitation.h"
 #include "physics/mechanics.h"
 
@@ -8,22 +9,30 @@
 
 
 void NaiveSequentialSimulation::simulate_epochs(Plotter& plotter, Universe& universe, std::uint32_t num_epochs, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
-    for(int i = 0; i < num_epochs; i++){
-        simulate_epoch(plotter, universe, create_intermediate_plots, plot_intermediate_epochs);
-    }
+    NaiveSequentialEngine engine;
+    SimulationContext context(universe);
+    SimulationDriver::simulate_epochs(engine, plotter, universe, context, num_epochs, create_intermediate_plots, plot_intermediate_epochs);
 }
 
 void NaiveSequentialSimulation::simulate_epoch(Plotter& plotter, Universe& universe, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
-    calculate_forces(universe);
-    calculate_velocities(universe);
-    calculate_positions(universe);
-    universe.current_simulation_epoch++;
-    if(create_intermediate_plots){
-        if((universe.current_simulation_epoch % plot_intermediate_epochs) == 0){
-            plotter.add_bodies_to_image(universe);
-            plotter.write_and_clear();
-        }
+    NaiveSequentialEngine engine;
+    SimulationContext context(universe);
+    SimulationDriver::simulate_epoch(engine, plotter, universe, context, create_intermediate_plots, plot_intermediate_epochs);
+}
+
+void NaiveSequentialSimulation::simulate_epoch(Universe& universe, SimulationContext& context){
+    {
+        ScopedPhaseTimer timer(context, SimulationPhase::force_calculation);
+        calculate_forces(universe);
+        // every body interacts with all other bodies
+        context.get_thread_scratch(0).counters.interactions += static_cast<std::uint64_t>(universe.num_bodies) * (universe.num_bodies - 1);
+    }
+    {
+        ScopedPhaseTimer timer(context, SimulationPhase::integration);
+        calculate_velocities(universe);
+        calculate_positions(universe);
     }
+    universe.current_simulation_epoch++;
 }
 
 
@@ -89,3 +98,19 @@ void NaiveSequentialSimulation::calculate_positions(Universe& universe){
         universe.positions[body_idx] = new_position;
     }
 }
+
+
+std::string NaiveSequentialEngine::get_name() const{
+    return "naive_sequential";
+}
+
+EngineCapabilities NaiveSequentialEngine::get_capabilities() const{
+    EngineCapabilities capabilities;
+    capabilities.deterministic = true;
+    capabilities.quadratic_cost = true;
+    return capabilities;
+}
+
+void NaiveSequentialEngine::simulate_epoch(Universe& universe, SimulationContext& context){
+    NaiveSequentialSimulation::simulate_epoch(universe, context);
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "simulation/simulation_context.h"
+
+#include <algorithm>
+#include <numeric>
+#include <omp.h>
+
+SimulationContext::SimulationContext(){
+    thread_scratch.resize(omp_get_max_threads());
+}
+
+SimulationContext::SimulationContext(Universe& universe) : SimulationContext(){
+    prepare(universe);
+}
+
+SimulationContext& SimulationContext::get_thread_context(Universe& universe){
+    thread_local SimulationContext context;
+    context.prepare(universe);
+    return context;
+}
+
+void SimulationContext::prepare(Universe& universe){
+    if (body_indices.size() != universe.num_bodies) {
+        body_indices.resize(universe.num_bodies);
+    }
+    if (body_interactions.size() != universe.num_bodies) {
+        // the old estimates belong to other bodies, start again with uniform costs
+        body_interactions.assign(universe.num_bodies, 0);
+    }
+
+    // the thread count may be changed between epochs via omp_set_num_threads
+    std::size_t num_threads = omp_get_max_threads();
+    if (thread_scratch.size() < num_threads) {
+        thread_scratch.resize(num_threads);
+    }
+}
+
+void SimulationContext::reset_body_indices(Universe& universe){
+    std::iota(body_indices.begin(), body_indices.begin() + universe.num_bodies, 0);
+}
+
+void SimulationContext::reset_counters(){
+    for (auto& scratch : thread_scratch) {
+        scratch.counters = ThreadCounters{};
+    }
+    tree_depth = 0;
+    tree_nodes = 0;
+    tree_root = nullptr;
+    force_threads = 0;
+}
+
+double SimulationContext::get_load_imbalance() const{
+    if (force_threads == 0) {
+        return 0;
+    }
+    double max_busy = 0;
+    double sum_busy = 0;
+    for (std::int32_t thread_id = 0; thread_id < force_threads; thread_id++) {
+        max_busy = std::max(max_busy, thread_scratch[thread_id].counters.busy_seconds);
+        sum_busy += thread_scratch[thread_id].counters.busy_seconds;
+    }
+    if (sum_busy == 0) {
+        return 0;
+    }
+    return max_busy / (sum_busy / force_threads) - 1;
+}
+
+void SimulationContext::add_observer(SimulationObserver* observer){
+    observers.push_back(observer);
+}
+
+void SimulationContext::remove_observer(SimulationObserver* observer){
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
+void SimulationContext::notify_epoch_begin(Universe& universe){
+    reset_counters();
+    for (auto observer : observers) {
+        observer->on_epoch_begin(universe, *this);
+    }
+}
+
+void SimulationContext::notify_phase_begin(SimulationPhase phase){
+    for (auto observer : observers) {
+        observer->on_phase_begin(phase);
+    }
+}
+
+void SimulationContext::notify_phase_end(SimulationPhase phase, double seconds){
+    for (auto observer : observers) {
+        observer->on_phase_end(phase, seconds);
+    }
+}
+
+void SimulationContext::notify_epoch_end(Universe& universe){
+    for (auto observer : observers) {
+        observer->on_epoch_end(universe, *this);
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "structures/universe.h"
+#include "quadtree/quadtreeNode.h"
+#include "quadtree/quadtreeNodeArena.h"
+#include "simulation/force_schedule.h"
+#include "simulation/simulation_observer.h"
+
+// work done by a single thread during the current epoch
+struct ThreadCounters {
+    std::uint64_t nodes_visited = 0;
+    std::uint64_t interactions = 0;
+    // wall time the thread spent on its share of the force loop
+    double busy_seconds = 0;
+};
+
+// scratch memory of a single OpenMP thread, aligned to a cache line as the counters are written concurrently
+struct alignas(64) ThreadScratch {
+    std::vector<QuadtreeNode*> traversal_stack;
+    std::vector<QuadtreeNode*> relevant_nodes;
+    ThreadCounters counters;
+};
+
+// Owns all buffers the engines need per epoch. Created once per run and handed to every epoch, so
+// the buffers only grow during the first epochs and the steady-state epoch loop does not allocate.
+class SimulationContext {
+public:
+    SimulationContext();
+    explicit SimulationContext(Universe& universe);
+
+    // context of the calling thread, prepared for the universe. Used by the entry points without a
+    // context parameter, so repeated calls reuse the buffers of the previous call.
+    static SimulationContext& get_thread_context(Universe& universe);
+
+    // adapt the buffers to the current body and thread count, no-op if nothing changed
+    void prepare(Universe& universe);
+    // refill body_indices with 0..num_bodies-1
+    void reset_body_indices(Universe& universe);
+
+    ThreadScratch& get_thread_scratch(std::int32_t thread_id){
+        return thread_scratch[thread_id];
+    }
+
+    // called at the beginning of every epoch by notify_epoch_begin
+    void reset_counters();
+
+    void add_observer(SimulationObserver* observer);
+    void remove_observer(SimulationObserver* observer);
+
+    [[nodiscard]] bool has_observers() const{
+        return !observers.empty();
+    }
+
+    // max/mean - 1 of the busy time of the threads of the last force loop, 0 means perfectly balanced
+    [[nodiscard]] double get_load_imbalance() const;
+
+    void notify_epoch_begin(Universe& universe);
+    void notify_phase_begin(SimulationPhase phase);
+    void notify_phase_end(SimulationPhase phase, double seconds);
+    void notify_epoch_end(Universe& universe);
+
+    std::vector<std::int32_t> body_indices;
+    std::vector<ThreadScratch> thread_scratch;
+    QuadtreeNodeArena node_arena;
+
+    // statistics of the tree of the current epoch, set by the engines using a quadtree
+    std::uint32_t tree_depth = 0;
+    std::size_t tree_nodes = 0;
+    // aggregated tree of the current epoch, built from the positions before the integration. The
+    // nodes live in node_arena and stay valid until the next tree is built.
+    QuadtreeNode* tree_root = nullptr;
+
+    ForceScheduleOptions force_schedule;
+    // nodes each body interacted with in the last force loop, kept across epochs as cost estimate
+    std::vector<std::uint32_t> body_interactions;
+    // per-thread body ranges of the cost weighted schedule
+    std::vector<std::int32_t> cost_partition;
+    // number of threads of the last force loop
+    std::int32_t force_threads = 0;
+
+private:
+    std::vector<SimulationObserver*> observers;
+};
+
+// Measures the wall time of a phase until stop() or the end of the scope and reports it to the
+// observers of the context. Without observers no clock is read.
+class ScopedPhaseTimer {
+public:
+    ScopedPhaseTimer(SimulationContext& arg_context, SimulationPhase arg_phase)
+        : context(arg_context), phase(arg_phase), running(arg_context.has_observers()) {
+        if (running) {
+            context.notify_phase_begin(phase);
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedPhaseTimer(){
+        stop();
+    }
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+    void stop(){
+        if (!running) {
+            return;
+        }
+        running = false;
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        context.notify_phase_end(phase, elapsed.count());
+    }
+
+private:
+    SimulationContext& context;
+    SimulationPhase phase;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,20 @@
+#include "simulation/simulation_driver.h"
+
+void SimulationDriver::simulate_epochs(SimulationEngine& engine, Plotter& plotter, Universe& universe, SimulationContext& context, std::uint32_t num_epochs, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
+    for(std::uint32_t i = 0; i < num_epochs; i++){
+        simulate_epoch(engine, plotter, universe, context, create_intermediate_plots, plot_intermediate_epochs);
+    }
+}
+
+void SimulationDriver::simulate_epoch(SimulationEngine& engine, Plotter& plotter, Universe& universe, SimulationContext& context, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs){
+    context.notify_epoch_begin(universe);
+
+    engine.simulate_epoch(universe, context);
+
+    if(create_intermediate_plots && (universe.current_simulation_epoch % plot_intermediate_epochs == 0)){
+        ScopedPhaseTimer timer(context, SimulationPhase::plotting);
+        plotter.plot_frame(universe, context.tree_root);
+    }
+
+    context.notify_epoch_end(universe);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+#include "structures/universe.h"
+#include "plotting/plotter.h"
+#include "simulation/simulation_context.h"
+#include "simulation/simulation_engine.h"
+
+// shared epoch loop of all engines, takes care of the intermediate plots and the observer hooks
+class SimulationDriver {
+public:
+    static void simulate_epochs(SimulationEngine& engine, Plotter& plotter, Universe& universe, SimulationContext& context, std::uint32_t num_epochs, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs);
+    static void simulate_epoch(SimulationEngine& engine, Plotter& plotter, Universe& universe, SimulationContext& context, bool create_intermediate_plots, std::uint32_t plot_intermediate_epochs);
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "structures/universe.h"
+#include "simulation/simulation_context.h"
+
+// properties of an engine that callers (CLI, benchmarks, tests) can query at runtime
+struct EngineCapabilities {
+    bool supports_collisions = false;
+    // identical results independent of the number of threads
+    bool deterministic = true;
+    bool parallel = false;
+    bool uses_quadtree = false;
+    // an epoch compares every pair of bodies, too slow for millions of bodies
+    bool quadratic_cost = false;
+};
+
+// settings of the CLI passed to every engine, engines ignore the ones that do not apply to them
+struct EngineOptions {
+    // ranks the distributed engine runs as threads of this process
+    std::int32_t simulated_ranks = 4;
+};
+
+// Advances a universe by one epoch. Plotting and the epoch loop are handled by the SimulationDriver,
+// engines only update the bodies and increment current_simulation_epoch.
+class SimulationEngine {
+public:
+    virtual ~SimulationEngine() = default;
+
+    [[nodiscard]] virtual std::string get_name() const = 0;
+    [[nodiscard]] virtual EngineCapabilities get_capabilities() const = 0;
+
+    virtual void simulate_epoch(Universe& universe, SimulationContext& context) = 0;
+};
@@ -0,0 +1,55 @@
+#include "simulation/simulation_engine_registry.h"
+
+#include <stdexcept>
+
+#include "simulation/naive_sequential_simulation.h"
+#include "simulation/naive_parallel_simulation.h"
+#include "simulation/barnes_hut_simulation.h"
+#include "simulation/barnes_hut_simulation_with_collisions.h"
+#include "simulation/distributed_barnes_hut_simulation.h"
+
+SimulationEngineRegistry::SimulationEngineRegistry(){
+    register_engine(0, [](const EngineOptions&) { return std::make_unique<NaiveSequentialEngine>(); });
+    register_engine(1, [](const EngineOptions&) { return std::make_unique<NaiveParallelEngine>(); });
+    register_engine(2, [](const EngineOptions&) { return std::make_unique<BarnesHutEngine>(); });
+    register_engine(3, [](const EngineOptions&) { return std::make_unique<BarnesHutWithCollisionsEngine>(); });
+    register_engine(4, [](const EngineOptions& options) { return std::make_unique<DistributedBarnesHutEngine>(options.simulated_ranks); });
+}
+
+SimulationEngineRegistry& SimulationEngineRegistry::get_instance(){
+    static SimulationEngineRegistry registry;
+    return registry;
+}
+
+void SimulationEngineRegistry::register_engine(std::uint32_t simulation_mode, EngineFactory factory){
+    for (auto& entry : entries) {
+        if (entry.simulation_mode == simulation_mode) {
+            throw std::invalid_argument("simulation mode already registered: " + std::to_string(simulation_mode));
+        }
+    }
+
+    // query name and capabilities once, so listing the engines does not create them
+    auto engine = factory(EngineOptions{});
+    entries.push_back(Entry{simulation_mode, engine->get_name(), engine->get_capabilities(), std::move(factory)});
+}
+
+std::unique_ptr<SimulationEngine> SimulationEngineRegistry::create_engine(std::uint32_t simulation_mode, const EngineOptions& options) const{
+    for (auto& entry : entries) {
+        if (entry.simulation_mode == simulation_mode) {
+            return entry.factory(options);
+        }
+    }
+    throw std::invalid_argument("unknown simulation mode: " + std::to_string(simulation_mode));
+}
+
+const std::vector<SimulationEngineRegistry::Entry>& SimulationEngineRegistry::get_entries() const{
+    return entries;
+}
+
+std::string SimulationEngineRegistry::get_description() const{
+    std::string description;
+    for (auto& entry : entries) {
+        description += std::to_string(entry.simulation_mode) + " -> " + entry.name + ". ";
+    }
+    return description;
+}
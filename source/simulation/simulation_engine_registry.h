@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "simulation/simulation_engine.h"
+
+// Maps the --simulation-mode ids to engines. New engines are added in the constructor of the
+// registry (or at runtime via register_engine) and are then available to the CLI and the benchmarks.
+class SimulationEngineRegistry {
+public:
+    using EngineFactory = std::function<std::unique_ptr<SimulationEngine>(const EngineOptions&)>;
+
+    struct Entry {
+        std::uint32_t simulation_mode;
+        std::string name;
+        EngineCapabilities capabilities;
+        EngineFactory factory;
+    };
+
+    static SimulationEngineRegistry& get_instance();
+
+    void register_engine(std::uint32_t simulation_mode, EngineFactory factory);
+
+    [[nodiscard]] std::unique_ptr<SimulationEngine> create_engine(std::uint32_t simulation_mode, const EngineOptions& options = EngineOptions{}) const;
+    [[nodiscard]] const std::vector<Entry>& get_entries() const;
+    // "0 -> name. 1 -> name. ..." for the help text of --simulation-mode
+    [[nodiscard]] std::string get_description() const;
+
+private:
+    SimulationEngineRegistry();
+
+    std::vector<Entry> entries;
+};
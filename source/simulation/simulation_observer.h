@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class Universe;
+class SimulationContext;
+
+// phases of an epoch, engines report the phases they actually run
+enum class SimulationPhase : std::uint8_t {
+    bounding_box,
+    tree_build,
+    mass_aggregation,
+    force_calculation,
+    integration,
+    collisions,
+    plotting
+};
+
+static constexpr std::size_t num_simulation_phases = 7;
+
+[[nodiscard]] static constexpr const char* get_phase_name(SimulationPhase phase){
+    constexpr std::array<const char*, num_simulation_phases> phase_names = {
+        "bounding_box", "tree_build", "mass_aggregation", "force_calculation", "integration", "collisions", "plotting"
+    };
+    return phase_names[static_cast<std::size_t>(phase)];
+}
+
+// Hook interface to follow the progress of a simulation. Observers are registered at the
+// SimulationContext, the phase timers only read the clock if at least one observer is registered.
+class SimulationObserver {
+public:
+    virtual ~SimulationObserver() = default;
+
+    virtual void on_epoch_begin(Universe&, SimulationContext&){}
+    // called before the phase timer starts, the time spent here is not part of the phase
+    virtual void on_phase_begin(SimulationPhase){}
+    // receives the wall time of the phase in seconds
+    virtual void on_phase_end(SimulationPhase, double){}
+    virtual void on_epoch_end(Universe&, SimulationContext&){}
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include <omp.h>
+
+// Allocator for the body arrays. Linux places a page on the NUMA node of the thread that writes it
+// first, so new memory is touched in parallel with the same static partition as the
+// `#pragma omp parallel for` loops over the bodies. Every thread then finds its bodies in local
+// memory, no matter which thread fills the array afterwards. On a single node machine this only
+// costs the touch.
+template <typename T>
+class FirstTouchAllocator {
+public:
+    using value_type = T;
+
+    // smaller arrays are not worth starting a parallel region
+    static constexpr std::size_t min_touch_bytes = 1 << 20;
+
+    FirstTouchAllocator() noexcept = default;
+    template <typename U>
+    FirstTouchAllocator(const FirstTouchAllocator<U>&) noexcept {}
+
+    [[nodiscard]] T* allocate(std::size_t num_elements){
+        T* elements = static_cast<T*>(::operator new(num_elements * sizeof(T)));
+        if (num_elements * sizeof(T) >= min_touch_bytes) {
+            touch(elements, num_elements);
+        }
+        return elements;
+    }
+
+    void deallocate(T* elements, std::size_t) noexcept{
+        ::operator delete(elements);
+    }
+
+    template <typename U>
+    bool operator==(const FirstTouchAllocator<U>&) const noexcept{
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const FirstTouchAllocator<U>&) const noexcept{
+        return false;
+    }
+
+private:
+    static void touch(T* elements, std::size_t num_elements){
+        auto bytes = reinterpret_cast<volatile unsigned char*>(elements);
+        const std::int64_t num_touched = num_elements;
+        // one write per element instead of per page, so the split matches the loops over the bodies exactly
+#pragma omp parallel for schedule(static)
+        for (std::int64_t i = 0; i < num_touched; i++) {
+            bytes[i * sizeof(T)] = 0;
+        }
+    }
+};
+
+// vector type of the per-body arrays of a Universe
+template <typename T>
+using body_vector = std::vector<T, FirstTouchAllocator<T>>;
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+#include "structures/vector2d.h"
+#include "structures/bounding_box.h"
+
+// bits per axis, a key fits 64 bits
+constexpr std::uint32_t morton_bits_per_axis = 32;
+
+// spreads the 32 bits of value to the even bits of the result
+[[nodiscard]] inline std::uint64_t spread_morton_bits(std::uint32_t value){
+    std::uint64_t bits = value;
+    bits = (bits | (bits << 16)) & 0x0000FFFF0000FFFFull;
+    bits = (bits | (bits << 8)) & 0x00FF00FF00FF00FFull;
+    bits = (bits | (bits << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    bits = (bits | (bits << 2)) & 0x3333333333333333ull;
+    bits = (bits | (bits << 1)) & 0x5555555555555555ull;
+    return bits;
+}
+
+// Morton (z-order) key of a position inside the bounding box. Every pair of bits selects a quadrant
+// with the ids of BoundingBox::get_quadrant (0 top left, 1 top right, 2 bottom left, 3 bottom right),
+// so sorting by key lists the bodies in the depth-first order of the quadtree.
+[[nodiscard]] inline std::uint64_t get_morton_key(Vector2d<double> position, BoundingBox bounding_box){
+    const double cells = 4294967296.0;
+    double width = bounding_box.x_max - bounding_box.x_min;
+    double height = bounding_box.y_max - bounding_box.y_min;
+    double x = width > 0 ? (position[0] - bounding_box.x_min) / width * cells : 0;
+    double y = height > 0 ? (bounding_box.y_max - position[1]) / height * cells : 0;
+
+    // positions on the max border belong to the last cell
+    std::uint32_t cell_x = x < 0 ? 0 : (x >= cells ? 0xFFFFFFFFu : static_cast<std::uint32_t>(x));
+    std::uint32_t cell_y = y < 0 ? 0 : (y >= cells ? 0xFFFFFFFFu : static_cast<std::uint32_t>(y));
+    return (spread_morton_bits(cell_y) << 1) | spread_morton_bits(cell_x);
+}
@@ -7,6 +7,7 @@
 
 #include "structures/vector2d.h"
 #include "structures/bounding_box.h"
+#include "structures/first_touch_allocator.h"
 #include "image/bitmap_image.h"
 
 class Universe {
@@ -21,10 +22,10 @@ public:
 
 
     std::uint32_t num_bodies;
-    std::vector<double> weights;  // in kg
-    std::vector<Vector2d<double>> forces; // in N
-    std::vector<Vector2d<double>> velocities;  // in m/s
-    std::vector<Vector2d<double>> positions;  // in m
+    body_vector<double> weights;  // in kg
+    body_vector<Vector2d<double>> forces; // in N
+    body_vector<Vector2d<double>> velocities;  // in m/s
+    body_vector<Vector2d<double>> positions;  // in m
     std::uint32_t current_simulation_epoch;
 
 };
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "structures/universe.h"
+#include "structures/morton.h"
+#include "input_generator/input_generator.h"
+
+#include "distributed/in_process_transport.h"
+#include "simulation/barnes_hut_simulation.h"
+#include "simulation/naive_parallel_simulation.h"
+#include "simulation/distributed_barnes_hut_simulation.h"
+
+class DistributedTest : public LabTest {};
+
+TEST_F(DistributedTest, test_in_process_transport){
+    const std::int32_t num_ranks = 3;
+    InProcessTransportHub hub(num_ranks);
+    std::vector<std::vector<std::int32_t>> received(num_ranks);
+
+    std::vector<std::thread> rank_threads;
+    for(std::int32_t rank = 0; rank < num_ranks; rank++){
+        rank_threads.emplace_back([&, rank](){
+            InProcessTransport transport(hub, rank);
+            MessageBuffer message;
+            message.write<std::int32_t>(rank * 10);
+            for(auto& rank_message: all_gather(transport, MessageTag::bounding_box, message)){
+                received[rank].push_back(rank_message.read<std::int32_t>());
+            }
+        });
+    }
+    for(auto& rank_thread: rank_threads){
+        rank_thread.join();
+    }
+
+    // every rank receives the messages ordered by source rank
+    for(std::int32_t rank = 0; rank < num_ranks; rank++){
+        ASSERT_EQ(received[rank], (std::vector<std::int32_t>{0, 10, 20}));
+    }
+}
+
+TEST_F(DistributedTest, test_morton_key_follows_quadrants){
+    BoundingBox bb(0, 1, 0, 1);
+    // quadrant ids of get_quadrant: 0 top left, 1 top right, 2 bottom left, 3 bottom right
+    std::vector<Vector2d<double>> positions = {{0.25, 0.75}, {0.75, 0.75}, {0.25, 0.25}, {0.75, 0.25}};
+    for(std::uint64_t quadrant = 0; quadrant < 4; quadrant++){
+        ASSERT_EQ(get_morton_key(positions[quadrant], bb) >> 62, quadrant);
+    }
+    ASSERT_EQ(get_morton_key(Vector2d<double>(1, 0), bb), ~std::uint64_t{0});
+}
+
+TEST_F(DistributedTest, test_forces_match_barnes_hut){
+    Universe uni;
+    InputGenerator::create_random_universe(1000, uni);
+    Universe reference_uni = uni;
+    Universe naive_uni = uni;
+
+    DistributedBarnesHutEngine engine(4);
+    SimulationContext context(uni);
+    engine.simulate_epoch(uni, context);
+
+    BarnesHutEngine reference_engine;
+    SimulationContext reference_context(reference_uni);
+    reference_engine.simulate_epoch(reference_uni, reference_context);
+    NaiveParallelSimulation::calculate_forces(naive_uni);
+
+    // The essential trees give every rank the nodes the shared memory tree opens, so the forces of both
+    // engines agree up to the summation order. Both stay within the error the opening criterion allows.
+    double squared_error = 0;
+    double squared_magnitude = 0;
+    for(std::int32_t i = 0; i < uni.num_bodies; i++){
+        Vector2d<double> difference = uni.forces[i] - reference_uni.forces[i];
+        double magnitude = std::sqrt(naive_uni.forces[i][0] * naive_uni.forces[i][0] + naive_uni.forces[i][1] * naive_uni.forces[i][1]);
+        ASSERT_LE(std::sqrt(difference[0] * difference[0] + difference[1] * difference[1]), 1e-9 * magnitude);
+
+        difference = uni.forces[i] - naive_uni.forces[i];
+        squared_error += difference[0] * difference[0] + difference[1] * difference[1];
+        squared_magnitude += magnitude * magnitude;
+
+        difference = uni.positions[i] - reference_uni.positions[i];
+        ASSERT_LT(std::abs(difference[0]), 1e-3 * std::abs(reference_uni.positions[i][0]) + 1e-3);
+        ASSERT_LT(std::abs(difference[1]), 1e-3 * std::abs(reference_uni.positions[i][1]) + 1e-3);
+    }
+    ASSERT_LT(std::sqrt(squared_error / squared_magnitude), 0.01);
+    ASSERT_EQ(uni.current_simulation_epoch, 1);
+}
+
+TEST_F(DistributedTest, test_migration_keeps_bodies){
+    Universe uni;
+    InputGenerator::create_random_universe_with_supermassive_blackholes(500, uni, 2);
+    Universe reference_uni = uni;
+
+    DistributedBarnesHutEngine engine(3);
+    SimulationContext context(uni);
+    BarnesHutEngine reference_engine;
+    SimulationContext reference_context(reference_uni);
+    for(int epoch = 0; epoch < 3; epoch++){
+        engine.simulate_epoch(uni, context);
+        reference_engine.simulate_epoch(reference_uni, reference_context);
+    }
+
+    // Every body returns to its own index after the migrations, with the state the shared memory tree
+    // computes. The ranks build their trees from other subsets of the bodies, so after the first epoch
+    // the summation order differs and close encounters with the black holes amplify that.
+    auto get_length = [](Vector2d<double> vector) { return std::sqrt(vector[0] * vector[0] + vector[1] * vector[1]); };
+    ASSERT_EQ(uni.num_bodies, 500);
+    for(std::int32_t i = 0; i < uni.num_bodies; i++){
+        ASSERT_EQ(uni.weights[i], reference_uni.weights[i]);
+        ASSERT_LT(get_length(uni.positions[i] - reference_uni.positions[i]), 1e-8 * get_length(reference_uni.positions[i]));
+        ASSERT_LT(get_length(uni.velocities[i] - reference_uni.velocities[i]), 1e-4 * get_length(reference_uni.velocities[i]));
+    }
+
+    // rank 1 starts after the bucket that completes the first half of the bodies
+    std::vector<std::uint32_t> bucket_counts = {5, 0, 3, 2, 0, 10};
+    auto key_ranges = DistributedBarnesHutSimulation::get_key_ranges(bucket_counts, 2);
+    ASSERT_EQ(key_ranges, (std::vector<std::uint32_t>{0, 4, 6}));
+}
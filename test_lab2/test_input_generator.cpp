@@ -0,0 +1,90 @@
+#include "test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <omp.h>
+
+#include "structures/universe.h"
+#include "input_generator/input_generator.h"
+
+class InputGeneratorTest : public LabTest {};
+
+// the universe created with 1 thread, after checking that 2, 3, 4 and 7 threads create the same one
+static Universe assert_same_universe_with_any_threads(const std::function<void(Universe&)>& generate){
+    const int num_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    Universe single_thread_uni;
+    generate(single_thread_uni);
+    for(int threads : {2, 3, 4, 7}){
+        omp_set_num_threads(threads);
+        Universe multi_thread_uni;
+        generate(multi_thread_uni);
+        EXPECT_EQ(multi_thread_uni.num_bodies, single_thread_uni.num_bodies);
+        EXPECT_TRUE(std::equal(single_thread_uni.weights.begin(), single_thread_uni.weights.end(), multi_thread_uni.weights.begin())) << threads << " threads";
+        EXPECT_TRUE(std::equal(single_thread_uni.positions.begin(), single_thread_uni.positions.end(), multi_thread_uni.positions.begin())) << threads << " threads";
+        EXPECT_TRUE(std::equal(single_thread_uni.velocities.begin(), single_thread_uni.velocities.end(), multi_thread_uni.velocities.begin())) << threads << " threads";
+    }
+    omp_set_num_threads(num_threads);
+    return single_thread_uni;
+}
+
+TEST_F(InputGeneratorTest, test_seeded_generator){
+    // the same seed gives the same universe with any number of threads
+    Universe uni = assert_same_universe_with_any_threads([](Universe& generated) {
+        InputGenerator::create_random_universe_with_supermassive_blackholes(10000, generated, 2, 42);
+    });
+
+    Universe other_uni;
+    InputGenerator::create_random_universe_with_supermassive_blackholes(10000, other_uni, 2, 43);
+    ASSERT_FALSE(other_uni.positions[0] == uni.positions[0]);
+    // the black holes get the weight of Sagittarius A* regardless of the seed, the other bodies a random one
+    for(std::uint32_t i = 0; i < 2; i++){
+        ASSERT_EQ(uni.weights[i], 8.54 * std::pow(10, 36));
+        ASSERT_EQ(other_uni.weights[i], 8.54 * std::pow(10, 36));
+    }
+    ASSERT_NE(other_uni.weights[2], uni.weights[2]);
+
+    // positions and velocities cover both signs
+    ASSERT_TRUE(std::any_of(uni.positions.begin(), uni.positions.end(), [](const auto& position) { return position[0] < 0; }));
+    ASSERT_TRUE(std::any_of(uni.velocities.begin(), uni.velocities.end(), [](const auto& velocity) { return velocity[1] < 0; }));
+}
+
+TEST_F(InputGeneratorTest, test_clustered_generators){
+    // the Plummer sphere is centered and at rest, half of its bodies lie within the half mass radius of 1.305 scale radii
+    // each generator creates the same universe with any number of threads, including the centering of the Plummer sphere
+    Universe plummer = assert_same_universe_with_any_threads([](Universe& generated) {
+        InputGenerator::create_plummer_sphere(20000, generated, 7);
+    });
+    Vector2d<double> position_sum(0, 0);
+    Vector2d<double> velocity_sum(0, 0);
+    for(std::uint32_t i = 0; i < plummer.num_bodies; i++){
+        position_sum = position_sum + plummer.positions[i];
+        velocity_sum = velocity_sum + plummer.velocities[i];
+    }
+    ASSERT_LT(std::abs(position_sum[0] / plummer.num_bodies), 1e3);
+    ASSERT_LT(std::abs(velocity_sum[1] / plummer.num_bodies), 1e-6);
+    const double half_mass_radius = 1.305 * 9.46 * 1e14;
+    const auto num_inside = std::count_if(plummer.positions.begin(), plummer.positions.end(), [&](const auto& position) { return std::hypot(position[0], position[1]) < half_mass_radius; });
+    // the projection onto the plane moves bodies inwards
+    ASSERT_GT(num_inside, 10000);
+
+    // disk bodies orbit the central mass counter clockwise, the second galaxy of the merger clockwise
+    assert_same_universe_with_any_threads([](Universe& generated) {
+        InputGenerator::create_disk_galaxy(2000, generated, 7);
+    });
+    Universe merger = assert_same_universe_with_any_threads([](Universe& generated) {
+        InputGenerator::create_galaxy_merger(2000, generated, 7);
+    });
+    for(std::uint32_t galaxy = 0; galaxy < 2; galaxy++){
+        const std::uint32_t center = galaxy * 1000;
+        ASSERT_GT(merger.weights[center], 1e36);
+        for(std::uint32_t i = center + 1; i < center + 1000; i++){
+            const Vector2d<double> offset = merger.positions[i] - merger.positions[center];
+            const Vector2d<double> velocity = merger.velocities[i] - merger.velocities[center];
+            const double angular_momentum = offset[0] * velocity[1] - offset[1] * velocity[0];
+            ASSERT_EQ(angular_momentum > 0, galaxy == 0);
+            ASSERT_LT(std::abs(offset[0] * velocity[0] + offset[1] * velocity[1]), 0.1 * std::abs(angular_momentum));
+        }
+    }
+}
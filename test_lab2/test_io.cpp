@@ -0,0 +1,382 @@
+#include "test.h"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#include "structures/universe.h"
+#include "input_generator/input_generator.h"
+#include "io/universe_snapshot.h"
+#include "utilities/import.hpp"
+#include "utilities/export.hpp"
+#include "io/checkpoint_writer.h"
+#include "io/trajectory_file.h"
+#include "simulation/barnes_hut_simulation.h"
+#include "simulation/barnes_hut_simulation_with_collisions.h"
+#include "simulation/simulation_context.h"
+
+class IoTest : public LabTest {};
+
+static void assert_universes_equal(Universe& expected, Universe& actual){
+    ASSERT_EQ(expected.num_bodies, actual.num_bodies);
+    ASSERT_EQ(expected.current_simulation_epoch, actual.current_simulation_epoch);
+    for(std::uint32_t i = 0; i < expected.num_bodies; i++){
+        ASSERT_EQ(expected.positions[i], actual.positions[i]);
+        ASSERT_EQ(expected.velocities[i], actual.velocities[i]);
+        ASSERT_EQ(expected.forces[i], actual.forces[i]);
+        ASSERT_EQ(expected.weights[i], actual.weights[i]);
+    }
+}
+
+TEST_F(IoTest, test_snapshot_round_trip){
+    Universe uni;
+    InputGenerator::create_random_universe(1000, uni);
+    // values the text format cannot represent exactly
+    uni.weights[0] = 1.9891e30 / 3;
+    uni.positions[1] = Vector2d<double>(1.4959787e14 / 7, -1e-7);
+    uni.forces[2] = Vector2d<double>(1e25 / 3, 0);
+    uni.current_simulation_epoch = 42;
+
+    auto snapshot_path = std::filesystem::path{"test_snapshot_round_trip.nbody"};
+    save_universe(snapshot_path, uni);
+
+    Universe loaded_uni;
+    load_universe(snapshot_path, loaded_uni);
+    assert_universes_equal(uni, loaded_uni);
+
+    // the arrays can be used directly from the mapped file
+    UniverseSnapshotView view(snapshot_path);
+    ASSERT_EQ(view.get_num_bodies(), uni.num_bodies);
+    ASSERT_EQ(reinterpret_cast<std::uintptr_t>(view.get_array(UniverseSnapshot::SnapshotArray::weight)) % UniverseSnapshot::array_alignment, 0);
+    ASSERT_EQ(view.get_array(UniverseSnapshot::SnapshotArray::weight)[0], uni.weights[0]);
+    ASSERT_EQ(view.get_array(UniverseSnapshot::SnapshotArray::position_x)[1], uni.positions[1][0]);
+
+    std::filesystem::remove(snapshot_path);
+
+    // an empty universe is a valid snapshot as well
+    Universe empty_uni;
+    save_universe(snapshot_path, empty_uni);
+    load_universe(snapshot_path, loaded_uni);
+    ASSERT_EQ(loaded_uni.num_bodies, 0);
+    std::filesystem::remove(snapshot_path);
+}
+
+TEST_F(IoTest, test_snapshot_rejects_invalid_files){
+    Universe uni;
+    InputGenerator::create_random_universe(100, uni);
+    auto snapshot_path = std::filesystem::path{"test_snapshot_invalid.nbody"};
+    save_universe(snapshot_path, uni);
+
+    // truncated
+    auto size = std::filesystem::file_size(snapshot_path);
+    std::filesystem::resize_file(snapshot_path, size - 8);
+    Universe loaded_uni;
+    ASSERT_THROW(load_universe(snapshot_path, loaded_uni), std::invalid_argument);
+
+    // unknown version
+    save_universe(snapshot_path, uni);
+    {
+        std::fstream snapshot_file(snapshot_path, std::ios::binary | std::ios::in | std::ios::out);
+        snapshot_file.seekp(offsetof(UniverseSnapshot::Header, version));
+        std::uint32_t future_version = UniverseSnapshot::version + 1;
+        snapshot_file.write(reinterpret_cast<const char*>(&future_version), sizeof(future_version));
+    }
+    ASSERT_THROW(load_universe(snapshot_path, loaded_uni), std::invalid_argument);
+
+    // an array offset that wraps around when the array size is added, and a header larger than the file
+    for(auto [field_offset, value] : {std::pair{offsetof(UniverseSnapshot::Header, array_offsets), std::uint64_t{0} - UniverseSnapshot::array_alignment},
+                                      std::pair{offsetof(UniverseSnapshot::Header, header_size), std::uint64_t{size + 8}}}){
+        save_universe(snapshot_path, uni);
+        {
+            std::fstream snapshot_file(snapshot_path, std::ios::binary | std::ios::in | std::ios::out);
+            snapshot_file.seekp(field_offset);
+            snapshot_file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+        ASSERT_THROW(load_universe(snapshot_path, loaded_uni), std::invalid_argument);
+    }
+    std::filesystem::remove(snapshot_path);
+
+    // a text universe is no snapshot
+    auto text_path = std::filesystem::path{"test_snapshot_invalid.txt"};
+    save_universe(text_path, uni);
+    ASSERT_THROW(UniverseSnapshotView view(text_path), std::invalid_argument);
+    std::filesystem::remove(text_path);
+}
+
+static void write_text_file(const std::filesystem::path& file_path, const std::string& content){
+    std::ofstream text_file(file_path, std::ios::binary);
+    text_file << content;
+}
+
+TEST_F(IoTest, test_text_loader){
+    // large enough to be split into several chunks per section
+    Universe uni;
+    InputGenerator::create_random_universe(50000, uni);
+    auto text_path = std::filesystem::path{"test_text_loader.txt"};
+    {
+        std::ofstream text_file(text_path);
+        text_file.precision(17);
+        text_file << std::scientific << "### Bodies\n" << uni.num_bodies << "\n### Positions\n";
+        for(auto& position: uni.positions){
+            text_file << position[0] << " " << position[1] << "\n";
+        }
+        text_file << "### Weights\n";
+        for(auto weight: uni.weights){
+            text_file << weight << "\n";
+        }
+        text_file << "### Velocities\n";
+        for(auto& velocity: uni.velocities){
+            text_file << velocity[0] << " " << velocity[1] << "\n";
+        }
+        text_file << "### Forces\n";
+        for(auto& force: uni.forces){
+            text_file << force[0] << " " << force[1] << "\n";
+        }
+    }
+    Universe loaded_uni;
+    load_universe(text_path, loaded_uni);
+    assert_universes_equal(uni, loaded_uni);
+
+    // fixed and scientific notation, windows line endings, no newline at the end
+    write_text_file(text_path, "### Bodies\r\n2\r\n### Positions\r\n1.5 -2e3\r\n+3 4.25E-2\r\n### Weights\r\n1e30\r\n5\r\n"
+        "### Velocities\r\n0 0\r\n-1 1\r\n### Forces\r\n0.000000 0.000000\r\n7 8");
+    load_universe(text_path, loaded_uni);
+    ASSERT_EQ(loaded_uni.num_bodies, 2);
+    ASSERT_EQ(loaded_uni.positions[0], Vector2d<double>(1.5, -2000));
+    ASSERT_EQ(loaded_uni.positions[1], Vector2d<double>(3, 0.0425));
+    ASSERT_EQ(loaded_uni.weights[0], 1e30);
+    ASSERT_EQ(loaded_uni.forces[1], Vector2d<double>(7, 8));
+
+    // wrong section header, wrong count, malformed number
+    const std::string valid_tail = "### Weights\n1\n### Velocities\n0 0\n### Forces\n0 0\n";
+    for(auto& invalid_content: {"### Bodies\n1\n### Velocities\n1 2\n" + valid_tail,
+                                "### Bodies\n2\n### Positions\n1 2\n" + valid_tail,
+                                "### Bodies\n1\n### Positions\n1 x\n" + valid_tail,
+                                "### Bodies\n1\n### Positions\n1 2 3\n" + valid_tail}){
+        write_text_file(text_path, invalid_content);
+        ASSERT_THROW(load_universe(text_path, loaded_uni), std::invalid_argument);
+    }
+    std::filesystem::remove(text_path);
+}
+
+TEST_F(IoTest, test_text_writer_round_trip){
+    // several write chunks, values std::to_string would round
+    Universe uni;
+    InputGenerator::create_random_universe(100000, uni);
+    uni.weights[0] = 1.9891e30 / 3;
+    uni.positions[1] = Vector2d<double>(1.4959787e14 / 7, -1e-7);
+    uni.velocities[2] = Vector2d<double>(-0.0, 5e-324);
+
+    auto text_path = std::filesystem::path{"test_text_writer.txt"};
+    save_universe(text_path, uni);
+    Universe loaded_uni;
+    load_universe(text_path, loaded_uni);
+    // the text format does not store the epoch
+    loaded_uni.current_simulation_epoch = uni.current_simulation_epoch;
+    assert_universes_equal(uni, loaded_uni);
+    ASSERT_TRUE(std::signbit(loaded_uni.velocities[2][0]));
+
+    // layout stays readable for other tools
+    std::ifstream text_file(text_path);
+    std::string line;
+    std::getline(text_file, line);
+    ASSERT_EQ(line, "### Bodies");
+    std::getline(text_file, line);
+    ASSERT_EQ(line, "100000");
+    std::getline(text_file, line);
+    ASSERT_EQ(line, "### Positions");
+    std::filesystem::remove(text_path);
+}
+
+TEST_F(IoTest, test_checkpoint_restart){
+    Universe start_uni;
+    InputGenerator::create_random_universe(500, start_uni);
+
+    // uninterrupted run of 6 epochs
+    Universe uni = start_uni;
+    BarnesHutEngine engine;
+    SimulationContext context(uni);
+    for(int epoch = 0; epoch < 6; epoch++){
+        engine.simulate_epoch(uni, context);
+    }
+
+    // 4 epochs with a checkpoint every 3, then a restart from the checkpoint after epoch 3
+    auto checkpoint_path = std::filesystem::path{"test_checkpoint_restart.nbody"};
+    {
+        Universe interrupted_uni = start_uni;
+        SimulationContext interrupted_context(interrupted_uni);
+        CheckpointWriter checkpoint_writer(checkpoint_path, 3);
+        interrupted_context.add_observer(&checkpoint_writer);
+        for(int epoch = 0; epoch < 4; epoch++){
+            interrupted_context.notify_epoch_begin(interrupted_uni);
+            engine.simulate_epoch(interrupted_uni, interrupted_context);
+            interrupted_context.notify_epoch_end(interrupted_uni);
+        }
+        checkpoint_writer.flush();
+        ASSERT_EQ(checkpoint_writer.get_num_written(), 1);
+    }
+    ASSERT_FALSE(std::filesystem::exists("test_checkpoint_restart.nbody.tmp"));
+
+    Universe restarted_uni;
+    load_universe(checkpoint_path, restarted_uni);
+    ASSERT_EQ(restarted_uni.current_simulation_epoch, 3);
+    BarnesHutEngine restarted_engine;
+    SimulationContext restarted_context(restarted_uni);
+    for(int epoch = 0; epoch < 3; epoch++){
+        restarted_engine.simulate_epoch(restarted_uni, restarted_context);
+    }
+
+    // bit-for-bit the same trajectory
+    assert_universes_equal(uni, restarted_uni);
+    std::filesystem::remove(checkpoint_path);
+}
+
+TEST_F(IoTest, test_trajectory_random_access){
+    Universe uni;
+    InputGenerator::create_random_universe(500, uni);
+    SimulationContext context(uni);
+
+    auto double_path = std::filesystem::path{"test_trajectory_double.traj"};
+    auto float_path = std::filesystem::path{"test_trajectory_float.traj"};
+    TrajectoryOptions double_options;
+    double_options.velocities = true;
+    double_options.frames_per_chunk = 4;
+    TrajectoryOptions float_options;
+    float_options.every = 2;
+    float_options.single_precision = true;
+
+    // expected states of all epochs
+    std::vector<Universe> states;
+    {
+        TrajectoryWriter double_writer(double_path, double_options);
+        TrajectoryWriter float_writer(float_path, float_options);
+        double_writer.append(uni);
+        float_writer.append(uni);
+        states.push_back(uni);
+        context.add_observer(&double_writer);
+        context.add_observer(&float_writer);
+        for(int epoch = 0; epoch < 10; epoch++){
+            BarnesHutSimulation::simulate_epoch(uni, context);
+            context.notify_epoch_end(uni);
+            states.push_back(uni);
+        }
+        context.remove_observer(&double_writer);
+        context.remove_observer(&float_writer);
+        ASSERT_EQ(double_writer.get_num_frames(), 11);
+        ASSERT_EQ(float_writer.get_num_frames(), 6);
+        double_writer.close();
+    }
+
+    // frames are decoded from their key frame, reading them in any order is exact
+    TrajectoryReader double_reader(double_path);
+    ASSERT_EQ(double_reader.get_num_bodies(), 500);
+    ASSERT_TRUE(double_reader.has_velocities());
+    for(std::uint32_t epoch : {7u, 0u, 10u, 4u, 3u}){
+        Universe loaded;
+        double_reader.read_epoch(epoch, loaded);
+        ASSERT_EQ(loaded.current_simulation_epoch, epoch);
+        for(std::uint32_t i = 0; i < loaded.num_bodies; i++){
+            ASSERT_EQ(loaded.positions[i], states[epoch].positions[i]);
+            ASSERT_EQ(loaded.velocities[i], states[epoch].velocities[i]);
+        }
+    }
+
+    TrajectoryReader float_reader(float_path);
+    ASSERT_TRUE(float_reader.is_single_precision());
+    ASSERT_FALSE(float_reader.has_velocities());
+    ASSERT_EQ(float_reader.get_epoch(3), 6);
+    ASSERT_THROW((void)float_reader.find_frame(5), std::invalid_argument);
+    std::vector<Vector2d<double>> positions(500);
+    float_reader.read_frame(float_reader.find_frame(8), positions.data(), nullptr);
+    for(std::uint32_t i = 0; i < 500; i++){
+        ASSERT_EQ(positions[i][0], static_cast<float>(states[8].positions[i][0]));
+        ASSERT_EQ(positions[i][1], static_cast<float>(states[8].positions[i][1]));
+    }
+    ASSERT_THROW(float_reader.read_frame(0, positions.data(), positions.data()), std::invalid_argument);
+
+    // the differences compress, the file is smaller than the raw values
+    ASSERT_LT(std::filesystem::file_size(double_path), 11 * 500 * 4 * sizeof(double));
+
+    std::filesystem::remove(double_path);
+    std::filesystem::remove(float_path);
+}
+
+TEST_F(IoTest, test_trajectory_compressible_frames){
+    // integer coordinates are mostly zero bytes, a frame encodes to far less than a byte per value
+    Universe uni;
+    InputGenerator::create_random_universe(1000, uni);
+    for(std::uint32_t i = 0; i < uni.num_bodies; i++){
+        uni.positions[i] = Vector2d<double>(i % 7, i % 3);
+        uni.velocities[i] = Vector2d<double>(0, 0);
+    }
+
+    auto path = std::filesystem::path{"test_trajectory_compressible.traj"};
+    TrajectoryOptions options;
+    options.velocities = true;
+    {
+        TrajectoryWriter writer(path, options);
+        writer.append(uni);
+    }
+    // smaller than a single double per body, which the reader must not take as truncated
+    ASSERT_LT(std::filesystem::file_size(path), 1000 * sizeof(double));
+
+    TrajectoryReader reader(path);
+    Universe loaded;
+    reader.read_epoch(0, loaded);
+    ASSERT_EQ(loaded.num_bodies, 1000);
+    for(std::uint32_t i = 0; i < loaded.num_bodies; i++){
+        ASSERT_EQ(loaded.positions[i], uni.positions[i]);
+        ASSERT_EQ(loaded.velocities[i], uni.velocities[i]);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_F(IoTest, test_trajectory_with_collisions){
+    // the collisions engine merges the two bodies, the trajectory starts a new chunk with one body
+    Universe uni;
+    InputGenerator::create_two_body_collision(uni);
+    BarnesHutWithCollisionsEngine engine;
+    SimulationContext context(uni);
+
+    auto path = std::filesystem::path{"test_trajectory_collisions.traj"};
+    TrajectoryOptions options;
+    options.velocities = true;
+    options.frames_per_chunk = 4;
+    std::vector<Universe> states;
+    {
+        TrajectoryWriter writer(path, options);
+        writer.append(uni);
+        states.push_back(uni);
+        context.add_observer(&writer);
+        // a few frames after the merge, so the single body also gets difference frames
+        int epochs_after_merge = 0;
+        while(epochs_after_merge < 5){
+            ASSERT_LT(states.size(), 200);
+            context.notify_epoch_begin(uni);
+            engine.simulate_epoch(uni, context);
+            context.notify_epoch_end(uni);
+            states.push_back(uni);
+            if(uni.num_bodies == 1){
+                epochs_after_merge++;
+            }
+        }
+        context.remove_observer(&writer);
+    }
+    ASSERT_EQ(states.front().num_bodies, 2);
+    ASSERT_EQ(states.back().num_bodies, 1);
+
+    TrajectoryReader reader(path);
+    ASSERT_EQ(reader.get_num_frames(), states.size());
+    for(std::uint32_t epoch = 0; epoch < states.size(); epoch++){
+        Universe loaded;
+        reader.read_epoch(epoch, loaded);
+        ASSERT_EQ(loaded.num_bodies, states[epoch].num_bodies);
+        for(std::uint32_t i = 0; i < loaded.num_bodies; i++){
+            ASSERT_EQ(loaded.positions[i], states[epoch].positions[i]);
+            ASSERT_EQ(loaded.velocities[i], states[epoch].velocities[i]);
+        }
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,48 @@
+#include "test.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "structures/universe.h"
+#include "structures/first_touch_allocator.h"
+#include "parallel/thread_affinity.h"
+#include "input_generator/input_generator.h"
+
+class NumaTest : public LabTest {};
+
+TEST_F(NumaTest, test_first_touch_allocator){
+    // large enough for the parallel touch
+    const std::size_t num_elements = FirstTouchAllocator<double>::min_touch_bytes;
+    body_vector<double> values(num_elements, 1.5);
+    ASSERT_EQ(values.size(), num_elements);
+    ASSERT_TRUE(std::all_of(values.begin(), values.end(), [](double value) { return value == 1.5; }));
+
+    // the touch must not overwrite what resize and copies put into the array
+    body_vector<double> copy = values;
+    copy.resize(2 * num_elements, 2.5);
+    ASSERT_EQ(copy[num_elements - 1], 1.5);
+    ASSERT_EQ(copy[num_elements], 2.5);
+
+    Universe uni;
+    InputGenerator::create_random_universe(100000, uni);
+    ASSERT_EQ(uni.positions.size(), 100000);
+    ASSERT_EQ(uni.forces[99999], Vector2d<double>(0, 0));
+}
+
+TEST_F(NumaTest, test_thread_affinity){
+    ASSERT_FALSE(ThreadPinning::get_allowed_cpus().empty());
+    ASSERT_GE(ThreadPinning::get_num_numa_nodes(), 1);
+    ASSERT_THROW((void)get_thread_affinity(3), std::invalid_argument);
+
+    // on a single node machine the policies only change the cpu masks
+    for(std::uint32_t affinity_id = 0; affinity_id < 3; affinity_id++){
+        ThreadPinning::apply(get_thread_affinity(affinity_id));
+        double sum = 0;
+#pragma omp parallel for reduction(+ : sum)
+        for(int i = 0; i < 1000; i++){
+            sum += i;
+        }
+        ASSERT_EQ(sum, 499500);
+    }
+    ASSERT_TRUE(ThreadPinning::apply(ThreadAffinity::none));
+}
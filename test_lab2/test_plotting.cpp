@@ -0,0 +1,690 @@
+#include "test.h"
+
+#include <algorithm>
+#include <array>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "structures/universe.h"
+#include "input_generator/input_generator.h"
+#include "plotting/plotter.h"
+#include "plotting/frame_pipeline.h"
+#include "io/image_parser.h"
+#include "io/deflate.h"
+#include "plotting/frame_sink.h"
+#include "plotting/density_renderer.h"
+#include "plotting/poster_renderer.h"
+#include "quadtree/quadtree.h"
+#include "simulation/barnes_hut_simulation.h"
+#include "simulation/simulation_context.h"
+
+class PlottingTest : public LabTest {};
+
+// SIGPIPEs that reached the handler of the test process
+static volatile std::sig_atomic_t num_sigpipes = 0;
+
+static std::string read_file(const std::filesystem::path& path){
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+TEST_F(PlottingTest, test_async_frames_match_sync_frames){
+    Universe uni;
+    InputGenerator::create_random_universe(2000, uni);
+    BoundingBox bb = uni.get_bounding_box();
+
+    auto sync_path = std::filesystem::path{"test_async_frames_sync"};
+    auto async_path = std::filesystem::path{"test_async_frames_async"};
+    std::filesystem::create_directories(sync_path);
+    std::filesystem::create_directories(async_path);
+
+    Plotter sync_plotter(bb, sync_path, 64, 48);
+    Plotter async_plotter(bb, async_path, 64, 48);
+    // a single buffer forces the simulation thread to wait for the writer
+    async_plotter.enable_async_frames(1, FrameBackpressure::block);
+
+    for(int frame = 0; frame < 5; frame++){
+        sync_plotter.plot_frame(uni);
+        async_plotter.plot_frame(uni);
+        // the snapshot is taken at submission, later changes must not show up in the frame
+        for(std::uint32_t i = 0; i < uni.num_bodies; i++){
+            uni.positions[i] = uni.positions[i] * 0.9;
+        }
+    }
+    async_plotter.flush_frames();
+    ASSERT_EQ(async_plotter.get_num_dropped_frames(), 0);
+    ASSERT_EQ(async_plotter.get_next_image_serial_number(), 5);
+
+    // direct use after the flush continues the serial numbers
+    async_plotter.add_bodies_to_image(uni);
+    async_plotter.write_and_clear();
+    sync_plotter.add_bodies_to_image(uni);
+    sync_plotter.write_and_clear();
+
+    for(int frame = 0; frame < 6; frame++){
+        std::string file_name = "plot_00000000" + std::to_string(frame) + ".bmp";
+        ASSERT_TRUE(std::filesystem::exists(async_path / file_name));
+        ASSERT_EQ(read_file(sync_path / file_name), read_file(async_path / file_name));
+    }
+
+    std::filesystem::remove_all(sync_path);
+    std::filesystem::remove_all(async_path);
+}
+
+TEST_F(PlottingTest, test_async_frames_drop){
+    Universe uni;
+    InputGenerator::create_random_universe(100, uni);
+
+    auto output_path = std::filesystem::path{"test_async_frames_drop"};
+    std::filesystem::create_directories(output_path);
+    Plotter plotter(uni.get_bounding_box(), output_path, 32, 32);
+
+    AsyncFramePipeline pipeline(plotter, 2, FrameBackpressure::drop);
+    std::uint32_t num_submitted = 0;
+    for(int frame = 0; frame < 200; frame++){
+        num_submitted += pipeline.submit(uni) ? 1 : 0;
+    }
+    pipeline.flush();
+
+    // every frame is either written or counted as dropped
+    ASSERT_EQ(pipeline.get_num_frames_written(), num_submitted);
+    ASSERT_EQ(pipeline.get_num_frames_written() + pipeline.get_num_frames_dropped(), 200);
+    ASSERT_EQ(pipeline.get_next_image_serial_number(), num_submitted);
+
+    ASSERT_THROW((void)get_frame_backpressure(2), std::invalid_argument);
+    ASSERT_THROW(AsyncFramePipeline(plotter, 0, FrameBackpressure::block), std::invalid_argument);
+
+    std::filesystem::remove_all(output_path);
+}
+
+TEST_F(PlottingTest, test_bitmap_row_padding){
+    // 3 * 5 bytes per row are padded to 16
+    BitmapImage image(3, 5);
+    for(std::uint32_t y = 0; y < 3; y++){
+        for(std::uint32_t x = 0; x < 5; x++){
+            image.set_pixel(y, x, BitmapImage::BitmapPixel(10 * y, 20 * x, 7));
+        }
+    }
+
+    auto bitmap_path = std::filesystem::path{"test_bitmap_row_padding.bmp"};
+    ImageParser::write_bitmap(bitmap_path, image);
+    std::string file = read_file(bitmap_path);
+    ASSERT_EQ(file.size(), ImageParser::bitmap_header_size + 3 * 16);
+    std::uint32_t bf_size;
+    std::memcpy(&bf_size, file.data() + 2, sizeof(bf_size));
+    ASSERT_EQ(bf_size, file.size());
+    // second row starts after the padding, blue green red
+    ASSERT_EQ(file[ImageParser::bitmap_header_size + 16 + 3 * 1], 7);
+    ASSERT_EQ(file[ImageParser::bitmap_header_size + 16 + 3 * 1 + 1], 20);
+    ASSERT_EQ(file[ImageParser::bitmap_header_size + 16 + 3 * 1 + 2], 10);
+
+    BitmapImage loaded = ImageParser::read_bitmap(bitmap_path);
+    ASSERT_EQ(loaded.get_height(), 3);
+    ASSERT_EQ(loaded.get_width(), 5);
+    for(std::uint32_t y = 0; y < 3; y++){
+        for(std::uint32_t x = 0; x < 5; x++){
+            ASSERT_EQ(loaded.get_pixel(y, x), image.get_pixel(y, x));
+        }
+    }
+
+    // a truncated file is rejected
+    ASSERT_ANY_THROW((void)ImageParser::decode_bitmap(file.data(), file.size() - 1));
+    // as are empty and unrepresentable dimensions
+    for(std::size_t dimension_offset : {18, 22}){
+        for(std::int32_t dimension : {0, std::numeric_limits<std::int32_t>::min()}){
+            auto invalid_file = file;
+            std::memcpy(invalid_file.data() + dimension_offset, &dimension, sizeof(dimension));
+            ASSERT_ANY_THROW((void)ImageParser::decode_bitmap(invalid_file.data(), invalid_file.size()));
+        }
+    }
+    std::filesystem::remove(bitmap_path);
+}
+
+TEST_F(PlottingTest, test_frame_sinks){
+    Universe uni;
+    InputGenerator::create_random_universe(300, uni);
+    BoundingBox bb = uni.get_bounding_box();
+
+    auto raw_path = std::filesystem::path{"test_frame_sinks.rgb"};
+    auto piped_path = std::filesystem::path{"test_frame_sinks_piped.rgb"};
+    auto y4m_path = std::filesystem::path{"test_frame_sinks.y4m"};
+    auto raw_sink = std::make_shared<RawFrameSink>(raw_path, 40, 30);
+    // stand-in for a video encoder, stores what it reads
+    auto pipe_sink = std::make_shared<PipeFrameSink>("cat > " + piped_path.string(), 40, 30);
+    auto y4m_sink = std::make_shared<Y4mFrameSink>(y4m_path, 40, 30, 25);
+
+    Plotter raw_plotter(bb, ".", 40, 30);
+    Plotter pipe_plotter(bb, ".", 40, 30);
+    Plotter y4m_plotter(bb, ".", 40, 30);
+    raw_plotter.set_frame_sink(raw_sink);
+    pipe_plotter.set_frame_sink(pipe_sink);
+    y4m_plotter.set_frame_sink(y4m_sink);
+    for(int frame = 0; frame < 3; frame++){
+        raw_plotter.plot_frame(uni);
+        pipe_plotter.plot_frame(uni);
+        y4m_plotter.plot_frame(uni);
+        for(std::uint32_t i = 0; i < uni.num_bodies; i++){
+            uni.positions[i] = uni.positions[i] * 0.8;
+        }
+    }
+    // the top left pixel of the plot is the first pixel of the stream
+    y4m_plotter.mark_pixel(0, 29, 255, 255, 255);
+    y4m_plotter.write_and_clear();
+    raw_sink->close();
+    pipe_sink->close();
+    y4m_sink->close();
+    ASSERT_EQ(raw_sink->get_num_frames(), 3);
+
+    std::string raw = read_file(raw_path);
+    ASSERT_EQ(raw.size(), 3 * 40 * 30 * 3);
+    ASSERT_EQ(read_file(piped_path), raw);
+
+    std::string y4m = read_file(y4m_path);
+    std::string stream_header = "YUV4MPEG2 W40 H30 F25:1 Ip A1:1 C444\n";
+    ASSERT_EQ(y4m.substr(0, stream_header.size()), stream_header);
+    const std::size_t frame_size = 6 + 3 * 40 * 30;
+    ASSERT_EQ(y4m.size(), stream_header.size() + 4 * frame_size);
+    const std::size_t last_frame = stream_header.size() + 3 * frame_size;
+    ASSERT_EQ(y4m.substr(last_frame, 6), "FRAME\n");
+    ASSERT_EQ(static_cast<std::uint8_t>(y4m[last_frame + 6]), 235);
+    ASSERT_EQ(static_cast<std::uint8_t>(y4m[last_frame + 7]), 16);
+
+    // a consumer that fails is reported
+    PipeFrameSink failing_sink("exit 3", 40, 30);
+    ASSERT_THROW(failing_sink.close(), std::runtime_error);
+
+#ifndef _WIN32
+    // a consumer that stops reading makes the write throw, the SIGPIPE handler of the process is kept
+    struct sigaction previous_action{};
+    struct sigaction counting_action{};
+    counting_action.sa_handler = [](int){ num_sigpipes++; };
+    sigemptyset(&counting_action.sa_mask);
+    sigaction(SIGPIPE, &counting_action, &previous_action);
+    {
+        PipeFrameSink closed_sink("exit 0", 400, 300);
+        ASSERT_THROW(closed_sink.write_frame(BitmapImage(300, 400)), std::runtime_error);
+    }
+    struct sigaction current_action{};
+    sigaction(SIGPIPE, &previous_action, &current_action);
+    ASSERT_EQ(current_action.sa_handler, counting_action.sa_handler);
+    ASSERT_EQ(num_sigpipes, 0);
+#endif
+    ASSERT_THROW(raw_sink->write_frame(BitmapImage(10, 10)), std::invalid_argument);
+
+    std::filesystem::remove(raw_path);
+    std::filesystem::remove(piped_path);
+    std::filesystem::remove(y4m_path);
+}
+
+TEST_F(PlottingTest, test_density_renderer){
+    Universe uni;
+    InputGenerator::create_random_universe(20000, uni);
+    BoundingBox bb = uni.get_bounding_box();
+    // three bodies on one pixel, one of them heavy
+    uni.positions[0] = Vector2d<double>(bb.x_min, bb.y_min);
+    uni.positions[1] = Vector2d<double>(bb.x_min, bb.y_min);
+    uni.positions[2] = Vector2d<double>(bb.x_min, bb.y_min);
+    double total_weight = 0;
+    for(std::uint32_t i = 0; i < uni.num_bodies; i++){
+        total_weight += uni.weights[i];
+    }
+    uni.weights[2] = total_weight;
+
+    DensityRenderer renderer(64, 64);
+    renderer.accumulate(bb, uni.positions.data(), nullptr, uni.num_bodies);
+
+    // the per thread buffers are merged, every body is counted exactly once
+    double total = 0;
+    for(double value : renderer.get_values()){
+        total += value;
+    }
+    ASSERT_EQ(total, uni.num_bodies);
+    ASSERT_GE(renderer.get_values()[0], 3.0);
+
+    renderer.clear();
+    renderer.accumulate(bb, uni.positions.data(), uni.weights.data(), uni.num_bodies);
+    ASSERT_GE(renderer.get_values()[0], total_weight);
+
+    // the densest pixel gets the brightest color, empty pixels stay black
+    Plotter plotter(bb, ".", 64, 64);
+    plotter.set_plot_style(PlotStyle::mass);
+    plotter.add_bodies_to_image(uni);
+    auto brightest = plotter.get_pixel(0, 0);
+    ASSERT_GT(brightest.get_red_channel(), 240);
+    ASSERT_GT(brightest.get_green_channel(), 240);
+
+    Universe single_body;
+    single_body.num_bodies = 1;
+    single_body.positions.push_back(Vector2d<double>(0, 0));
+    single_body.weights.push_back(1);
+    single_body.velocities.push_back(Vector2d<double>(0, 0));
+    single_body.forces.push_back(Vector2d<double>(0, 0));
+    Plotter density_plotter(BoundingBox(-1, 1, -1, 1), ".", 3, 3);
+    density_plotter.set_plot_style(PlotStyle::density);
+    density_plotter.add_bodies_to_image(single_body);
+    ASSERT_FALSE(density_plotter.get_pixel(1, 1) == BitmapImage::BitmapPixel(0, 0, 0));
+    ASSERT_TRUE(density_plotter.get_pixel(0, 0) == BitmapImage::BitmapPixel(0, 0, 0));
+
+    // heavy bodies on one pixel sum beyond the float range, the pixel is still the brightest
+    Universe heavy;
+    heavy.num_bodies = 101;
+    for(std::uint32_t i = 0; i < heavy.num_bodies; i++){
+        heavy.positions.push_back(i == 0 ? Vector2d<double>(1, 1) : Vector2d<double>(-1, -1));
+        heavy.weights.push_back(i == 0 ? 1.0 : 1e37);
+        heavy.velocities.push_back(Vector2d<double>(0, 0));
+        heavy.forces.push_back(Vector2d<double>(0, 0));
+    }
+    DensityRenderer heavy_renderer(3, 3);
+    heavy_renderer.accumulate(BoundingBox(-1, 1, -1, 1), heavy.positions.data(), heavy.weights.data(), heavy.num_bodies);
+    ASSERT_NEAR(heavy_renderer.get_values()[0], 1e39, 1e25);
+    Plotter heavy_plotter(BoundingBox(-1, 1, -1, 1), ".", 3, 3);
+    heavy_plotter.set_plot_style(PlotStyle::mass);
+    heavy_plotter.add_bodies_to_image(heavy);
+    ASSERT_TRUE(heavy_plotter.get_pixel(0, 0) == heavy_renderer.get_color(1, 1, 1));
+    ASSERT_FALSE(heavy_plotter.get_pixel(2, 2) == BitmapImage::BitmapPixel(0, 0, 0));
+    ASSERT_FALSE(heavy_plotter.get_pixel(2, 2) == heavy_plotter.get_pixel(0, 0));
+    // an infinite value is drawn with the brightest color
+    const double infinity = std::numeric_limits<double>::infinity();
+    ASSERT_TRUE(heavy_renderer.get_color(infinity, 1, infinity) == heavy_renderer.get_color(1, 1, 1));
+
+    ASSERT_THROW((void)get_plot_style(4), std::invalid_argument);
+}
+
+TEST_F(PlottingTest, test_quadtree_overlay){
+    Universe uni;
+    InputGenerator::create_random_universe(3000, uni);
+    BoundingBox bb = uni.get_bounding_box();
+    Quadtree quadtree(uni, bb, 0);
+
+    // the overlay skips boxes below one pixel, the image is the same as with every box drawn
+    Plotter overlay_plotter(bb.get_scaled(2), ".", 120, 90);
+    overlay_plotter.add_quadtree_to_bitmap(quadtree);
+    Plotter reference_plotter(bb.get_scaled(2), ".", 120, 90);
+    std::vector<BoundingBox> bounding_boxes = quadtree.get_bounding_boxes(quadtree.root);
+    for(auto& box : bounding_boxes){
+        reference_plotter.add_bounding_box_to_bitmap(box, BitmapImage::BitmapPixel(0, 255, 0));
+    }
+
+    std::uint32_t num_marked = 0;
+    for(std::uint32_t x = 0; x < 120; x++){
+        for(std::uint32_t y = 0; y < 90; y++){
+            ASSERT_EQ(overlay_plotter.get_pixel(x, y), reference_plotter.get_pixel(x, y));
+            num_marked += overlay_plotter.get_pixel(x, y).get_green_channel() == 255 ? 1 : 0;
+        }
+    }
+    ASSERT_GT(num_marked, 0);
+
+    // children are listed before their parent, the root is last
+    ASSERT_EQ(bounding_boxes.back().x_min, quadtree.root->bounding_box.x_min);
+    ASSERT_EQ(bounding_boxes.back().y_max, quadtree.root->bounding_box.y_max);
+    std::size_t num_nodes = 0;
+    std::vector<QuadtreeNode*> nodes{quadtree.root};
+    while(!nodes.empty()){
+        QuadtreeNode* node = nodes.back();
+        nodes.pop_back();
+        num_nodes++;
+        nodes.insert(nodes.end(), node->children.begin(), node->children.end());
+    }
+    ASSERT_EQ(bounding_boxes.size(), num_nodes);
+    QuadtreeNode* first_leaf = quadtree.root;
+    while(!first_leaf->children.empty()){
+        first_leaf = first_leaf->children.front();
+    }
+    ASSERT_EQ(bounding_boxes.front().x_min, first_leaf->bounding_box.x_min);
+    ASSERT_EQ(bounding_boxes.front().y_min, first_leaf->bounding_box.y_min);
+}
+
+TEST_F(PlottingTest, test_level_of_detail){
+    Universe uni;
+    InputGenerator::create_random_universe(20000, uni);
+    SimulationContext context(uni);
+    BarnesHutSimulation::simulate_epoch(uni, context);
+    ASSERT_NE(context.tree_root, nullptr);
+
+    // the points are taken from the tree, a small image needs far fewer points than bodies
+    Plotter plotter(context.tree_root->bounding_box, ".", 32, 32);
+    plotter.set_plot_style(PlotStyle::level_of_detail);
+    std::vector<Vector2d<double>> positions;
+    std::vector<double> weights;
+    plotter.get_level_of_detail_points(context.tree_root, positions, weights);
+    ASSERT_LT(positions.size(), uni.num_bodies / 4);
+
+    // no mass is lost
+    double total_weight = 0;
+    double lod_weight = 0;
+    for(std::uint32_t i = 0; i < uni.num_bodies; i++){
+        total_weight += uni.weights[i];
+    }
+    for(double weight : weights){
+        lod_weight += weight;
+    }
+    ASSERT_NEAR(lod_weight, total_weight, total_weight * 1e-9);
+
+    // asynchronous frames copy the points before the tree is reused
+    auto output_path = std::filesystem::path{"test_level_of_detail"};
+    std::filesystem::create_directories(output_path);
+    Plotter sync_plotter(context.tree_root->bounding_box, output_path, 32, 32);
+    sync_plotter.set_plot_style(PlotStyle::level_of_detail);
+    sync_plotter.set_filename_prefix("sync");
+    Plotter async_plotter(context.tree_root->bounding_box, output_path, 32, 32);
+    async_plotter.set_plot_style(PlotStyle::level_of_detail);
+    async_plotter.set_filename_prefix("async");
+    async_plotter.enable_async_frames(2, FrameBackpressure::block);
+    sync_plotter.plot_frame(uni, context.tree_root);
+    async_plotter.plot_frame(uni, context.tree_root);
+    BarnesHutSimulation::simulate_epoch(uni, context);
+    async_plotter.flush_frames();
+    ASSERT_EQ(read_file(output_path / "sync_000000000.bmp"), read_file(output_path / "async_000000000.bmp"));
+    std::filesystem::remove_all(output_path);
+
+    // engines without a tree do not leave a stale one behind
+    context.reset_counters();
+    ASSERT_EQ(context.tree_root, nullptr);
+}
+
+// Inflates a zlib stream of stored and fixed Huffman blocks, the two block types the encoder
+// writes. Independent of io/deflate, so a broken encoder cannot hide behind a matching decoder.
+static std::vector<std::uint8_t> inflate_zlib(const std::vector<std::uint8_t>& stream){
+    std::size_t bit_position = 16;
+    auto read_bits = [&](std::uint32_t num_bits){
+        std::uint32_t value = 0;
+        for(std::uint32_t bit = 0; bit < num_bits; bit++, bit_position++){
+            value |= ((stream.at(bit_position / 8) >> (bit_position % 8)) & 1u) << bit;
+        }
+        return value;
+    };
+    // Huffman codes are stored starting with their most significant bit
+    auto read_code = [&](std::uint32_t num_bits){
+        std::uint32_t code = 0;
+        for(std::uint32_t bit = 0; bit < num_bits; bit++){
+            code = (code << 1) | read_bits(1);
+        }
+        return code;
+    };
+    auto read_literal_length = [&](){
+        std::uint32_t code = read_code(7);
+        if(code <= 23){
+            return 256 + code;
+        }
+        code = (code << 1) | read_bits(1);
+        if(code >= 48 && code <= 191){
+            return code - 48;
+        }
+        if(code >= 192 && code <= 199){
+            return 280 + code - 192;
+        }
+        code = (code << 1) | read_bits(1);
+        return 144 + code - 400;
+    };
+    const std::array<std::uint32_t, 29> length_bases = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    const std::array<std::uint32_t, 29> length_extra_bits = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    const std::array<std::uint32_t, 30> distance_bases = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    const std::array<std::uint32_t, 30> distance_extra_bits = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    std::vector<std::uint8_t> output;
+    bool final_block = false;
+    while(!final_block){
+        final_block = read_bits(1) == 1;
+        const std::uint32_t block_type = read_bits(2);
+        if(block_type == 0){
+            bit_position = (bit_position + 7) / 8 * 8;
+            const std::uint32_t length = read_bits(16);
+            EXPECT_EQ(read_bits(16), ~length & 0xffffu);
+            for(std::uint32_t i = 0; i < length; i++){
+                output.push_back(static_cast<std::uint8_t>(read_bits(8)));
+            }
+            continue;
+        }
+        if(block_type != 1){
+            throw std::invalid_argument("unexpected deflate block type");
+        }
+        while(true){
+            const std::uint32_t symbol = read_literal_length();
+            if(symbol < 256){
+                output.push_back(static_cast<std::uint8_t>(symbol));
+                continue;
+            }
+            if(symbol == 256){
+                break;
+            }
+            const std::uint32_t length = length_bases.at(symbol - 257) + read_bits(length_extra_bits.at(symbol - 257));
+            const std::uint32_t distance_code = read_code(5);
+            const std::uint32_t distance = distance_bases.at(distance_code) + read_bits(distance_extra_bits.at(distance_code));
+            if(distance > output.size()){
+                throw std::invalid_argument("deflate distance before the start of the stream");
+            }
+            for(std::uint32_t i = 0; i < length; i++){
+                output.push_back(output[output.size() - distance]);
+            }
+        }
+    }
+
+    // the adler32 of the inflated data follows the last block
+    const std::size_t checksum_offset = (bit_position + 7) / 8;
+    const std::uint32_t checksum = (std::uint32_t{stream.at(checksum_offset)} << 24) | (std::uint32_t{stream.at(checksum_offset + 1)} << 16) | (std::uint32_t{stream.at(checksum_offset + 2)} << 8) | stream.at(checksum_offset + 3);
+    EXPECT_EQ(checksum, Deflate::get_adler32(output.data(), output.size()));
+    EXPECT_EQ(checksum_offset + 4, stream.size());
+    return output;
+}
+
+// reverses the PNG row filters of 8 bit RGB rows, returns the rows top to bottom
+static std::vector<std::uint8_t> unfilter_png_rows(const std::vector<std::uint8_t>& filtered, std::uint32_t width, std::uint32_t height){
+    const std::size_t row_size = 3 * static_cast<std::size_t>(width);
+    EXPECT_EQ(filtered.size(), (row_size + 1) * height);
+    std::vector<std::uint8_t> rows(row_size * height);
+    for(std::size_t y = 0; y < height; y++){
+        const std::uint8_t filter = filtered[y * (row_size + 1)];
+        const std::uint8_t* residuals = filtered.data() + y * (row_size + 1) + 1;
+        std::uint8_t* row = rows.data() + y * row_size;
+        for(std::size_t i = 0; i < row_size; i++){
+            const int left = i >= 3 ? row[i - 3] : 0;
+            const int up = y > 0 ? row[i - row_size] : 0;
+            const int up_left = y > 0 && i >= 3 ? row[i - row_size - 3] : 0;
+            int predictor = 0;
+            switch(filter){
+                case 0: predictor = 0; break;
+                case 1: predictor = left; break;
+                case 2: predictor = up; break;
+                case 3: predictor = (left + up) / 2; break;
+                case 4: {
+                    const int estimate = left + up - up_left;
+                    const int distance_left = std::abs(estimate - left);
+                    const int distance_up = std::abs(estimate - up);
+                    const int distance_up_left = std::abs(estimate - up_left);
+                    predictor = distance_left <= distance_up && distance_left <= distance_up_left ? left : (distance_up <= distance_up_left ? up : up_left);
+                    break;
+                }
+                default: throw std::invalid_argument("unknown png filter");
+            }
+            row[i] = static_cast<std::uint8_t>(residuals[i] + predictor);
+        }
+    }
+    return rows;
+}
+
+// Decodes an 8 bit RGB png with valid chunk checksums. filters receives the filter type of every row.
+static BitmapImage decode_png(const std::vector<char>& png, std::vector<std::uint8_t>& filters){
+    EXPECT_EQ(std::string(png.data() + 1, 3), "PNG");
+    auto read_big_endian = [&png](std::size_t position){
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(png.data() + position);
+        return (std::uint32_t{bytes[0]} << 24) | (std::uint32_t{bytes[1]} << 16) | (std::uint32_t{bytes[2]} << 8) | bytes[3];
+    };
+    std::size_t offset = 8;
+    std::vector<std::string> chunk_types;
+    std::vector<std::uint8_t> zlib_stream;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    while(offset < png.size()){
+        const std::uint32_t length = read_big_endian(offset);
+        const auto* chunk = reinterpret_cast<const std::uint8_t*>(png.data() + offset + 4);
+        EXPECT_EQ(Deflate::get_crc32(chunk, length + 4), read_big_endian(offset + 8 + length));
+        chunk_types.emplace_back(png.data() + offset + 4, 4);
+        if(chunk_types.back() == "IHDR"){
+            width = read_big_endian(offset + 8);
+            height = read_big_endian(offset + 12);
+        }
+        if(chunk_types.back() == "IDAT"){
+            zlib_stream.insert(zlib_stream.end(), chunk + 4, chunk + 4 + length);
+        }
+        offset += 12 + length;
+    }
+    EXPECT_EQ(offset, png.size());
+    EXPECT_EQ(chunk_types, (std::vector<std::string>{"IHDR", "IDAT", "IEND"}));
+
+    const std::vector<std::uint8_t> filtered = inflate_zlib(zlib_stream);
+    const std::vector<std::uint8_t> rows = unfilter_png_rows(filtered, width, height);
+    filters.clear();
+    BitmapImage image(height, width);
+    for(std::uint32_t y = 0; y < height; y++){
+        filters.push_back(filtered[y * (3 * width + 1)]);
+        for(std::uint32_t x = 0; x < width; x++){
+            // png rows are stored top to bottom, bitmap rows bottom to top
+            const std::uint8_t* pixel = rows.data() + (static_cast<std::size_t>(height - 1 - y) * width + x) * 3;
+            image.set_pixel(y, x, BitmapImage::BitmapPixel{pixel[0], pixel[1], pixel[2]});
+        }
+    }
+    return image;
+}
+
+TEST_F(PlottingTest, test_compressed_images){
+    Universe uni;
+    InputGenerator::create_random_universe(2000, uni);
+    Plotter plotter(uni.get_bounding_box(), ".", 203, 101);
+    plotter.set_plot_style(PlotStyle::density);
+    plotter.add_bodies_to_image(uni);
+    plotter.highlight_position(uni.positions[0], 255, 0, 0);
+
+    // reference image with every pixel of the plot
+    BitmapImage image(101, 203);
+    for(std::uint32_t y = 0; y < 101; y++){
+        for(std::uint32_t x = 0; x < 203; x++){
+            image.set_pixel(y, x, plotter.get_pixel(x, y));
+        }
+    }
+
+    std::vector<char> qoi;
+    ImageParser::encode_qoi(image, qoi);
+    BitmapImage decoded = ImageParser::decode_qoi(qoi.data(), qoi.size());
+    for(std::uint32_t y = 0; y < 101; y++){
+        for(std::uint32_t x = 0; x < 203; x++){
+            ASSERT_EQ(decoded.get_pixel(y, x), image.get_pixel(y, x));
+        }
+    }
+
+    // png chunks carry valid checksums, inflated and unfiltered the rows hold every pixel of the image
+    std::vector<char> png;
+    std::vector<std::uint8_t> filters;
+    ImageParser::encode_png(image, png);
+    BitmapImage png_decoded = decode_png(png, filters);
+    ASSERT_EQ(png_decoded.get_height(), 101);
+    ASSERT_EQ(png_decoded.get_width(), 203);
+    for(std::uint32_t y = 0; y < 101; y++){
+        for(std::uint32_t x = 0; x < 203; x++){
+            ASSERT_EQ(png_decoded.get_pixel(y, x), image.get_pixel(y, x)) << x << ", " << y;
+        }
+    }
+
+    // the rows of a density frame are mostly black and barely filtered, bands of horizontal gradients,
+    // repeated rows, diagonal gradients, curved patterns and smoothed noise make the encoder pick the other filters
+    BitmapImage gradient(60, 64);
+    // top to bottom in the file, so the row above is set when the smoothed band averages over it
+    for(std::uint32_t y = 60; y-- > 0;){
+        for(std::uint32_t x = 0; x < 64; x++){
+            std::array<std::uint32_t, 3> channels{};
+            switch(y / 10){
+                case 5: channels = {4 * x, 2 * x, x}; break;
+                case 4: channels = {37 * x, 91 * x, 13 * x}; break;
+                case 3: channels = {2 * x + 3 * y, x + 5 * y, 3 * x + y}; break;
+                case 2: channels = {x * x + y * y, x * y, 7 * x + 11 * y}; break;
+                case 1: channels = {x * x * y, 3 * x * y * y, x ^ y}; break;
+                default: {
+                    const auto left = x > 0 ? gradient.get_pixel(y, x - 1) : BitmapImage::BitmapPixel{0, 0, 0};
+                    const auto up = gradient.get_pixel(y + 1, x);
+                    const auto noise = (x * 7 + y * 13) % 5;
+                    channels = {(left.get_red_channel() + up.get_red_channel()) / 2 + noise,
+                                (left.get_green_channel() + up.get_green_channel()) / 2 + noise,
+                                (left.get_blue_channel() + up.get_blue_channel()) / 2 + noise};
+                    break;
+                }
+            }
+            gradient.set_pixel(y, x, BitmapImage::BitmapPixel{static_cast<std::uint8_t>(channels[0]), static_cast<std::uint8_t>(channels[1]), static_cast<std::uint8_t>(channels[2])});
+        }
+    }
+    std::vector<char> gradient_png;
+    ImageParser::encode_png(gradient, gradient_png);
+    BitmapImage gradient_decoded = decode_png(gradient_png, filters);
+    for(std::uint32_t y = 0; y < 60; y++){
+        for(std::uint32_t x = 0; x < 64; x++){
+            ASSERT_EQ(gradient_decoded.get_pixel(y, x), gradient.get_pixel(y, x)) << x << ", " << y;
+        }
+    }
+    std::sort(filters.begin(), filters.end());
+    ASSERT_GE(std::unique(filters.begin(), filters.end()) - filters.begin(), 4);
+
+    // a mostly black frame compresses far below the bitmap
+    std::vector<char> bitmap;
+    ImageParser::encode_bitmap(image, bitmap);
+    ASSERT_LT(png.size() * 10, bitmap.size());
+    ASSERT_LT(qoi.size() * 5, bitmap.size());
+
+    // known checksums
+    const std::string text = "123456789";
+    ASSERT_EQ(Deflate::get_crc32(reinterpret_cast<const std::uint8_t*>(text.data()), text.size()), 0xcbf43926u);
+    ASSERT_EQ(Deflate::get_adler32(reinterpret_cast<const std::uint8_t*>(text.data()), text.size()), 0x091e01deu);
+}
+
+TEST_F(PlottingTest, test_poster_tiles){
+    Universe uni;
+    InputGenerator::create_random_universe(2000, uni);
+    BoundingBox bb = uni.get_bounding_box();
+    auto path = std::filesystem::path{"test_poster_tiles"};
+    std::filesystem::remove_all(path);
+
+    PosterOptions options;
+    options.width = 70;
+    options.height = 40;
+    options.tile_size = 16;
+    options.style = PlotStyle::density;
+    options.format = ImageFormat::qoi;
+    PosterStatistics statistics = PosterRenderer::render(uni, bb, path, options);
+    // 70 -> 35 -> 18 -> 9 pixels wide
+    ASSERT_EQ(statistics.num_levels, 4u);
+    ASSERT_TRUE(std::filesystem::exists(path / "poster.json"));
+    ASSERT_TRUE(std::filesystem::exists(path / "0" / "0_0.qoi"));
+    ASSERT_FALSE(std::filesystem::exists(path / "0" / "1_0.qoi"));
+
+    // the finest level matches a direct render of the whole poster
+    Plotter plotter(bb, ".", 70, 40);
+    plotter.set_plot_style(PlotStyle::density);
+    plotter.add_bodies_to_image(uni);
+    std::uint64_t num_finest_tiles = 0;
+    for(std::uint32_t tile_y = 0; tile_y < 3; tile_y++){
+        for(std::uint32_t tile_x = 0; tile_x < 5; tile_x++){
+            auto tile_path = path / "3" / (std::to_string(tile_x) + "_" + std::to_string(tile_y) + ".qoi");
+            if(!std::filesystem::exists(tile_path)){
+                continue;
+            }
+            num_finest_tiles++;
+            const std::string data = read_file(tile_path);
+            BitmapImage tile = ImageParser::decode_qoi(data.data(), data.size());
+            for(std::uint32_t row = 0; row < tile.get_height(); row++){
+                for(std::uint32_t x = 0; x < tile.get_width(); x++){
+                    const std::uint32_t poster_y = 40 - 1 - (tile_y * 16 + tile.get_height() - 1 - row);
+                    ASSERT_EQ(tile.get_pixel(row, x), plotter.get_pixel(tile_x * 16 + x, poster_y));
+                }
+            }
+        }
+    }
+    ASSERT_GT(num_finest_tiles, 0u);
+    ASSERT_LT(num_finest_tiles, statistics.num_tiles_written);
+    std::filesystem::remove_all(path);
+}
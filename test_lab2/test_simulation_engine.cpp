@@ -0,0 +1,331 @@
+#include "test.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <omp.h>
+
+#include "structures/universe.h"
+#include "input_generator/input_generator.h"
+
+#include "quadtree/quadtree.h"
+#include "plotting/plotter.h"
+#include "simulation/simulation_context.h"
+#include "simulation/barnes_hut_simulation.h"
+#include "simulation/naive_parallel_simulation.h"
+#include "simulation/simulation_driver.h"
+#include "simulation/simulation_engine_registry.h"
+#include "profiling/phase_profiler.h"
+#include "profiling/hardware_counters.h"
+
+class SimulationEngineTest : public LabTest {};
+
+TEST_F(SimulationEngineTest, test_barnes_hut_forces_match_naive){
+    Universe uni;
+    InputGenerator::create_random_universe(500, uni);
+
+    Universe reference_uni = uni;
+    NaiveParallelSimulation::calculate_forces(reference_uni);
+
+    SimulationContext context(uni);
+    context.reset_body_indices(uni);
+    Quadtree qt(uni, uni.get_bounding_box(), context.node_arena, context.body_indices);
+    qt.root->aggregate_mass();
+    BarnesHutSimulation::calculate_forces(uni, qt, context);
+
+    double squared_error = 0;
+    double squared_magnitude = 0;
+    for(std::int32_t i = 0; i < uni.num_bodies; i++){
+        Vector2d<double> difference = uni.forces[i] - reference_uni.forces[i];
+        double error = std::sqrt(difference[0] * difference[0] + difference[1] * difference[1]);
+        double magnitude = std::sqrt(reference_uni.forces[i][0] * reference_uni.forces[i][0] + reference_uni.forces[i][1] * reference_uni.forces[i][1]);
+        // single bodies with nearly cancelling forces can have a larger relative error
+        ASSERT_LT(error, 0.1 * magnitude);
+        squared_error += error * error;
+        squared_magnitude += magnitude * magnitude;
+    }
+    ASSERT_LT(std::sqrt(squared_error / squared_magnitude), 0.01);
+}
+
+TEST_F(SimulationEngineTest, test_arena_reuses_nodes){
+    Universe uni;
+    InputGenerator::create_random_universe(1000, uni);
+    SimulationContext context(uni);
+
+    std::size_t used_nodes = 0;
+    for(int epoch = 0; epoch < 3; epoch++){
+        context.reset_body_indices(uni);
+        Quadtree qt(uni, uni.get_bounding_box(), context.node_arena, context.body_indices);
+        used_nodes = context.node_arena.get_used_nodes();
+    }
+    // the same universe results in the same tree, no additional nodes are created
+    ASSERT_EQ(context.node_arena.get_capacity(), used_nodes);
+
+    // every body ends up in exactly one leaf
+    context.reset_body_indices(uni);
+    Quadtree qt(uni, uni.get_bounding_box(), context.node_arena, context.body_indices);
+    std::vector<QuadtreeNode*> queue = {qt.root};
+    std::vector<std::int32_t> leaf_count(uni.num_bodies, 0);
+    while(!queue.empty()){
+        auto current = queue.back();
+        queue.pop_back();
+        if(current->children.empty()){
+            leaf_count[current->body_identifier]++;
+        }
+        for(auto child: current->children){
+            queue.push_back(child);
+        }
+    }
+    for(auto count: leaf_count){
+        ASSERT_EQ(count, 1);
+    }
+
+    // the entry points without a context build their trees in the context of the calling thread
+    Plotter plotter(uni.get_bounding_box(), ".", 10, 10);
+    Universe legacy_uni = uni;
+    BarnesHutSimulation::simulate_epoch(plotter, legacy_uni, false, 1);
+    SimulationContext& thread_context = SimulationContext::get_thread_context(legacy_uni);
+    ASSERT_EQ(thread_context.node_arena.get_used_nodes(), used_nodes);
+    const auto* thread_indices = thread_context.body_indices.data();
+    BarnesHutSimulation::simulate_epoch(plotter, legacy_uni, false, 1);
+    ASSERT_EQ(&SimulationContext::get_thread_context(legacy_uni), &thread_context);
+    ASSERT_EQ(thread_context.body_indices.data(), thread_indices);
+
+    Universe owned_uni = uni;
+    SimulationContext owned_context(owned_uni);
+    BarnesHutSimulation::simulate_epoch(plotter, owned_uni, owned_context, false, 1);
+    BarnesHutSimulation::simulate_epoch(plotter, owned_uni, owned_context, false, 1);
+    ASSERT_EQ(owned_uni.positions, legacy_uni.positions);
+}
+
+class CountingObserver : public SimulationObserver {
+public:
+    void on_epoch_begin(Universe& universe, SimulationContext& context) override{
+        epochs_begun++;
+    }
+    void on_phase_end(SimulationPhase phase, double seconds) override{
+        phase_counts[static_cast<std::size_t>(phase)]++;
+        ASSERT_GE(seconds, 0.0);
+    }
+    void on_epoch_end(Universe& universe, SimulationContext& context) override{
+        epochs_ended++;
+    }
+
+    std::int32_t epochs_begun = 0;
+    std::int32_t epochs_ended = 0;
+    std::array<std::int32_t, num_simulation_phases> phase_counts = {};
+};
+
+TEST_F(SimulationEngineTest, test_registry_engines){
+    auto& registry = SimulationEngineRegistry::get_instance();
+    ASSERT_GE(registry.get_entries().size(), 4);
+    ASSERT_THROW(registry.create_engine(1000), std::invalid_argument);
+    // the options reach the engine, here the number of ranks of the distributed engine
+    EngineOptions options;
+    options.simulated_ranks = 0;
+    ASSERT_THROW(registry.create_engine(4, options), std::invalid_argument);
+
+    auto tmp_path = std::filesystem::path{"test_registry_engines_plot"};
+    for(auto& entry: registry.get_entries()){
+        std::filesystem::remove_all(tmp_path);
+        std::filesystem::create_directories(tmp_path);
+
+        Universe uni;
+        InputGenerator::create_random_universe(100, uni);
+        BoundingBox bb = uni.get_bounding_box();
+        Plotter plotter(bb, tmp_path, 100, 100);
+
+        auto engine = registry.create_engine(entry.simulation_mode);
+        ASSERT_EQ(engine->get_name(), entry.name);
+
+        SimulationContext context(uni);
+        CountingObserver observer;
+        context.add_observer(&observer);
+        SimulationDriver::simulate_epochs(*engine, plotter, uni, context, 4, true, 2);
+
+        ASSERT_EQ(uni.current_simulation_epoch, 4);
+        ASSERT_EQ(observer.epochs_begun, 4);
+        ASSERT_EQ(observer.epochs_ended, 4);
+        ASSERT_EQ(observer.phase_counts[static_cast<std::size_t>(SimulationPhase::force_calculation)], 4);
+        ASSERT_EQ(observer.phase_counts[static_cast<std::size_t>(SimulationPhase::collisions)], entry.capabilities.supports_collisions ? 4 : 0);
+        // exactly one plot every second epoch, also for the engines with collisions
+        ASSERT_EQ(observer.phase_counts[static_cast<std::size_t>(SimulationPhase::plotting)], 2);
+        ASSERT_EQ(std::distance(std::filesystem::directory_iterator(tmp_path), std::filesystem::directory_iterator{}), 2);
+    }
+    std::filesystem::remove_all(tmp_path);
+}
+
+TEST_F(SimulationEngineTest, test_engines_follow_thread_count){
+    // every parallel engine prepares the context for threads added after it was created
+    const int num_threads = omp_get_max_threads();
+    for(auto& entry: SimulationEngineRegistry::get_instance().get_entries()){
+        if(!entry.capabilities.parallel){
+            continue;
+        }
+        omp_set_num_threads(1);
+        Universe uni;
+        InputGenerator::create_random_universe(100, uni);
+        SimulationContext context(uni);
+        auto engine = SimulationEngineRegistry::get_instance().create_engine(entry.simulation_mode);
+
+        omp_set_num_threads(4);
+        engine->simulate_epoch(uni, context);
+        ASSERT_GE(context.thread_scratch.size(), 4) << entry.name;
+    }
+    omp_set_num_threads(num_threads);
+}
+
+TEST_F(SimulationEngineTest, test_phase_profiler){
+    Universe uni;
+    InputGenerator::create_random_universe(200, uni);
+
+    BarnesHutEngine engine;
+    SimulationContext context(uni);
+    PhaseProfiler profiler(engine.get_name());
+    context.add_observer(&profiler);
+
+    auto tmp_path = std::filesystem::path{"test_phase_profiler_plot"};
+    Plotter plotter(uni.get_bounding_box(), tmp_path, 100, 100);
+    SimulationDriver::simulate_epochs(engine, plotter, uni, context, 3, false, 1);
+
+    ASSERT_EQ(profiler.get_epochs().size(), 3);
+    for(auto& profile: profiler.get_epochs()){
+        ASSERT_GT(profile.tree_depth, 0);
+        ASSERT_GT(profile.tree_nodes, uni.num_bodies);
+        std::uint64_t interactions = 0;
+        for(auto& counters: profile.thread_counters){
+            interactions += counters.interactions;
+            ASSERT_GE(counters.nodes_visited, counters.interactions);
+        }
+        // at least one interaction per body, at most one per other body
+        ASSERT_GE(interactions, uni.num_bodies);
+        ASSERT_LE(interactions, static_cast<std::uint64_t>(uni.num_bodies) * (uni.num_bodies - 1));
+    }
+
+    auto json_path = std::filesystem::path{"test_phase_profiler.json"};
+    profiler.write_json(json_path);
+    ASSERT_TRUE(std::filesystem::file_size(json_path) > 0);
+    std::filesystem::remove(json_path);
+}
+
+TEST_F(SimulationEngineTest, test_hardware_counters){
+    Universe uni;
+    InputGenerator::create_random_universe(2000, uni);
+
+    BarnesHutEngine engine;
+    SimulationContext context(uni);
+    PhaseProfiler profiler(engine.get_name());
+    HardwareCounterProfiler hardware_counters;
+    context.add_observer(&profiler);
+    context.add_observer(&hardware_counters);
+    profiler.set_hardware_counters(&hardware_counters);
+
+    auto tmp_path = std::filesystem::path{"test_hardware_counters_plot"};
+    Plotter plotter(uni.get_bounding_box(), tmp_path, 100, 100);
+    SimulationDriver::simulate_epochs(engine, plotter, uni, context, 2, false, 1);
+
+    // without permission or a PMU, e.g. in containers and VMs, the profiler only reports why
+    if(hardware_counters.is_available()){
+        const auto& force_counts = hardware_counters.get_phase_counts(SimulationPhase::force_calculation);
+        ASSERT_FALSE(force_counts.empty());
+        std::uint64_t instructions = 0;
+        for(const auto& counts : force_counts){
+            instructions += counts.values[static_cast<std::size_t>(HardwareEvent::instructions)];
+        }
+        // far more than one instruction per body and epoch
+        ASSERT_GT(instructions, 2 * 2000);
+    } else {
+        ASSERT_FALSE(hardware_counters.get_unavailable_reason().empty());
+    }
+
+    auto json_path = std::filesystem::path{"test_hardware_counters.json"};
+    profiler.write_json(json_path);
+    std::ifstream json_file(json_path);
+    const std::string json((std::istreambuf_iterator<char>(json_file)), std::istreambuf_iterator<char>());
+    ASSERT_NE(json.find("\"hardware_counters\": {\"available\": "), std::string::npos);
+    std::filesystem::remove(json_path);
+}
+
+TEST_F(SimulationEngineTest, test_force_schedules_match){
+    Universe uni;
+    InputGenerator::create_random_universe_with_supermassive_blackholes(1000, uni, 1);
+
+    SimulationContext context(uni);
+    context.reset_body_indices(uni);
+    Quadtree qt(uni, uni.get_bounding_box(), context.node_arena, context.body_indices);
+    qt.root->aggregate_mass();
+
+    omp_sched_t caller_schedule_kind;
+    int caller_chunk_size;
+    omp_get_schedule(&caller_schedule_kind, &caller_chunk_size);
+
+    context.force_schedule.schedule = ForceSchedule::static_schedule;
+    BarnesHutSimulation::calculate_forces(uni, qt, context);
+    auto reference_forces = uni.forces;
+    auto reference_interactions = context.body_interactions;
+
+    for(std::uint32_t schedule_id = 1; schedule_id < 5; schedule_id++){
+        context.reset_counters();
+        context.force_schedule.schedule = get_force_schedule(schedule_id);
+        context.force_schedule.chunk_size = 16;
+        BarnesHutSimulation::calculate_forces(uni, qt, context);
+
+        // the schedule only changes which thread computes a body, not the result
+        ASSERT_EQ(context.body_interactions, reference_interactions);
+        for(std::int32_t i = 0; i < uni.num_bodies; i++){
+            ASSERT_EQ(uni.forces[i][0], reference_forces[i][0]);
+            ASSERT_EQ(uni.forces[i][1], reference_forces[i][1]);
+        }
+        ASSERT_GT(context.force_threads, 0);
+        ASSERT_GE(context.get_load_imbalance(), 0.0);
+
+        // the run-schedule of the caller is left as it was
+        omp_sched_t schedule_kind;
+        int chunk_size;
+        omp_get_schedule(&schedule_kind, &chunk_size);
+        ASSERT_EQ(schedule_kind, caller_schedule_kind);
+        ASSERT_EQ(chunk_size, caller_chunk_size);
+    }
+    ASSERT_THROW((void)get_force_schedule(5), std::invalid_argument);
+
+    // cost weighted parts cover all bodies in order
+    std::vector<std::int32_t> boundaries;
+    partition_by_cost(reference_interactions, 4, boundaries);
+    ASSERT_EQ(boundaries.size(), 5);
+    ASSERT_EQ(boundaries.front(), 0);
+    ASSERT_EQ(boundaries.back(), uni.num_bodies);
+    ASSERT_TRUE(std::is_sorted(boundaries.begin(), boundaries.end()));
+}
+
+TEST_F(SimulationEngineTest, test_cost_zones_follow_tree_order){
+    Universe uni;
+    InputGenerator::create_random_universe_with_supermassive_blackholes(1000, uni, 2);
+
+    SimulationContext context(uni);
+    context.force_schedule.schedule = ForceSchedule::cost_zones;
+    BarnesHutSimulation::simulate_epoch(uni, context);
+
+    std::vector<std::int32_t> zones;
+    partition_by_cost(context.body_interactions, context.body_indices, 4, zones);
+    ASSERT_EQ(zones.front(), 0);
+    ASSERT_EQ(zones.back(), uni.num_bodies);
+
+    // the zones hold roughly the same cost, at most one body off the ideal split
+    std::uint64_t total_cost = 0;
+    std::uint32_t max_cost = 0;
+    for(auto interactions: context.body_interactions){
+        total_cost += interactions + 1;
+        max_cost = std::max(max_cost, interactions + 1);
+    }
+    for(std::size_t zone = 0; zone + 1 < zones.size(); zone++){
+        std::uint64_t zone_cost = 0;
+        for(std::int32_t position = zones[zone]; position < zones[zone + 1]; position++){
+            zone_cost += context.body_interactions[context.body_indices[position]] + 1;
+        }
+        ASSERT_LE(zone_cost, total_cost / 4 + max_cost);
+    }
+}